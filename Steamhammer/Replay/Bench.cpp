@@ -0,0 +1,82 @@
+// SteamhammerBench, the console program for the benchmarks in this directory.
+// It is built by VisualStudio/SteamhammerBench.vcxproj from these files plus the bot
+// sources except Dll.cpp, linked with BOSS and BWAPILIB. None of it goes into the bot DLL.
+//
+// Usage: SteamhammerBench fap [repetitions]
+//        SteamhammerBench map [frames.bin] [repetitions]
+//        SteamhammerBench replay frames.bin [from frame] [repetitions]
+//        SteamhammerBench records [games] [repetitions]
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+
+namespace
+{
+    std::atomic<int64_t> allocationCount(0);
+}
+
+// The count of heap allocations so far, for the benchmarks that report allocations.
+int64_t BenchAllocations()
+{
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+// Count every heap allocation in the program.
+void * operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void * p = std::malloc(size ? size : 1))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void * p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void * p, size_t) noexcept
+{
+    std::free(p);
+}
+
+int FAPBenchMain(int argc, char * argv[]);
+int MapBenchMain(int argc, char * argv[]);
+int ReplayBenchMain(int argc, char * argv[]);
+int RecordBenchMain(int argc, char * argv[]);
+
+int main(int argc, char * argv[])
+{
+    if (argc >= 2)
+    {
+        // Each benchmark sees its own name as argv[0].
+        if (std::strcmp(argv[1], "fap") == 0)
+        {
+            return FAPBenchMain(argc - 1, argv + 1);
+        }
+        if (std::strcmp(argv[1], "map") == 0)
+        {
+            return MapBenchMain(argc - 1, argv + 1);
+        }
+        if (std::strcmp(argv[1], "replay") == 0)
+        {
+            return ReplayBenchMain(argc - 1, argv + 1);
+        }
+        if (std::strcmp(argv[1], "records") == 0)
+        {
+            return RecordBenchMain(argc - 1, argv + 1);
+        }
+    }
+
+    std::cerr << "usage: " << argv[0] << " fap [repetitions]\n"
+        << "       " << argv[0] << " map [frames.bin] [repetitions]\n"
+        << "       " << argv[0] << " replay frames.bin [from frame] [repetitions]\n"
+        << "       " << argv[0] << " records [games] [repetitions]\n";
+    return 2;
+}
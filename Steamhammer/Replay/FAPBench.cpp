@@ -0,0 +1,26 @@
+// Synthetic battle benchmark for the combat simulator FAP. Not part of the bot DLL.
+// Part of the SteamhammerBench console program, see Bench.cpp.
+//
+// Usage: SteamhammerBench fap [repetitions]
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "FAPBenchmark.h"
+
+using namespace UAlbertaBot;
+
+int64_t BenchAllocations();
+
+int FAPBenchMain(int argc, char * argv[])
+{
+    const int repetitions = argc > 1 ? std::max(1, std::atoi(argv[1])) : 100;
+
+    FAPBenchmark benchmark(&BenchAllocations);
+    for (const BattleSpec & spec : FAPBenchmark::StandardSuite())
+    {
+        FAPBenchmark::Report(spec.name, benchmark.run(spec, repetitions), std::cout);
+    }
+    return 0;
+}
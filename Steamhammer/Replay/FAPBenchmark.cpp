@@ -0,0 +1,240 @@
+#include "FAPBenchmark.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+
+#include "Random.h"
+#include "ReplayedFAP.h"
+
+using namespace UAlbertaBot;
+using namespace UAlbertaBot::FrameCaptureFormat;
+
+namespace
+{
+    // The units each race brings to a fight, with repeats to set the proportions.
+    const std::vector<BWAPI::UnitType> & Roster(BWAPI::Race race)
+    {
+        static const std::vector<BWAPI::UnitType> terran = {
+            BWAPI::UnitTypes::Terran_Marine, BWAPI::UnitTypes::Terran_Marine, BWAPI::UnitTypes::Terran_Marine,
+            BWAPI::UnitTypes::Terran_Medic, BWAPI::UnitTypes::Terran_Firebat,
+            BWAPI::UnitTypes::Terran_Vulture, BWAPI::UnitTypes::Terran_Goliath,
+            BWAPI::UnitTypes::Terran_Siege_Tank_Siege_Mode, BWAPI::UnitTypes::Terran_Siege_Tank_Tank_Mode,
+            BWAPI::UnitTypes::Terran_Wraith, BWAPI::UnitTypes::Terran_Battlecruiser,
+            BWAPI::UnitTypes::Terran_Bunker, BWAPI::UnitTypes::Terran_Missile_Turret,
+        };
+        static const std::vector<BWAPI::UnitType> protoss = {
+            BWAPI::UnitTypes::Protoss_Zealot, BWAPI::UnitTypes::Protoss_Zealot,
+            BWAPI::UnitTypes::Protoss_Dragoon, BWAPI::UnitTypes::Protoss_Dragoon,
+            BWAPI::UnitTypes::Protoss_Archon, BWAPI::UnitTypes::Protoss_Reaver,
+            BWAPI::UnitTypes::Protoss_Corsair, BWAPI::UnitTypes::Protoss_Scout,
+            BWAPI::UnitTypes::Protoss_Carrier, BWAPI::UnitTypes::Protoss_Photon_Cannon,
+        };
+        static const std::vector<BWAPI::UnitType> zerg = {
+            BWAPI::UnitTypes::Zerg_Zergling, BWAPI::UnitTypes::Zerg_Zergling, BWAPI::UnitTypes::Zerg_Zergling,
+            BWAPI::UnitTypes::Zerg_Hydralisk, BWAPI::UnitTypes::Zerg_Hydralisk,
+            BWAPI::UnitTypes::Zerg_Lurker, BWAPI::UnitTypes::Zerg_Ultralisk,
+            BWAPI::UnitTypes::Zerg_Mutalisk, BWAPI::UnitTypes::Zerg_Mutalisk,
+            BWAPI::UnitTypes::Zerg_Guardian, BWAPI::UnitTypes::Zerg_Devourer,
+            BWAPI::UnitTypes::Zerg_Sunken_Colony, BWAPI::UnitTypes::Zerg_Spore_Colony,
+        };
+
+        if (race == BWAPI::Races::Terran)
+        {
+            return terran;
+        }
+        if (race == BWAPI::Races::Protoss)
+        {
+            return protoss;
+        }
+        return zerg;
+    }
+
+    std::vector<CapturedUnit> MakeArmy(Random & random, BWAPI::Race race, int size, int centerX, int centerY, int spread, int upgrades)
+    {
+        const std::vector<BWAPI::UnitType> & roster = Roster(race);
+
+        std::vector<CapturedUnit> army;
+        for (int i = 0; i < size; ++i)
+        {
+            const BWAPI::UnitType type = roster[random.index(int(roster.size()))];
+
+            // Uniform in a disk.
+            int dx, dy;
+            do
+            {
+                dx = random.index(2 * spread + 1) - spread;
+                dy = random.index(2 * spread + 1) - spread;
+            } while (dx * dx + dy * dy > spread * spread);
+
+            CapturedUnit unit;
+            std::memset(&unit, 0, sizeof(unit));
+            unit.id = i;
+            unit.targetID = -1;
+            unit.type = int16_t(type.getID());
+            unit.x = int16_t(centerX + dx);
+            unit.y = int16_t(centerY + dy);
+            unit.hitPoints = int16_t(type.maxHitPoints());
+            unit.shields = int16_t(type.maxShields());
+            unit.flags = Flag::Completed | (type.isFlyer() ? Flag::Flying : 0);
+            FastAPproximation::TypeStats(type, upgrades, unit.stats);
+            army.push_back(unit);
+        }
+        return army;
+    }
+
+    // FNV-1a, 64 bits, one int at a time.
+    void Mix(uint64_t & hash, int n)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            hash ^= uint8_t(n >> (8 * i));
+            hash *= 1099511628211ull;
+        }
+    }
+
+    void MixScores(uint64_t & hash, const std::pair<int, int> & scores)
+    {
+        Mix(hash, scores.first);
+        Mix(hash, scores.second);
+    }
+
+    int64_t NanosecondsSince(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+BattleSpec::BattleSpec(const std::string & name, int armySize, BWAPI::Race race1, BWAPI::Race race2,
+    int spread, int distance, int upgrades1, int upgrades2, unsigned int seed)
+    : name(name)
+    , armySize(armySize)
+    , race1(race1)
+    , race2(race2)
+    , spread(spread)
+    , distance(distance)
+    , upgrades1(upgrades1)
+    , upgrades2(upgrades2)
+    , seed(seed)
+{
+}
+
+BattleResult::BattleResult()
+    : repetitions(0)
+    , simulateNanoseconds(0)
+    , simulatedFrames(0)
+    , retreatNanoseconds(0)
+    , retreatFrames(0)
+    , allocations(-1)
+    , checksum(14695981039346656037ull)
+{
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+FAPBenchmark::FAPBenchmark(AllocationCounter allocations)
+    : _allocations(allocations)
+{
+}
+
+std::vector<BattleSpec> FAPBenchmark::StandardSuite()
+{
+    const BWAPI::Race T = BWAPI::Races::Terran;
+    const BWAPI::Race P = BWAPI::Races::Protoss;
+    const BWAPI::Race Z = BWAPI::Races::Zerg;
+
+    return {
+        BattleSpec("skirmish-ZvZ",    12, Z, Z, 128,  256, 0, 0, 1),
+        BattleSpec("skirmish-TvP",    12, T, P, 128,  256, 1, 0, 2),
+        BattleSpec("midgame-ZvT",     50, Z, T, 320,  480, 1, 1, 3),
+        BattleSpec("midgame-PvZ",     50, P, Z, 320,  480, 1, 2, 4),
+        BattleSpec("clumped-ZvP",     50, Z, P,  64,  160, 2, 2, 5),
+        BattleSpec("lategame-TvZ",   150, T, Z, 640,  800, 3, 3, 6),
+        BattleSpec("lategame-PvT",   150, P, T, 640,  800, 3, 2, 7),
+        BattleSpec("maxed-ZvZ",      200, Z, Z, 960, 1200, 3, 3, 8),
+    };
+}
+
+BattleResult FAPBenchmark::run(const BattleSpec & spec, int repetitions) const
+{
+    Random random(spec.seed);
+    const int centerY = 2048;
+    const int center1 = 2048 - spec.distance / 2;
+    const int center2 = 2048 + spec.distance / 2;
+    const std::vector<CapturedUnit> army1 = MakeArmy(random, spec.race1, spec.armySize, center1, centerY, spec.spread, spec.upgrades1);
+    const std::vector<CapturedUnit> army2 = MakeArmy(random, spec.race2, spec.armySize, center2, centerY, spec.spread, spec.upgrades2);
+    const BWAPI::Position retreatTo(center1 - spec.distance, centerY);
+
+    BattleResult result;
+    runBattle(army1, army2, retreatTo, repetitions, result);
+    return result;
+}
+
+void FAPBenchmark::runBattle(
+    const std::vector<CapturedUnit> & army1,
+    const std::vector<CapturedUnit> & army2,
+    const BWAPI::Position & retreatTo,
+    int repetitions,
+    BattleResult & result) const
+{
+    result.repetitions += repetitions;
+    if (_allocations && result.allocations < 0)
+    {
+        result.allocations = 0;
+    }
+
+    ReplayedFAP sim;
+    for (int rep = 0; rep < repetitions; ++rep)
+    {
+        for (bool retreat : { false, true })
+        {
+            sim.clearState();
+            for (const CapturedUnit & unit : army1)
+            {
+                sim.addIfCombatUnitPlayer1(unit);
+            }
+            for (const CapturedUnit & unit : army2)
+            {
+                sim.addIfCombatUnitPlayer2(unit);
+            }
+            MixScores(result.checksum, sim.playerScores());
+
+            const int64_t allocationsBefore = _allocations ? _allocations() : 0;
+            const auto start = std::chrono::steady_clock::now();
+            if (retreat)
+            {
+                result.retreatFrames += sim.simulateRetreat(retreatTo);
+                result.retreatNanoseconds += NanosecondsSince(start);
+            }
+            else
+            {
+                result.simulatedFrames += sim.simulate();
+                result.simulateNanoseconds += NanosecondsSince(start);
+            }
+            if (_allocations)
+            {
+                result.allocations += _allocations() - allocationsBefore;
+            }
+
+            MixScores(result.checksum, sim.playerScores());
+        }
+    }
+}
+
+void FAPBenchmark::Report(const std::string & name, const BattleResult & result, std::ostream & out)
+{
+    const auto framesPerSecond = [](int64_t frames, int64_t nanoseconds)
+    {
+        return nanoseconds > 0 ? frames * 1.0e9 / nanoseconds : 0.0;
+    };
+
+    out << std::left << std::setw(16) << name << std::right
+        << std::fixed << std::setprecision(0)
+        << " sim_frames/s " << std::setw(9) << framesPerSecond(result.simulatedFrames, result.simulateNanoseconds)
+        << " retreat_frames/s " << std::setw(9) << framesPerSecond(result.retreatFrames, result.retreatNanoseconds)
+        << std::setprecision(1)
+        << " allocs/rep " << std::setw(8) << (result.allocations < 0 ? -1.0 : double(result.allocations) / std::max(1, result.repetitions))
+        << " checksum " << std::hex << result.checksum << std::dec
+        << '\n';
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <BWAPI.h>
+#include "FrameCapture.h"
+
+// Synthetic battles for timing the combat simulator FAP in isolation.
+// FrameReplay times battles from a capture file with the same runBattle().
+// Battles are generated from a fixed seed, so each run does the same work.
+// The checksum of the simulation scores shows whether an optimization changed the results.
+// The random distributions come from the standard library, so checksums compare only
+// between builds with the same compiler.
+
+namespace UAlbertaBot
+{
+struct BattleSpec
+{
+    std::string name;
+    int armySize;                   // units per side
+    BWAPI::Race race1;              // player 1 is the side that retreats
+    BWAPI::Race race2;
+    int spread;                     // each army is scattered within this radius, in pixels
+    int distance;                   // between the army centers, in pixels
+    int upgrades1;                  // weapon and armor upgrade level, 0 to 3
+    int upgrades2;
+    unsigned int seed;
+
+    BattleSpec(const std::string & name, int armySize, BWAPI::Race race1, BWAPI::Race race2,
+        int spread, int distance, int upgrades1, int upgrades2, unsigned int seed);
+};
+
+struct BattleResult
+{
+    int repetitions;
+    int64_t simulateNanoseconds;
+    int64_t simulatedFrames;
+    int64_t retreatNanoseconds;
+    int64_t retreatFrames;
+    int64_t allocations;            // -1 if not counted
+    uint64_t checksum;
+
+    BattleResult();
+};
+
+class FAPBenchmark
+{
+public:
+    // Return the count of heap allocations so far, if the program counts them.
+    typedef int64_t (*AllocationCounter)();
+
+private:
+    AllocationCounter _allocations;
+
+public:
+    FAPBenchmark(AllocationCounter allocations = nullptr);
+
+    // A spread of sizes, matchups, densities and upgrades.
+    static std::vector<BattleSpec> StandardSuite();
+
+    BattleResult run(const BattleSpec & spec, int repetitions) const;
+
+    // Simulate the battle, then the retreat of army 1, the given number of times.
+    // Add the times, frames, allocations and scores to the result.
+    void runBattle(
+        const std::vector<FrameCaptureFormat::CapturedUnit> & army1,
+        const std::vector<FrameCaptureFormat::CapturedUnit> & army2,
+        const BWAPI::Position & retreatTo,
+        int repetitions,
+        BattleResult & result) const;
+
+    static void Report(const std::string & name, const BattleResult & result, std::ostream & out);
+};
+
+}
@@ -0,0 +1,113 @@
+#include "FrameReplay.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <vector>
+
+using namespace UAlbertaBot;
+using namespace UAlbertaBot::FrameCaptureFormat;
+
+namespace
+{
+    // Our army retreats directly away from the enemy army's center, staying on the map.
+    BWAPI::Position RetreatPosition(const std::vector<CapturedUnit> & ours, const std::vector<CapturedUnit> & theirs, int mapWidth, int mapHeight)
+    {
+        const auto center = [](const std::vector<CapturedUnit> & army)
+        {
+            int x = 0;
+            int y = 0;
+            for (const CapturedUnit & unit : army)
+            {
+                x += unit.x;
+                y += unit.y;
+            }
+            const int n = std::max(1, int(army.size()));
+            return BWAPI::Position(x / n, y / n);
+        };
+
+        const BWAPI::Position us = center(ours);
+        const BWAPI::Position them = center(theirs);
+        return BWAPI::Position(
+            std::max(0, std::min(32 * mapWidth - 1, 2 * us.x - them.x)),
+            std::max(0, std::min(32 * mapHeight - 1, 2 * us.y - them.y)));
+    }
+}
+
+FrameReplayResult::FrameReplayResult()
+    : frames(0)
+    , maxNanoseconds(0)
+    , slowestFrame(-1)
+{
+}
+
+FrameReplay::FrameReplay(FAPBenchmark::AllocationCounter allocations)
+    : _benchmark(allocations)
+{
+}
+
+bool FrameReplay::open(const std::string & filename)
+{
+    return _reader.open(filename);
+}
+
+FrameReplayResult FrameReplay::run(int fromFrame) const
+{
+    FrameReplayResult result;
+    std::vector<CapturedUnit> army1;
+    std::vector<CapturedUnit> army2;
+
+    for (const CapturedFrame & frame : _reader.frames())
+    {
+        if (frame.frame < fromFrame)
+        {
+            continue;
+        }
+
+        army1.clear();
+        army2.clear();
+        for (int i = 0; i < frame.nUnits; ++i)
+        {
+            const CapturedUnit & unit = frame.units[i];
+            if (!(unit.flags & Flag::Completed))
+            {
+                continue;
+            }
+            if (unit.player == 0)
+            {
+                army1.push_back(unit);
+            }
+            else if (unit.player == 1)
+            {
+                army2.push_back(unit);
+            }
+        }
+
+        const BWAPI::Position retreatTo = RetreatPosition(army1, army2, _reader.header().mapWidth, _reader.header().mapHeight);
+        const int64_t before = result.battles.simulateNanoseconds + result.battles.retreatNanoseconds;
+        _benchmark.runBattle(army1, army2, retreatTo, 1, result.battles);
+        const int64_t nanoseconds = result.battles.simulateNanoseconds + result.battles.retreatNanoseconds - before;
+
+        ++result.frames;
+        if (nanoseconds > result.maxNanoseconds)
+        {
+            result.maxNanoseconds = nanoseconds;
+            result.slowestFrame = frame.frame;
+        }
+    }
+
+    return result;
+}
+
+void FrameReplay::Report(const FrameReplayResult & result, std::ostream & out)
+{
+    const double totalMilliseconds = (result.battles.simulateNanoseconds + result.battles.retreatNanoseconds) / 1000000.0;
+
+    out << std::fixed << std::setprecision(3);
+    out << "frames " << result.frames
+        << " total_ms " << totalMilliseconds
+        << " mean_ms " << totalMilliseconds / std::max(1, result.frames)
+        << " max_ms " << result.maxNanoseconds / 1000000.0
+        << " at_frame " << result.slowestFrame
+        << '\n';
+    FAPBenchmark::Report("replay", result.battles, out);
+}
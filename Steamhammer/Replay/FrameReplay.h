@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include "FAPBenchmark.h"
+#include "FrameCapture.h"
+
+// Replay a capture file through the combat simulator, outside the game.
+// Each captured frame becomes one battle of all our combat units against all the
+// enemy's, a worst case for the simulator. The battles are run by FAPBenchmark::runBattle(),
+// the same as the synthetic battles, so the two measure the same work.
+// Replays of the same file do the same work, so the timings compare builds, and the
+// checksum shows whether results changed.
+
+// Only the combat simulator is replayed, through ReplayedFAP. It runs from captured data
+// alone, because the capture holds each unit's combat stats. The decision code
+// (InformationManager, GridAttacks, OpsBoss, Squad) is not replayed; it asks BWAPI::Broodwar
+// about the game as it goes.
+
+namespace UAlbertaBot
+{
+struct FrameReplayResult
+{
+    int frames;
+    int64_t maxNanoseconds;
+    int slowestFrame;               // game frame number
+    BattleResult battles;           // totals over all frames
+
+    FrameReplayResult();
+};
+
+class FrameReplay
+{
+private:
+    FrameCaptureReader _reader;
+    FAPBenchmark _benchmark;
+
+public:
+    FrameReplay(FAPBenchmark::AllocationCounter allocations = nullptr);
+
+    bool open(const std::string & filename);
+
+    const FrameCaptureReader & reader() const { return _reader; };
+
+    // Replay frames from the given game frame onward. Late-game frames are the slow ones.
+    FrameReplayResult run(int fromFrame = 0) const;
+
+    static void Report(const FrameReplayResult & result, std::ostream & out);
+};
+
+}
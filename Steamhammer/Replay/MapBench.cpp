@@ -0,0 +1,239 @@
+// Map analysis benchmark. Not part of the bot DLL.
+// Compares the distance transform for GridInset and GridRoom against the original
+// breadth-first search and column scan, and checks that the outputs are identical.
+// Part of the SteamhammerBench console program, see Bench.cpp.
+//
+// Usage: SteamhammerBench map [frames.bin] [repetitions]
+// The walkability comes from a capture file (see ReplayBench). Without one, a synthetic
+// 256x256 map of random blobs is used.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "DistanceTransform.h"
+#include "FrameCapture.h"
+#include "Random.h"
+
+using namespace UAlbertaBot;
+
+typedef std::vector< std::vector<short> > Walks;
+
+namespace
+{
+    // The original GridInset::initialize(): breadth-first search out from the walls.
+    void ReferenceInset(const std::vector< std::vector<bool> > & walkable, Walks & grid)
+    {
+        const int LegalActions = 4;
+        const int actionX[LegalActions] = { 1, -1, 0, 0 };
+        const int actionY[LegalActions] = { 0, 0, 1, -1 };
+
+        const int width = int(walkable.size());
+        const int height = int(walkable[0].size());
+        grid = Walks(width, std::vector<short>(height, short(-1)));
+
+        std::vector<std::pair<int, int>> fringe;
+        fringe.reserve(width * height);
+        for (int x = 0; x < width; ++x)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                if (!walkable[x][y])
+                {
+                    grid[x][y] = 0;
+                }
+                else if (x == 0 || y == 0 || x == width - 1 || y == height - 1 ||
+                    !walkable[x + 1][y] || !walkable[x - 1][y] || !walkable[x][y + 1] || !walkable[x][y - 1])
+                {
+                    fringe.push_back(std::make_pair(x, y));
+                    grid[x][y] = 1;
+                }
+            }
+        }
+
+        for (size_t i = 0; i < fringe.size(); ++i)
+        {
+            const int x = fringe[i].first;
+            const int y = fringe[i].second;
+            for (int a = 0; a < LegalActions; ++a)
+            {
+                const int nx = x + actionX[a];
+                const int ny = y + actionY[a];
+                if (nx >= 0 && ny >= 0 && nx < width && ny < height && grid[nx][ny] == -1)
+                {
+                    fringe.push_back(std::make_pair(nx, ny));
+                    grid[nx][ny] = grid[x][y] + 1;
+                }
+            }
+        }
+    }
+
+    // The original GridRoom::initialize() column scan.
+    void ReferenceRoom(const Walks & inset, Walks & grid)
+    {
+        const int width = int(inset.size());
+        const int height = int(inset[0].size());
+        grid = Walks(width, std::vector<short>(height, short(-1)));
+
+        for (int x = 0; x < width; ++x)
+        {
+            int y = 0;
+        looptop:
+            while (y < height)
+            {
+                int value = inset[x][y];
+                if (value <= 0)
+                {
+                    ++y;
+                }
+                else
+                {
+                    int startY = y;
+                    for (; y < height; ++y)
+                    {
+                        bool foundMax = false;
+                        if (y == height - 1)
+                        {
+                            value = inset[x][y];
+                            foundMax = true;
+                        }
+                        else
+                        {
+                            const int newValue = inset[x][y + 1];
+                            if (newValue > value)
+                            {
+                                value = newValue;
+                            }
+                            else if (newValue < value)
+                            {
+                                foundMax = true;
+                            }
+                        }
+                        if (foundMax)
+                        {
+                            while (y < height - 1)
+                            {
+                                if (inset[x][y + 1] <= 0 || inset[x][y + 1] > inset[x][y])
+                                {
+                                    break;
+                                }
+                                ++y;
+                            }
+                            for (int i = startY; i <= y; ++i)
+                            {
+                                grid[x][i] = value;
+                            }
+                            ++y;
+                            goto looptop;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    void TransformInset(const std::vector< std::vector<bool> > & walkable, Walks & grid)
+    {
+        grid = Walks(walkable.size(), std::vector<short>(walkable[0].size()));
+        for (size_t x = 0; x < walkable.size(); ++x)
+        {
+            for (size_t y = 0; y < walkable[x].size(); ++y)
+            {
+                grid[x][y] = walkable[x][y] ? 1 : 0;
+            }
+        }
+        DistanceTransform::Manhattan(grid);
+    }
+
+    void TransformRoom(const Walks & inset, Walks & grid)
+    {
+        grid = Walks(inset.size());
+        for (size_t x = 0; x < inset.size(); ++x)
+        {
+            DistanceTransform::ColumnRoom(inset[x], grid[x]);
+        }
+    }
+
+    // Unwalkable blobs of random sizes, like cliffs and water.
+    std::vector< std::vector<bool> > SyntheticMap(int width, int height)
+    {
+        Random random(1);
+        std::vector< std::vector<bool> > walkable(width, std::vector<bool>(height, true));
+        for (int blob = 0; blob < width * height / 2000; ++blob)
+        {
+            const int cx = random.index(width);
+            const int cy = random.index(height);
+            const int r = 2 + random.index(40);
+            for (int x = std::max(0, cx - r); x < std::min(width, cx + r); ++x)
+            {
+                for (int y = std::max(0, cy - r); y < std::min(height, cy + r); ++y)
+                {
+                    if ((x - cx) * (x - cx) + (y - cy) * (y - cy) < r * r)
+                    {
+                        walkable[x][y] = false;
+                    }
+                }
+            }
+        }
+        return walkable;
+    }
+
+    template <class F>
+    double Milliseconds(F f, int repetitions)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            f();
+        }
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repetitions;
+    }
+}
+
+int MapBenchMain(int argc, char * argv[])
+{
+    std::vector< std::vector<bool> > walkable;
+    if (argc > 1)
+    {
+        FrameCaptureReader reader;
+        if (!reader.open(argv[1]))
+        {
+            std::cerr << "cannot read capture file " << argv[1] << '\n';
+            return 1;
+        }
+        const int width = 4 * reader.header().mapWidth;
+        const int height = 4 * reader.header().mapHeight;
+        walkable.assign(width, std::vector<bool>(height));
+        for (int x = 0; x < width; ++x)
+        {
+            for (int y = 0; y < height; ++y)
+            {
+                walkable[x][y] = reader.walkable(x, y);
+            }
+        }
+        std::cout << "map " << reader.mapName();
+    }
+    else
+    {
+        walkable = SyntheticMap(1024, 1024);
+        std::cout << "synthetic map";
+    }
+    std::cout << ", " << walkable.size() << "x" << walkable[0].size() << " walk tiles\n";
+
+    const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+
+    Walks refInset, refRoom, inset, room;
+    const double refInsetMs = Milliseconds([&]() { ReferenceInset(walkable, refInset); }, repetitions);
+    const double refRoomMs = Milliseconds([&]() { ReferenceRoom(refInset, refRoom); }, repetitions);
+    const double insetMs = Milliseconds([&]() { TransformInset(walkable, inset); }, repetitions);
+    const double roomMs = Milliseconds([&]() { TransformRoom(inset, room); }, repetitions);
+
+    const bool same = inset == refInset && room == refRoom;
+    std::cout << "inset ms " << refInsetMs << " -> " << insetMs
+        << ", room ms " << refRoomMs << " -> " << roomMs
+        << ", outputs " << (same ? "identical" : "DIFFERENT") << '\n';
+
+    return same ? 0 : 1;
+}
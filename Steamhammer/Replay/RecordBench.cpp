@@ -0,0 +1,215 @@
+// Opponent file load benchmark. Not part of the bot DLL.
+// Times reading the past game records of a synthetic opponent file, in text and binary
+// format, first the header fields only and then all details, and counts heap allocations.
+// One damaged 1.4 record is mixed in; it must be rejected without disturbing the others.
+// Part of the SteamhammerBench console program, see Bench.cpp.
+//
+// Usage: SteamhammerBench records [games] [repetitions]
+// Writes bench_records.txt and bench_records.bin in the current directory.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include "GameRecord.h"
+#include "OpponentFile.h"
+#include "Random.h"
+
+using namespace UAlbertaBot;
+
+int64_t BenchAllocations();
+
+namespace
+{
+    const char * TextFile = "bench_records.txt";
+    const char * BinaryFile = "bench_records.bin";
+
+    // 1.4 records of ZvT games on one map, with a snapshot every 720 frames.
+    std::string SyntheticRecords(int games)
+    {
+        Random random(1);
+        std::ostringstream text;
+        for (int game = 0; game < games; ++game)
+        {
+            text << "1.4\nZvT\nmaps/(4)Fighting Spirit.scx\n"
+                << (game % 3 ? "11Gas10PoolLurker\n" : "OverpoolSpeed\n")
+                << "Fast rush\nHeavy macro\n" << random.index(2) << '\n';
+            for (int i = 0; i < 11; ++i)
+            {
+                text << random.index(20000) << '\n';
+            }
+            const int gameEnd = 10000 + random.index(25000);
+            for (int frame = 2880; frame < gameEnd; frame += 720)
+            {
+                text << frame << '\n';
+                for (int side = 0; side < 2; ++side)
+                {
+                    text << 1 + frame / 8000;
+                    const int firstType = side ? 0 : 37;
+                    for (int k = 0; k < 8 + random.index(6); ++k)
+                    {
+                        text << ' ' << firstType + k << ' ' << 1 + random.index(30);
+                    }
+                    text << '\n';
+                }
+            }
+            text << "END GAME\n";
+
+            // A damaged record in the middle: a snapshot line that is not a number.
+            if (game == games / 2)
+            {
+                text << "1.4\nZvT\nmaps/(4)Fighting Spirit.scx\nOverpoolSpeed\nFast rush\nHeavy macro\n1\n";
+                for (int i = 0; i < 11; ++i)
+                {
+                    text << "0\n";
+                }
+                text << "2880\n1 37 4\ndamaged\nEND GAME\n";
+            }
+        }
+        return text.str();
+    }
+
+    struct LoadResult
+    {
+        double headerMs;
+        int64_t headerAllocations;
+        double detailsMs;
+        int64_t detailsAllocations;
+        size_t records;
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    double Since(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Read the header fields of every record, then make every record load its details.
+    template <class ReadAll>
+    LoadResult Load(ReadAll readAll)
+    {
+        LoadResult result;
+        std::vector<GameRecord *> records;
+
+        int64_t allocations = BenchAllocations();
+        Clock::time_point start = Clock::now();
+        readAll(records);
+        result.headerMs = Since(start);
+        result.headerAllocations = BenchAllocations() - allocations;
+
+        allocations = BenchAllocations();
+        start = Clock::now();
+        PlayerSnapshot snap;
+        for (GameRecord * record : records)
+        {
+            record->findClosestSnapshot(6000, snap);
+        }
+        result.detailsMs = Since(start);
+        result.detailsAllocations = BenchAllocations() - allocations;
+
+        result.records = records.size();
+        for (GameRecord * record : records)
+        {
+            delete record;
+        }
+        return result;
+    }
+
+    void Keep(LoadResult & best, const LoadResult & result)
+    {
+        best.headerMs = std::min(best.headerMs, result.headerMs);
+        best.detailsMs = std::min(best.detailsMs, result.detailsMs);
+        best.headerAllocations = result.headerAllocations;
+        best.detailsAllocations = result.detailsAllocations;
+        best.records = result.records;
+    }
+
+    void Report(const std::string & name, const LoadResult & result, std::ostream & out)
+    {
+        out << name
+            << " records " << result.records
+            << " header_ms " << result.headerMs << " allocs " << result.headerAllocations
+            << " +details_ms " << result.detailsMs << " allocs " << result.detailsAllocations
+            << '\n';
+    }
+}
+
+int RecordBenchMain(int argc, char * argv[])
+{
+    const int games = argc > 1 ? std::max(2, std::atoi(argv[1])) : 200;
+    const int repetitions = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    const std::string text = SyntheticRecords(games);
+    {
+        std::ofstream out(TextFile, std::ios::binary);
+        out << text;
+    }
+    if (!OpponentFile::ConvertTextToBinary(TextFile, BinaryFile))
+    {
+        std::cerr << "cannot convert " << TextFile << " to " << BinaryFile << '\n';
+        return 1;
+    }
+    std::cout << games << " games, " << text.size() << " bytes of text\n";
+
+    auto readText = [](std::vector<GameRecord *> & records)
+    {
+        std::ifstream input(TextFile);
+        while (input.good())
+        {
+            GameRecord * record = new GameRecord(input);
+            if (record->isValid())
+            {
+                records.push_back(record);
+            }
+            else
+            {
+                delete record;
+            }
+        }
+    };
+
+    // Records read from the binary file point into it, so it stays open until they are deleted.
+    OpponentFile file;
+    auto readBinary = [&file](std::vector<GameRecord *> & records)
+    {
+        if (file.open(BinaryFile))
+        {
+            for (const GameRecordView & view : file.records())
+            {
+                GameRecord * record = new GameRecord(view);
+                if (record->isValid())
+                {
+                    records.push_back(record);
+                }
+                else
+                {
+                    delete record;
+                }
+            }
+        }
+    };
+
+    LoadResult bestText = { 1e9, 0, 1e9, 0, 0 };
+    LoadResult bestBinary = { 1e9, 0, 1e9, 0, 0 };
+    for (int i = 0; i < repetitions; ++i)
+    {
+        Keep(bestText, Load(readText));
+        Keep(bestBinary, Load(readBinary));
+        file.close();
+    }
+    Report("text  ", bestText, std::cout);
+    Report("binary", bestBinary, std::cout);
+
+    // The damaged record must be dropped, and only it.
+    const bool ok = bestText.records == size_t(games) && bestBinary.records == size_t(games);
+    if (!ok)
+    {
+        std::cout << "expected " << games << " valid records\n";
+    }
+    return ok ? 0 : 1;
+}
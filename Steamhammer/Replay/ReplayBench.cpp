@@ -0,0 +1,42 @@
+// Headless replay benchmark. Not part of the bot DLL.
+// Part of the SteamhammerBench console program, see Bench.cpp.
+//
+// Usage: SteamhammerBench replay frames.bin [from frame] [repetitions]
+// Capture frames.bin in a game with the config options IO.CaptureFrames and IO.CaptureFrameInterval.
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+#include "FrameReplay.h"
+
+using namespace UAlbertaBot;
+
+int64_t BenchAllocations();
+
+int ReplayBenchMain(int argc, char * argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: " << argv[0] << " frames.bin [from frame] [repetitions]\n";
+        return 2;
+    }
+
+    FrameReplay replay(&BenchAllocations);
+    if (!replay.open(argv[1]))
+    {
+        std::cerr << "cannot read capture file " << argv[1] << '\n';
+        return 1;
+    }
+
+    const int fromFrame = argc > 2 ? std::atoi(argv[2]) : 0;
+    const int repetitions = argc > 3 ? std::max(1, std::atoi(argv[3])) : 1;
+
+    std::cout << "map " << replay.reader().mapName()
+        << ", " << replay.reader().frames().size() << " frames captured\n";
+    for (int i = 0; i < repetitions; ++i)
+    {
+        FrameReplay::Report(replay.run(fromFrame), std::cout);
+    }
+    return 0;
+}
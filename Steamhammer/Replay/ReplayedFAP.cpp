@@ -0,0 +1,68 @@
+#include "ReplayedFAP.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace UAlbertaBot;
+
+// Its stats were computed by FastAPproximation::CaptureStats() in the game,
+// or by FastAPproximation::TypeStats() for a synthetic battle.
+FastAPproximation::FAPUnit ReplayedFAP::Unit(const FrameCaptureFormat::CapturedUnit & unit)
+{
+    FAPUnit fu(BWAPI::UnitType(unit.type), unit.x, unit.y);
+
+    fu.health = 2 * unit.hitPoints;
+    fu.shields = 2 * unit.shields;
+    fu.underSwarm = (unit.flags & FrameCaptureFormat::Flag::UnderDarkSwarm) != 0;
+
+    fu.speed = unit.stats.speed;
+    fu.armor = unit.stats.armor;
+    fu.shieldArmor = unit.stats.shieldArmor;
+    fu.elevation = unit.stats.elevation;
+    fu.groundDamage = unit.stats.groundDamage;
+    fu.groundCooldown = unit.stats.groundCooldown;
+    fu.groundMaxRange = unit.stats.groundMaxRange;
+    fu.groundMinRange = unit.stats.groundMinRange;
+    fu.airDamage = unit.stats.airDamage;
+    fu.airCooldown = unit.stats.airCooldown;
+    fu.airMaxRange = unit.stats.airMaxRange;
+
+    return fu;
+}
+
+void ReplayedFAP::convertBunker(const FAPUnit & fu)
+{
+    const BWAPI::UnitType marine = BWAPI::UnitTypes::Terran_Marine;
+
+    // The bunker's range is the marines' range + 32. Ranges are squared.
+    const auto marineRange = [](int bunkerRangeSquared)
+    {
+        const int range = std::max(0, int(std::lround(std::sqrt(double(bunkerRangeSquared)))) - 32);
+        return range * range;
+    };
+
+    FAPUnit funew(marine, fu.x, fu.y);
+    funew.health = funew.maxHealth;
+    funew.speed = marine.topSpeed();
+    funew.armor = 2 * marine.armor();
+    funew.elevation = fu.elevation;
+    funew.groundDamage = fu.groundDamage;
+    funew.groundCooldown = marine.groundWeapon().damageCooldown();
+    funew.groundMaxRange = marineRange(fu.groundMaxRange);
+    funew.airDamage = fu.airDamage;
+    funew.airCooldown = marine.airWeapon().damageCooldown();
+    funew.airMaxRange = marineRange(fu.airMaxRange);
+    funew.attackCooldownRemaining = fu.attackCooldownRemaining;
+
+    fu.operator=(funew);
+}
+
+void ReplayedFAP::addIfCombatUnitPlayer1(const FrameCaptureFormat::CapturedUnit & unit)
+{
+    FastAPproximation::addIfCombatUnitPlayer1(Unit(unit));
+}
+
+void ReplayedFAP::addIfCombatUnitPlayer2(const FrameCaptureFormat::CapturedUnit & unit)
+{
+    FastAPproximation::addIfCombatUnitPlayer2(Unit(unit));
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "FAP.h"
+#include "FrameCapture.h"
+
+// The combat simulator, fed with captured or synthetic units instead of live ones.
+// A captured unit has no BWAPI::Player to ask about upgrades; the capture holds the stats
+// the simulator gave it in the game. Only the replay and the benchmarks use this.
+
+namespace UAlbertaBot
+{
+class ReplayedFAP : public FastAPproximation
+{
+    static FAPUnit Unit(const FrameCaptureFormat::CapturedUnit & unit);
+
+protected:
+    // A dead bunker becomes marines with the bunker's weapon, which already includes the
+    // owner's weapon upgrades. Only infantry armor upgrades are lost.
+    void convertBunker(const FAPUnit & fu) override;
+
+public:
+    void addIfCombatUnitPlayer1(const FrameCaptureFormat::CapturedUnit & unit);
+    void addIfCombatUnitPlayer2(const FrameCaptureFormat::CapturedUnit & unit);
+};
+
+}
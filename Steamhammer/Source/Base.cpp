@@ -99,10 +99,10 @@ BWAPI::Position Base::findMineralOffset() const
 
 // Create a base given its position and a set of resources that may belong to it.
 // The caller is responsible for eliminating resources which are too small to be worth it.
+// The caller must also call initializeDistances() before using the base.
 Base::Base(BWAPI::TilePosition pos, const BWAPI::Unitset & availableResources)
     : id(-1)        // invalid value, will be reset after bases are sorted
     , tilePosition(pos)
-    , distances(pos)
     , startingBase(findIsStartingBase())
     , naturalBase(nullptr)
     , mainBase(nullptr)
@@ -199,6 +199,13 @@ void Base::initializeNatural(const std::vector<Base *> & bases)
     }
 }
 
+// The ground distance map covers the whole map, so it is the slow part of creating a base.
+// It's not needed to find the bases, so it is computed afterward, for all bases in parallel.
+void Base::initializeDistances()
+{
+    distances = GridDistances(tilePosition);
+}
+
 // The "front line" of the base, where static defense and mobile defenders will go
 // if the base is the frontmost base.
 void Base::initializeFront()
@@ -434,10 +441,10 @@ BWAPI::Unit Base::getPylon() const
 bool Base::isExplored() const
 {
     return
-        BWAPI::Broodwar->isExplored(tilePosition) ||
-        BWAPI::Broodwar->isExplored(tilePosition + BWAPI::TilePosition(3, 2)) ||
-        BWAPI::Broodwar->isExplored(tilePosition + BWAPI::TilePosition(0, 2)) ||
-        BWAPI::Broodwar->isExplored(tilePosition + BWAPI::TilePosition(3, 0));
+        the.creep.explored(tilePosition) ||
+        the.creep.explored(tilePosition + BWAPI::TilePosition(3, 2)) ||
+        the.creep.explored(tilePosition + BWAPI::TilePosition(0, 2)) ||
+        the.creep.explored(tilePosition + BWAPI::TilePosition(3, 0));
 }
 
 // Should we be able to see the resource depot at this base?
@@ -446,10 +453,10 @@ bool Base::isExplored() const
 bool Base::isVisible() const
 {
     return
-        BWAPI::Broodwar->isVisible(tilePosition) ||
-        BWAPI::Broodwar->isVisible(tilePosition + BWAPI::TilePosition(3, 2)) ||
-        BWAPI::Broodwar->isVisible(tilePosition + BWAPI::TilePosition(0, 2)) ||
-        BWAPI::Broodwar->isVisible(tilePosition + BWAPI::TilePosition(3, 0));
+        the.creep.visible(tilePosition) ||
+        the.creep.visible(tilePosition + BWAPI::TilePosition(3, 2)) ||
+        the.creep.visible(tilePosition + BWAPI::TilePosition(0, 2)) ||
+        the.creep.visible(tilePosition + BWAPI::TilePosition(3, 0));
 }
 
 void Base::clearBlocker(BWAPI::Unit blocker)
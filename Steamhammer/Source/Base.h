@@ -45,6 +45,7 @@ public:
     Base(BWAPI::TilePosition pos, const BWAPI::Unitset & availableResources);
     void setID(int baseID);                 // called exactly once at startup
 
+    void initializeDistances();
     void initializeNatural(const std::vector<Base *> & bases);
     void initializeFront();
 
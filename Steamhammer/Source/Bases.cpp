@@ -1,7 +1,10 @@
 #include "Bases.h"
 
+#include "ClosestTiles.h"
+#include "MapCache.h"
 #include "MapTools.h"
 #include "InformationManager.h"
+#include "TaskGraph.h"
 #include "The.h"
 
 using namespace UAlbertaBot;
@@ -24,6 +27,7 @@ Bases::Bases()
     , naturalBase(nullptr)
     , islandStart(false)
     , islandBases(false)
+    , resourceError(false)
     , enemyStartingBase(nullptr)
 {
 }
@@ -153,12 +157,10 @@ BWAPI::TilePosition Bases::findBasePosition(BWAPI::Unitset resources)
 
     potentialBases.push_back(PotentialBase(left, right, top, bottom, centerOfResources));
 
-    GridDistances distances(centerOfResources, BasePositionRange, false);
-
     int bestScore = INT_MAX;               // smallest is best
     BWAPI::TilePosition bestTile = BWAPI::TilePositions::Invalid;
 
-    for (BWAPI::TilePosition tile : distances.getSortedTiles())
+    for (BWAPI::TilePosition tile : ClosestTiles(centerOfResources, BasePositionRange, false))
     {
         // NOTE Every resource depot is the same size, 4x3 tiles.
         if (the.map.isBuildable(tile, BWAPI::UnitTypes::Protoss_Nexus))    // TODO deprecated call
@@ -475,32 +477,26 @@ void Bases::updateSmallMinerals()
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
-// Find the bases on the map at the beginning of the game.
-void Bases::initialize()
+// Add a newly found base and remove its resources from the list.
+void Bases::addBase(Base * base, BWAPI::Unitset & resources)
 {
-    // Find the resources to mine: Mineral patches and geysers.
-    BWAPI::Unitset resources;
+    bases.push_back(base);
+    removeUsedResources(resources, base);
 
-    for (BWAPI::Unit unit : BWAPI::Broodwar->getStaticMinerals())
-    {
-        // Skip mineral patches with negligible resources. Bases don't belong there.
-        if (unit->getInitialResources() > 64)
-        {
-            resources.insert(unit);
-        }
-        else
-        {
-            smallMinerals.insert(unit);
-        }
-    }
-    for (BWAPI::Unit unit : BWAPI::Broodwar->getStaticGeysers())
+    if (base->isAStartingBase())
     {
-        if (unit->getInitialResources() > 0)
+        startingBases.push_back(base);
+        if (base->getTilePosition() == the.self()->getStartLocation())
         {
-            resources.insert(unit);
+            startingBase = base;
+            mainBase = base;
         }
     }
+}
 
+// Search for base locations near the resources.
+void Bases::findBases(BWAPI::Unitset & resources)
+{
     // Add the starting bases.
     // Remove their resources from the list.
     for (BWAPI::TilePosition pos : BWAPI::Broodwar->getStartLocations())
@@ -512,15 +508,8 @@ void Bases::initialize()
             delete base;
             continue;
         }
-        bases.push_back(base);
-        startingBases.push_back(base);
-        removeUsedResources(resources, base);
-
-        if (pos == the.self()->getStartLocation())
-        {
-            startingBase = base;
-            mainBase = base;
-        }
+        addBase(base, resources);
+        basePositions.push_back(pos);
     }
 
     // Add the remaining bases.
@@ -568,8 +557,8 @@ void Bases::initialize()
             // Check whether the base actually grabbed enough resources to be useful.
             if (base->getInitialMinerals() >= MinTotalMinerals || base->getInitialGas() >= MinTotalGas)
             {
-                removeUsedResources(resources, base);
-                bases.push_back(base);
+                addBase(base, resources);
+                basePositions.push_back(basePosition);
             }
             else
             {
@@ -592,13 +581,64 @@ void Bases::initialize()
         }
 
         // Error check. This should never happen.
+        // This runs on a map analysis thread, so the error is only noted here. The caller reports it.
         if (resources.size() >= priorResourceSize)
         {
-            BWAPI::Broodwar->printf("failed to remove any resources");
+            resourceError = true;
             break;
         }
         priorResourceSize = resources.size();
     }
+}
+
+// Create the bases at the positions read from the map cache.
+// Creating them in the order they were found assigns each the same resources as before.
+void Bases::addCachedBases(BWAPI::Unitset & resources)
+{
+    for (const BWAPI::TilePosition & pos : basePositions)
+    {
+        addBase(new Base(pos, resources), resources);
+    }
+}
+
+// Find the bases on the map at the beginning of the game.
+void Bases::initialize()
+{
+    // Find the resources to mine: Mineral patches and geysers.
+    BWAPI::Unitset resources;
+
+    for (BWAPI::Unit unit : BWAPI::Broodwar->getStaticMinerals())
+    {
+        // Skip mineral patches with negligible resources. Bases don't belong there.
+        if (unit->getInitialResources() > 64)
+        {
+            resources.insert(unit);
+        }
+        else
+        {
+            smallMinerals.insert(unit);
+        }
+    }
+    for (BWAPI::Unit unit : BWAPI::Broodwar->getStaticGeysers())
+    {
+        if (unit->getInitialResources() > 0)
+        {
+            resources.insert(unit);
+        }
+    }
+
+    // If the map cache was read, we already know where the bases are.
+    if (basePositions.empty())
+    {
+        findBases(resources);
+    }
+    else
+    {
+        addCachedBases(resources);
+    }
+
+    // Each base computes its ground distances independently.
+    TaskGraph::ParallelFor(int(bases.size()), [this](int i) { bases[i]->initializeDistances(); });
 
     // Fill in other map properties we want to remember.
     setBaseIDs();
@@ -615,12 +655,41 @@ void Bases::initialize()
     naturalBase = startingBase->getNatural();  // may be null, rarely is
 
     // The "front line" position for each base has dependencies set above.
-    for (Base * base : bases)
+    // Each base finds its own independently.
+    TaskGraph::ParallelFor(int(bases.size()), [this](int i) { bases[i]->initializeFront(); });
+}
+
+void Bases::write(MapCacheWriter & out) const
+{
+    out.putInt(int32_t(basePositions.size()));
+    for (const BWAPI::TilePosition & pos : basePositions)
     {
-        base->initializeFront();
+        out.putTile(pos);
     }
 }
 
+bool Bases::read(MapCacheReader & in)
+{
+    basePositions.clear();
+
+    int32_t nBases;
+    if (!in.getInt(nBases) || nBases <= 0 || nBases > 1024)
+    {
+        return false;
+    }
+    for (int i = 0; i < nBases; ++i)
+    {
+        BWAPI::TilePosition pos;
+        if (!in.getTile(pos))
+        {
+            basePositions.clear();
+            return false;
+        }
+        basePositions.push_back(pos);
+    }
+    return true;
+}
+
 void Bases::update()
 {
     updateEnemyStart();
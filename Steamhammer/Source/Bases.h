@@ -6,6 +6,8 @@
 
 namespace UAlbertaBot
 {
+    class MapCacheReader;
+    class MapCacheWriter;
     class The;
 
     class PotentialBase
@@ -40,14 +42,22 @@ namespace UAlbertaBot
 
         bool islandStart;
         bool islandBases;
+        bool resourceError;                         // findBases() got stuck; reported after the analysis
         std::map<BWAPI::Unit, Base *> baseBlockers;	// neutral building to destroy -> base it belongs to
 
+        // Where the bases were found, in the order found. Saved in the map cache.
+        // If it was read from the cache, the bases are created here without searching.
+        std::vector<BWAPI::TilePosition> basePositions;
+
         // Debug data structures. Not used for any other purpose, can be deleted with their uses.
         std::vector<BWAPI::Unitset> nonbases;
         std::vector<PotentialBase> potentialBases;
 
         Bases();
 
+        void addBase(Base * base, BWAPI::Unitset & resources);
+        void findBases(BWAPI::Unitset & resources);
+        void addCachedBases(BWAPI::Unitset & resources);
         void setBaseIDs();
         bool checkIslandStart() const;
         bool checkIslandBases() const;
@@ -74,6 +84,10 @@ namespace UAlbertaBot
     public:
         void initialize();
         void update();
+
+        // For the map cache.
+        void write(MapCacheWriter & out) const;
+        bool read(MapCacheReader & in);
         void checkBuildingPosition(const BWAPI::TilePosition & desired, const BWAPI::TilePosition & actual);
 
         void drawBaseInfo() const;
@@ -87,6 +101,7 @@ namespace UAlbertaBot
         BWAPI::TilePosition frontTile() const;
         bool isIslandStart() const { return islandStart; };
         bool hasIslandBases() const { return islandBases; };
+        bool hadResourceError() const { return resourceError; };
 
         Base * enemyStart() const { return enemyStartingBase; }		// null if unknown
 
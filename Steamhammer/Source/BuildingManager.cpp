@@ -506,21 +506,8 @@ void BuildingManager::addBuildingTask(const MacroAct & act, BWAPI::TilePosition
 
 bool BuildingManager::isBuildingPositionExplored(const Building & b) const
 {
-    BWAPI::TilePosition tile = b.finalPosition;
-
-    // For each tile where the building will be built, is the tile explored?
-    for (int x=0; x<b.type.tileWidth(); ++x)
-    {
-        for (int y=0; y<b.type.tileHeight(); ++y)
-        {
-            if (!BWAPI::Broodwar->isExplored(tile.x + x,tile.y + y))
-            {
-                return false;
-            }
-        }
-    }
-
-    return true;
+    // Is every tile where the building will be built explored?
+    return the.creep.allExplored(b.finalPosition, b.type.tileWidth(), b.type.tileHeight());
 }
 
 // Do we have a builder unit that can build?
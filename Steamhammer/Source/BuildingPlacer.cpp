@@ -79,31 +79,12 @@ void BuildingPlacer::setReserve(const BWAPI::TilePosition & position, int width,
 }
 
 // We want to build near the given tile, but it may not be walkable, which makes it awkward
-// to find nearby buildable tiles. Find a nearby buildable tile to start with.
+// to find nearby buildable tiles. Find the closest buildable tile connected to our start.
+// It is a lookup in a table made once in initialize().
 // NOTE This can fail in theory, but it should not happen on any reasonable map.
 BWAPI::TilePosition BuildingPlacer::connectedWalkableTileNear(const BWAPI::TilePosition & start) const
 {
-    BWAPI::TilePosition closestTile = BWAPI::TilePositions::None;
-    int closestDist = MAX_DISTANCE;
-
-    // We can step by twos because every building is at least 2x2 in size.
-    for (int x = 0; x < BWAPI::Broodwar->mapWidth(); x += 2)
-    {
-        for (int y = 0; y < BWAPI::Broodwar->mapHeight(); y += 2)
-        {
-            if (_buildable.at(x,y) > 0 && the.bases.connectedToStart(BWAPI::TilePosition(x, y)))
-            {
-                int dist = abs(x - start.x) + abs(y - start.y);
-                if (dist < closestDist)
-                {
-                    closestTile = BWAPI::TilePosition(x, y);
-                    closestDist = dist;
-                }
-            }
-        }
-    }
-
-    return closestTile;
+    return the.nearest.connectedBuildable(start);
 }
 
 // If we're building at the enemy base, we don't care if our building overlaps a base location.
@@ -300,6 +281,9 @@ bool BuildingPlacer::freeOnAllSides(BWAPI::Unit building) const
 bool BuildingPlacer::canBuildHere(const BWAPI::TilePosition & position, const Building & b) const
 {
     return
+        // Most zerg buildings need creep under every tile. This cheap check rules out most spots.
+        (!b.type.requiresCreep() || the.creep.allCreep(position, b.type.tileWidth(), b.type.tileHeight())) &&
+
         // BWAPI thinks the space is buildable.
         // This includes looking for units which may be in the way.
         BWAPI::Broodwar->canBuildHere(position, b.type, b.builderUnit) &&
@@ -596,10 +580,8 @@ BWAPI::TilePosition BuildingPlacer::findSpecialLocation(const Building & b) cons
 
 BWAPI::TilePosition BuildingPlacer::findAnyLocation(const Building & b, int extraSpace) const
 {
-    // Tiles sorted in order of closeness to the location.
-    const std::vector<BWAPI::TilePosition> & closest = the.map.getClosestTilesTo(b.desiredPosition);
-
-    for (const BWAPI::TilePosition & tile : closest)
+    // Tiles in order of closeness to the location, searched only as far as we look.
+    for (const BWAPI::TilePosition & tile : the.map.getClosestTilesTo(b.desiredPosition))
     {
         if (canBuildWithSpace(tile, b, extraSpace))
         {
@@ -636,6 +618,7 @@ void BuildingPlacer::initialize()
 
     reserveSpaceNearResources();
     _buildable.compute();
+    the.nearest.initializeConnectedBuildable(_buildable);
 }
 
 // Place a building other than an expansion.
@@ -963,9 +946,7 @@ BWAPI::TilePosition BuildingPlacer::getTerrainProxyPosition(const Base * base) c
 // Return an invalid tile on failure.
 BWAPI::TilePosition BuildingPlacer::getInBaseProxyPosition(const Base * base) const
 {
-    // Tiles sorted in order of closeness to the enemy main resource depot.
     const BWAPI::TilePosition enemyCenter = base->getCenterTile();
-    const std::vector<BWAPI::TilePosition> & closest = the.map.getClosestTilesTo(enemyCenter);
 
     // A fictitious large building to place.
     Building b(BWAPI::UnitTypes::Protoss_Nexus, BWAPI::TilePositions::None);
@@ -973,7 +954,8 @@ BWAPI::TilePosition BuildingPlacer::getInBaseProxyPosition(const Base * base) co
     const int myMinDist = the.bases.myMain()->getTileDistance(base->getTilePosition());
     int bestScore = 16;
     BWAPI::TilePosition bestTile = BWAPI::TilePositions::None;
-    for (const BWAPI::TilePosition & tile : closest)
+    // Tiles in order of closeness to the enemy main resource depot.
+    for (const BWAPI::TilePosition & tile : the.map.getClosestTilesTo(enemyCenter))
     {
         const int enemyDistX = abs(tile.x - enemyCenter.x);
         const int enemyDistY = abs(tile.y - enemyCenter.y);
@@ -1081,7 +1063,7 @@ BWAPI::TilePosition BuildingPlacer::getAntiCannonSunkenPosition(const Base * bas
         for (int y = base->getCenterTile().y - offset; y <= base->getCenterTile().y + offset; ++y)
         {
             BWAPI::TilePosition xy(x, y);
-            if (xy.isValid() && BWAPI::Broodwar->hasCreep(xy))
+            if (the.creep.creep(xy))
             {
                 // The approximate center of where the cannon will be if placed at tile xy.
                 const BWAPI::Position xyCenter = BWAPI::Position(xy) + BWAPI::Position(32, 32);
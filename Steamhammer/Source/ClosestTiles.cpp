@@ -0,0 +1,73 @@
+#include "ClosestTiles.h"
+
+#include "The.h"
+
+using namespace UAlbertaBot;
+
+ClosestTiles::ClosestTiles(const BWAPI::TilePosition & start, bool neutralBlocks)
+    : ClosestTiles(start, MAX_DISTANCE, neutralBlocks)
+{
+}
+
+// Like GridDistances, the start tile is produced even if it is not walkable.
+ClosestTiles::ClosestTiles(const BWAPI::TilePosition & start, int limit, bool neutralBlocks)
+    : width(BWAPI::Broodwar->mapWidth())
+    , height(BWAPI::Broodwar->mapHeight())
+    , limit(limit)
+    , neutralBlocks(neutralBlocks)
+    , visited(width * height, false)
+    , expanded(0)
+{
+    if (start.isValid())
+    {
+        visited[start.x + start.y * width] = true;
+        fringe.push_back(start);
+        distance.push_back(0);
+    }
+}
+
+// Search until the fringe holds tile i, or until the search runs out of tiles.
+// The fringe is in breadth-first order, so tile i is final as soon as it is added.
+bool ClosestTiles::reach(size_t i)
+{
+    const size_t LegalActions = 4;
+    const int actionX[LegalActions] = { 1, -1, 0, 0 };
+    const int actionY[LegalActions] = { 0, 0, 1, -1 };
+
+    while (fringe.size() <= i && expanded < fringe.size())
+    {
+        const BWAPI::TilePosition tile = fringe[expanded];
+        const int nextDist = distance[expanded] + 1;
+        ++expanded;
+
+        if (nextDist > limit)
+        {
+            continue;
+        }
+
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const BWAPI::TilePosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+            if (nextTile.isValid() &&
+                !visited[nextTile.x + nextTile.y * width] &&
+                (neutralBlocks ? the.map.isWalkable(nextTile) : the.map.isTerrainWalkable(nextTile)))
+            {
+                visited[nextTile.x + nextTile.y * width] = true;
+                fringe.push_back(nextTile);
+                distance.push_back(nextDist);
+            }
+        }
+    }
+
+    return i < fringe.size();
+}
+
+ClosestTiles::iterator ClosestTiles::begin()
+{
+    return iterator(this, reach(0) ? 0 : End);
+}
+
+ClosestTiles::iterator ClosestTiles::end()
+{
+    return iterator(this, End);
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "BWAPI.h"
+
+// The walkable tiles in order of ground distance from a start tile, produced on demand.
+// Use it in a range-for loop and break out when you have found what you want:
+//     for (const BWAPI::TilePosition & tile : ClosestTiles(start)) ...
+
+// It is the same breadth-first search as GridDistances, but lazy. The search expands a tile
+// only when the loop has asked for every tile that was found before it, so a loop that
+// stops after n tiles pays for about n tiles and their neighbors, not for the whole map.
+// Distances are Manhattan, 4-connected, like GridDistances.
+
+namespace UAlbertaBot
+{
+class ClosestTiles
+{
+public:
+    class iterator
+    {
+        ClosestTiles * tiles;
+        size_t i;
+
+    public:
+        iterator(ClosestTiles * closest, size_t index) : tiles(closest), i(index) {};
+
+        const BWAPI::TilePosition & operator*() const { return tiles->fringe[i]; };
+        iterator & operator++() { i = tiles->reach(i + 1) ? i + 1 : End; return *this; };
+        bool operator==(const iterator & other) const { return i == other.i; };
+        bool operator!=(const iterator & other) const { return i != other.i; };
+
+        // Ground distance in tiles from the start to the current tile.
+        int distance() const { return tiles->distance[i]; };
+    };
+
+private:
+    static const size_t End = SIZE_MAX;
+
+    int width;
+    int height;
+    int limit;
+    bool neutralBlocks;
+
+    std::vector<bool> visited;                  // by rows
+    std::vector<BWAPI::TilePosition> fringe;    // in order of distance
+    std::vector<int> distance;                  // of each fringe tile
+    size_t expanded;                            // fringe tiles whose neighbors have been added
+
+    bool reach(size_t i);
+
+public:
+    // Set neutralBlocks = false to pretend that static neutral units do not block walking.
+    // Tiles farther than the limit are left out.
+    ClosestTiles(const BWAPI::TilePosition & start, bool neutralBlocks = true);
+    ClosestTiles(const BWAPI::TilePosition & start, int limit, bool neutralBlocks = true);
+
+    iterator begin();
+    iterator end();
+};
+
+}
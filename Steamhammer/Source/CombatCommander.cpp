@@ -7,6 +7,7 @@
 #include "BuildingPlacer.h"
 #include "MapGrid.h"
 #include "Micro.h"
+#include "Profiler.h"
 #include "Random.h"
 #include "UnitUtil.h"
 
@@ -761,6 +762,8 @@ Base * CombatCommander::getReconLocation() const
 //      Other air units always go into the flying squad (except scourge, they are in their own squad).
 void CombatCommander::updateAttackSquads()
 {
+    ProfileZone zone("CombatCommander::updateAttackSquads");
+
     Squad & groundSquad = _squadData.getSquad("Ground");
     Squad & flyingSquad = _squadData.getSquad("Flying");
 
@@ -1032,6 +1035,8 @@ void CombatCommander::updateScoutDefenseSquad()
 
 void CombatCommander::updateBaseDefenseSquads()
 {
+    ProfileZone zone("CombatCommander::updateBaseDefenseSquads");
+
     const int baseDefenseRadius = 19 * 32;
     const int baseDefenseHysteresis = 10 * 32;
     const int pullWorkerDistance = 8 * 32;
@@ -1515,17 +1520,15 @@ void CombatCommander::loadOrUnloadBunkers()
             bool enemyIsNear = false;
 
             // 1. Is any enemy unit within a small radius?
-            BWAPI::Unitset enemiesNear = BWAPI::Broodwar->getUnitsInRadius(bunker->getPosition(), 12 * 32,
-                BWAPI::Filter::IsEnemy);
-            if (enemiesNear.empty())
+            if (!the.unitIndex.anyUnitInRadius(bunker->getPosition(), 12 * 32,
+                BWAPI::Filter::IsEnemy))
             {
                 // 2. Is a fast enemy unit within a wider radius?
-                enemiesNear = BWAPI::Broodwar->getUnitsInRadius(bunker->getPosition(), 18 * 32,
+                enemyIsNear = the.unitIndex.anyUnitInRadius(bunker->getPosition(), 18 * 32,
                     BWAPI::Filter::IsEnemy &&
                         (BWAPI::Filter::GetType == BWAPI::UnitTypes::Terran_Vulture ||
                          BWAPI::Filter::GetType == BWAPI::UnitTypes::Zerg_Mutalisk)
                     );
-                enemyIsNear = !enemiesNear.empty();
             }
             else
             {
@@ -1537,7 +1540,7 @@ void CombatCommander::loadOrUnloadBunkers()
                 // Load one marine at a time if there is free space.
                 if (bunker->getSpaceRemaining() > 0)
                 {
-                    BWAPI::Unit marine = BWAPI::Broodwar->getClosestUnit(
+                    BWAPI::Unit marine = the.unitIndex.getClosestUnit(
                         bunker->getPosition(),
                         BWAPI::Filter::IsOwned && BWAPI::Filter::GetType == BWAPI::UnitTypes::Terran_Marine,
                         12 * 32);
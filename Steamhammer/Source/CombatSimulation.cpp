@@ -1,6 +1,7 @@
 #include "CombatSimulation.h"
 
 #include "FAP.h"
+#include "Profiler.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -256,7 +257,7 @@ void CombatSimulation::setCombatUnits
     }
 
     PlayerSnapshot snap;
-    std::map<BWAPI::UnitType, int> & enemyCounts = snap.unitCounts;
+    UnitCounts & enemyCounts = snap.unitCounts;
 
     _whichEnemies = analyzeForEnemies(myUnits);
     _allFriendliesFlying = allFlying(myUnits);
@@ -367,6 +368,12 @@ void CombatSimulation::setCombatUnits
         biggestBattleFrame = the.now();
         biggestBattleCenter = ourCenter;
         biggestBattleEnemies = snap;
+
+        SkillEvent event(SkillEventType::BattleStarted);
+        event.player = the.enemy();
+        event.position = ourCenter;
+        event.value = snap.getSupply();
+        the.skillkit.post(event);
     }
 
     // Add our units.
@@ -408,6 +415,8 @@ void CombatSimulation::setCombatUnits
 // Simulate combat and return the result as a score. Score >= 0 means we win.
 double CombatSimulation::simulateCombat(bool meatgrinder)
 {
+    ProfileZone zone("CombatSimulation::simulateCombat");
+
     std::pair<int, int> startScores = fap.playerScores();
     if (startScores.second == 0)
     {
@@ -25,9 +25,14 @@ namespace Config
         std::string ReadDir                 = "bwapi-data/read/";
         std::string WriteDir				= "bwapi-data/write/";
         std::string OpeningTimingFile       = "timings.txt";
+        std::string OpeningBookFile         = "openings.bin";
         int MaxGameRecords					= 0;
         bool ReadOpponentModel				= false;
         bool WriteOpponentModel				= false;
+        bool BinaryOpponentModel            = true;
+        bool WriteProfile                   = false;
+        bool CaptureFrames                  = false;
+        int CaptureFrameInterval            = 24;
     }
 
     namespace Skills
@@ -122,6 +127,7 @@ namespace Config
     namespace Micro
     {
         bool KiteWithRangedUnits            = true;
+        bool LimitOverkill                  = true;     // ranged units spread fire when a target is already doomed
         bool WorkersDefendRush              = false;
         int RetreatMeleeUnitShields         = 0;
         int RetreatMeleeUnitHP              = 0;
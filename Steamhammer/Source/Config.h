@@ -30,9 +30,14 @@ namespace Config
         extern std::string ReadDir;
         extern std::string WriteDir;
         extern std::string OpeningTimingFile;
+        extern std::string OpeningBookFile;
         extern int MaxGameRecords;
         extern bool ReadOpponentModel;
         extern bool WriteOpponentModel;
+        extern bool BinaryOpponentModel;
+        extern bool WriteProfile;
+        extern bool CaptureFrames;
+        extern int CaptureFrameInterval;
     }
 
     namespace Skills
@@ -117,6 +122,7 @@ namespace Config
     namespace Micro
     {
         extern bool KiteWithRangedUnits;
+        extern bool LimitOverkill;
         extern bool WorkersDefendRush;
         extern int RetreatMeleeUnitShields;
         extern int RetreatMeleeUnitHP;
@@ -0,0 +1,91 @@
+#include "DistanceTransform.h"
+
+#include <algorithm>
+
+using namespace UAlbertaBot;
+
+void DistanceTransform::Manhattan(std::vector< std::vector<short> > & grid)
+{
+    if (grid.empty())
+    {
+        return;
+    }
+    const size_t height = grid[0].size();
+
+    // 1. Distance within each column, counting the ends of the column as blocked.
+    for (std::vector<short> & column : grid)
+    {
+        short d = 0;
+        for (size_t y = 0; y < height; ++y)
+        {
+            d = column[y] == 0 ? 0 : short(d + 1);
+            column[y] = d;
+        }
+        d = 0;
+        for (size_t y = height; y-- > 0; )
+        {
+            d = column[y] == 0 ? 0 : std::min(short(d + 1), column[y]);
+            column[y] = d;
+        }
+    }
+
+    // 2. Combine the columns, left to right and then right to left.
+    // The columns off the edges count as all blocked. Blocked tiles stay 0.
+    for (std::vector<short> * edge : { &grid.front(), &grid.back() })
+    {
+        for (short & d : *edge)
+        {
+            d = std::min(d, short(1));
+        }
+    }
+    for (size_t x = 1; x < grid.size(); ++x)
+    {
+        short * column = grid[x].data();
+        const short * left = grid[x - 1].data();
+        for (size_t y = 0; y < height; ++y)
+        {
+            column[y] = std::min(column[y], short(left[y] + 1));
+        }
+    }
+    for (size_t x = grid.size() - 1; x-- > 0; )
+    {
+        short * column = grid[x].data();
+        const short * right = grid[x + 1].data();
+        for (size_t y = 0; y < height; ++y)
+        {
+            column[y] = std::min(column[y], short(right[y] + 1));
+        }
+    }
+}
+
+// A stretch climbs through rises and flats to its peak, then descends through drops and
+// flats. It ends before the next rise, at a blocked tile, or at the end of the column.
+void DistanceTransform::ColumnRoom(const std::vector<short> & inset, std::vector<short> & room)
+{
+    const size_t height = inset.size();
+    room.resize(height);
+
+    size_t y = 0;
+    while (y < height)
+    {
+        if (inset[y] <= 0)
+        {
+            room[y] = -1;
+            ++y;
+            continue;
+        }
+
+        const size_t start = y;
+        while (y + 1 < height && inset[y + 1] >= inset[y])
+        {
+            ++y;
+        }
+        const short peak = inset[y];
+        while (y + 1 < height && inset[y + 1] > 0 && inset[y + 1] <= inset[y])
+        {
+            ++y;
+        }
+        std::fill(room.begin() + start, room.begin() + y + 1, peak);
+        ++y;
+    }
+}
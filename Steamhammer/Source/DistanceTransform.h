@@ -0,0 +1,26 @@
+#pragma once
+
+#include <vector>
+
+// Whole-grid computations for the walk tile grids GridInset and GridRoom.
+// Grids are stored as columns, grid[x][y], like Grid.
+
+namespace UAlbertaBot
+{
+class DistanceTransform
+{
+public:
+    // Exact 4-connected (Manhattan) distance to the nearest blocked tile, in two separable passes.
+    // On entry, 0 means blocked and any other value means open. Tiles off the edge count as
+    // blocked, so an open tile on the edge gets 1. Blocked tiles stay 0.
+    // The first pass runs down each column. The second runs across the columns, comparing
+    // whole columns element by element, which the compiler can vectorize.
+    static void Manhattan(std::vector< std::vector<short> > & grid);
+
+    // Vertical room in one column, given the column of inset values.
+    // The column is split into stretches that rise to a peak and fall to the next valley,
+    // and each stretch gets its peak value. Blocked tiles (inset <= 0) get -1.
+    static void ColumnRoom(const std::vector<short> & inset, std::vector<short> & room);
+};
+
+}
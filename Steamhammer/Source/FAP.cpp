@@ -16,6 +16,8 @@ UAlbertaBot::FastAPproximation fap;
 
 namespace UAlbertaBot {
 
+    static int nextUnitID = 0;
+
     FastAPproximation::FastAPproximation() {
 
     }
@@ -40,7 +42,8 @@ namespace UAlbertaBot {
         }
     }
 
-    void FastAPproximation::simulate(int nFrames) {
+    int FastAPproximation::simulate(int nFrames) {
+        int frames = 0;
         while (nFrames--) {
             if (!player1.size() || !player2.size())
                 break;
@@ -48,19 +51,22 @@ namespace UAlbertaBot {
             didSomething = false;
 
             isimulate(false);
+            ++frames;
 
             if (!didSomething)
                 break;
         }
+        return frames;
     }
 
-    void FastAPproximation::simulateRetreat(const BWAPI::Position & retreatTo, int nFrames) {
+    int FastAPproximation::simulateRetreat(const BWAPI::Position & retreatTo, int nFrames) {
         if (!player2.size())
         {
-            return;
+            return 0;
         }
         targetPosition = retreatTo;
 
+        int frames = 0;
         while (nFrames--) {
             if (!player1.size())
                 break;
@@ -68,10 +74,12 @@ namespace UAlbertaBot {
             didSomething = false;
 
             isimulate(true);
+            ++frames;
 
             if (!didSomething)
                 break;
         }
+        return frames;
     }
     
     std::pair <int, int> FastAPproximation::playerScores() const {
@@ -412,7 +420,7 @@ namespace UAlbertaBot {
 
     void FastAPproximation::unitDeath(const FAPUnit &fu, std::vector<FAPUnit> &itsFriendlies) {
         if (fu.unitType == BWAPI::UnitTypes::Terran_Bunker) {
-            convertToUnitType(fu, BWAPI::UnitTypes::Terran_Marine);
+            convertBunker(fu);
 
             for(unsigned i = 0; i < 4; ++ i)
                 itsFriendlies.push_back(fu);
@@ -433,9 +441,101 @@ namespace UAlbertaBot {
         fu.operator=(funew);
     }
 
+    void FastAPproximation::convertBunker(const FAPUnit &fu)
+    {
+        convertToUnitType(fu, BWAPI::UnitTypes::Terran_Marine);
+    }
+
     FastAPproximation::FAPUnit::FAPUnit(BWAPI::Unit u): FAPUnit(UnitInfo(u)) {
     }
 
+    // A unit with no player to ask about upgrades. What follows from the type is set here;
+    // the caller sets health, shields, speed, armor and weapon stats.
+    FastAPproximation::FAPUnit::FAPUnit(BWAPI::UnitType type, int x, int y) :
+        x(x),
+        y(y),
+
+        maxHealth(2 * type.maxHitPoints()),
+        maxShields(2 * type.maxShields()),
+        flying(type.isFlyer()),
+
+        groundDamageType(type == BWAPI::UnitTypes::Protoss_Carrier
+            ? BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon().damageType()
+            : type.groundWeapon().damageType()),
+        airDamageType(type == BWAPI::UnitTypes::Protoss_Carrier
+            ? BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon().damageType()
+            : type.airWeapon().damageType()),
+
+        unitType(type),
+        isOrganic(type.isOrganic()),
+        score(unitScore(type))
+    {
+        id = nextUnitID++;
+    }
+
+    void FastAPproximation::CaptureStats(BWAPI::Unit unit, FrameCaptureFormat::CombatStats & stats) {
+        const FAPUnit fu(unit);
+        stats.speed = float(fu.speed);
+        stats.armor = fu.armor;
+        stats.shieldArmor = fu.shieldArmor;
+        stats.groundDamage = fu.groundDamage;
+        stats.groundCooldown = fu.groundCooldown;
+        stats.groundMaxRange = fu.groundMaxRange;
+        stats.groundMinRange = fu.groundMinRange;
+        stats.airDamage = fu.airDamage;
+        stats.airCooldown = fu.airCooldown;
+        stats.airMaxRange = fu.airMaxRange;
+        stats.elevation = fu.elevation;
+    }
+
+    // A simplified version of the UnitInfo constructor, with no player to ask about upgrades.
+    // Every weapon and armor upgrade is at the given level; there are no speed or range upgrades.
+    void FastAPproximation::TypeStats(BWAPI::UnitType type, int upgradeLevel, FrameCaptureFormat::CombatStats & stats) {
+        BWAPI::WeaponType ground = type.groundWeapon();
+        BWAPI::WeaponType air = type.airWeapon();
+        int groundRange = ground.maxRange();
+        int airRange = air.maxRange();
+        int groundHits = type.maxGroundHits();
+        int airHits = type.maxAirHits();
+
+        if (type == BWAPI::UnitTypes::Protoss_Carrier) {
+            ground = air = BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon();
+            groundRange = airRange = 32 * 8;
+            groundHits = airHits = 1;
+        }
+        else if (type == BWAPI::UnitTypes::Terran_Bunker) {
+            ground = air = BWAPI::WeaponTypes::Gauss_Rifle;
+            groundRange = airRange = ground.maxRange() + 32;
+            groundHits = airHits = 4;
+        }
+        else if (type == BWAPI::UnitTypes::Protoss_Reaver) {
+            ground = BWAPI::WeaponTypes::Scarab;
+        }
+
+        auto damage = [&](BWAPI::WeaponType weapon) {
+            return (weapon.damageAmount() + upgradeLevel * weapon.damageBonus()) * weapon.damageFactor();
+        };
+        auto cooldown = [&](BWAPI::WeaponType weapon, int hits) {
+            return weapon.damageFactor() && hits ? weapon.damageCooldown() / (weapon.damageFactor() * hits) : 0;
+        };
+
+        stats.speed = float(type.topSpeed());
+        stats.armor = 2 * (type.armor() + upgradeLevel);
+        stats.shieldArmor = type.maxShields() ? 2 * upgradeLevel : 0;
+        stats.groundDamage = 2 * damage(ground);
+        stats.groundCooldown = cooldown(ground, groundHits);
+        stats.groundMaxRange = groundRange * groundRange;
+        stats.groundMinRange = ground.minRange() * ground.minRange();
+        stats.airDamage = 2 * damage(air);
+        stats.airCooldown = cooldown(air, airHits);
+        stats.airMaxRange = airRange * airRange;
+        stats.elevation = type.isFlyer() ? -1 : 0;
+
+        if (type == BWAPI::UnitTypes::Protoss_Carrier) {
+            stats.groundCooldown = stats.airCooldown = 5;
+        }
+    }
+
     FastAPproximation::FAPUnit::FAPUnit(const UnitInfo & ui) :
         x(ui.lastPosition.x),
         y(ui.lastPosition.y),
@@ -467,8 +567,7 @@ namespace UAlbertaBot {
         score(unitScore(ui.type)),
         player(ui.player)
     {
-        static int nextId = 0;
-        id = nextId++;
+        id = nextUnitID++;
 
         if (ui.type == BWAPI::UnitTypes::Protoss_Carrier) {
             groundDamage = ui.player->damage(BWAPI::UnitTypes::Protoss_Interceptor.groundWeapon());
@@ -1,13 +1,16 @@
 #pragma once
 
+#include "FrameCapture.h"
 #include "UnitData.h"
 
 namespace UAlbertaBot {
 
     class FastAPproximation {
+    protected:
         struct FAPUnit {
             FAPUnit(BWAPI::Unit u);
             FAPUnit(const UnitInfo & ui);
+            FAPUnit(BWAPI::UnitType type, int x, int y);                // no player; the caller sets the stats
 
             const FAPUnit &operator= (const FAPUnit & other) const;
             double unitSpeed(const UnitInfo & ui) const;
@@ -65,14 +68,22 @@ namespace UAlbertaBot {
         public:
 
             FastAPproximation();
+            virtual ~FastAPproximation() {}
+
+            // For frame capture: the stats the simulator would give the unit.
+            static void CaptureStats(BWAPI::Unit unit, FrameCaptureFormat::CombatStats & stats);
+
+            // For synthetic battles: the stats of a unit type with all weapons and armor at one upgrade level.
+            static void TypeStats(BWAPI::UnitType type, int upgradeLevel, FrameCaptureFormat::CombatStats & stats);
 
             void addUnitPlayer1(FAPUnit fu);
             void addIfCombatUnitPlayer1(FAPUnit fu);
             void addUnitPlayer2(FAPUnit fu);
             void addIfCombatUnitPlayer2(FAPUnit fu);
 
-            void simulate(int nFrames = 4 * 24); // 4 seconds on fastest
-            void simulateRetreat(const BWAPI::Position & retreatTo, int nFrames = 2 * 24);
+            // Return the number of frames simulated, which is less if the fight ends early.
+            int simulate(int nFrames = 4 * 24); // 4 seconds on fastest
+            int simulateRetreat(const BWAPI::Position & retreatTo, int nFrames = 2 * 24);
 
             std::pair <int, int> playerScores() const;
             std::pair <int, int> playerScoresUnits() const;
@@ -100,6 +111,10 @@ namespace UAlbertaBot {
             void isimulate(bool retreat);
             void unitDeath(const FAPUnit & fu, std::vector <FAPUnit> &itsFriendlies);
             void convertToUnitType(const FAPUnit &fu, BWAPI::UnitType ut);
+
+        protected:
+            // A dead bunker becomes its marines. A subclass whose units have no player overrides this.
+            virtual void convertBunker(const FAPUnit &fu);
     };
 
 }
@@ -0,0 +1,36 @@
+#include "FlowFields.h"
+
+using namespace UAlbertaBot;
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Return the shared distance map to the destination, computing it if no one holds it.
+std::shared_ptr<const GridDistances> FlowFields::get(const BWAPI::TilePosition & destination)
+{
+    auto it = _fields.find(destination);
+    if (it != _fields.end())
+    {
+        std::shared_ptr<const GridDistances> field = it->second.lock();
+        if (field)
+        {
+            return field;
+        }
+    }
+
+    // Forget the destinations that no order holds any more.
+    for (it = _fields.begin(); it != _fields.end(); )
+    {
+        if (it->second.expired())
+        {
+            it = _fields.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    std::shared_ptr<const GridDistances> field = std::make_shared<GridDistances>(destination);
+    _fields[destination] = field;
+    return field;
+}
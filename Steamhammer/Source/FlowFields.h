@@ -0,0 +1,22 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include "GridDistances.h"
+
+// Shared ground distance maps, one per destination tile.
+// Every squad order going to the same tile holds the same map, so it is computed once
+// however many squads and units are moving there. Units follow its waypoints; see
+// GridDistances::getWaypoint(). The map is freed when the last order holding it goes away.
+
+namespace UAlbertaBot
+{
+class FlowFields
+{
+    std::map<BWAPI::TilePosition, std::weak_ptr<const GridDistances>> _fields;
+
+public:
+    std::shared_ptr<const GridDistances> get(const BWAPI::TilePosition & destination);
+};
+
+}
@@ -0,0 +1,337 @@
+#include "FrameCapture.h"
+
+#include <cstring>
+
+#include "Config.h"
+#include "FAP.h"
+#include "The.h"
+
+using namespace UAlbertaBot;
+using namespace UAlbertaBot::FrameCaptureFormat;
+
+namespace
+{
+    void WriteInt(std::ostream & output, int32_t n)
+    {
+        output.write(reinterpret_cast<const char *>(&n), sizeof(n));
+    }
+
+    void WriteString(std::ostream & output, const std::string & s)
+    {
+        static const char zeros[4] = { 0, 0, 0, 0 };
+        WriteInt(output, int32_t(s.size()));
+        output.write(s.data(), s.size());
+        output.write(zeros, (4 - s.size() % 4) % 4);
+    }
+
+    // Bits packed 32 to a word, low bit first.
+    void WriteBits(std::ostream & output, const std::vector<bool> & bits)
+    {
+        for (size_t i = 0; i < bits.size(); i += 32)
+        {
+            uint32_t word = 0;
+            for (size_t j = 0; j < 32 && i + j < bits.size(); ++j)
+            {
+                if (bits[i + j])
+                {
+                    word |= 1u << j;
+                }
+            }
+            WriteInt(output, int32_t(word));
+        }
+    }
+
+    // Read from a buffer, failing without reading past its end.
+    class CaptureReader
+    {
+    private:
+        const char * _p;
+        const char * _end;
+
+    public:
+        CaptureReader(const char * data, size_t size)
+            : _p(data)
+            , _end(data + size)
+        {
+        }
+
+        const char * position() const { return _p; };
+        size_t remaining() const { return size_t(_end - _p); };
+
+        bool skip(size_t size)
+        {
+            if (size > remaining())
+            {
+                return false;
+            }
+            _p += size;
+            return true;
+        }
+
+        bool getInt(int32_t & n)
+        {
+            if (remaining() < sizeof(n))
+            {
+                return false;
+            }
+            std::memcpy(&n, _p, sizeof(n));
+            _p += sizeof(n);
+            return true;
+        }
+
+        bool getString(std::string & s)
+        {
+            int32_t length;
+            if (!getInt(length) || length < 0 || size_t(length) > remaining())
+            {
+                return false;
+            }
+            s.assign(_p, length);
+            return skip(length + (4 - length % 4) % 4);
+        }
+
+        bool getBits(std::vector<bool> & bits, size_t n)
+        {
+            bits.assign(n, false);
+            for (size_t i = 0; i < n; i += 32)
+            {
+                int32_t word;
+                if (!getInt(word))
+                {
+                    return false;
+                }
+                for (size_t j = 0; j < 32 && i + j < n; ++j)
+                {
+                    bits[i + j] = (uint32_t(word) >> j) & 1;
+                }
+            }
+            return true;
+        }
+    };
+
+    uint16_t UnitFlags(BWAPI::Unit unit)
+    {
+        uint16_t flags = 0;
+        if (unit->isCompleted())      flags |= Flag::Completed;
+        if (unit->isFlying())         flags |= Flag::Flying;
+        if (unit->isBurrowed())       flags |= Flag::Burrowed;
+        if (unit->isCloaked())        flags |= Flag::Cloaked;
+        if (unit->isLifted())         flags |= Flag::Lifted;
+        if (unit->isPowered())        flags |= Flag::Powered;
+        if (unit->isStimmed())        flags |= Flag::Stimmed;
+        if (unit->isEnsnared())       flags |= Flag::Ensnared;
+        if (unit->isUnderDarkSwarm()) flags |= Flag::UnderDarkSwarm;
+        if (unit->isDetected())       flags |= Flag::Detected;
+        return flags;
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+FrameCapture::FrameCapture()
+    : _capturing(false)
+{
+}
+
+void FrameCapture::writeMap()
+{
+    const int width = BWAPI::Broodwar->mapWidth();
+    const int height = BWAPI::Broodwar->mapHeight();
+
+    FileHeader header = {
+        Magic,
+        Version,
+        width,
+        height,
+        int32_t(BWAPI::Broodwar->getStartLocations().size()),
+        the.selfRace().getID(),
+        the.enemyRace().getID()
+    };
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    WriteString(_file, BWAPI::Broodwar->mapFileName());
+    WriteString(_file, BWAPI::Broodwar->mapHash());
+
+    std::vector<char> heights(width * height);
+    std::vector<bool> buildable(width * height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            heights[y * width + x] = char(BWAPI::Broodwar->getGroundHeight(x, y));
+            buildable[y * width + x] = BWAPI::Broodwar->isBuildable(x, y);
+        }
+    }
+    _file.write(heights.data(), heights.size());
+    _file.write("\0\0\0", (4 - heights.size() % 4) % 4);
+    WriteBits(_file, buildable);
+
+    std::vector<bool> walkable(16 * width * height);
+    for (int y = 0; y < 4 * height; ++y)
+    {
+        for (int x = 0; x < 4 * width; ++x)
+        {
+            walkable[y * 4 * width + x] = BWAPI::Broodwar->isWalkable(x, y);
+        }
+    }
+    WriteBits(_file, walkable);
+
+    for (const BWAPI::TilePosition & tile : BWAPI::Broodwar->getStartLocations())
+    {
+        WriteInt(_file, tile.x);
+        WriteInt(_file, tile.y);
+    }
+}
+
+FrameCapture & FrameCapture::Instance()
+{
+    static FrameCapture instance;
+    return instance;
+}
+
+void FrameCapture::initialize()
+{
+    if (!Config::IO::CaptureFrames)
+    {
+        return;
+    }
+
+    _file.open(Config::IO::WriteDir + "frames.bin", std::ios::binary | std::ios::trunc);
+    if (_file.good())
+    {
+        writeMap();
+        _capturing = _file.good();
+    }
+}
+
+void FrameCapture::update()
+{
+    if (!_capturing || the.now() % std::max(1, Config::IO::CaptureFrameInterval) != 0)
+    {
+        return;
+    }
+
+    std::vector<CapturedUnit> units;
+    for (BWAPI::Unit unit : BWAPI::Broodwar->getAllUnits())
+    {
+        if (!unit->exists() || !unit->isVisible())
+        {
+            continue;
+        }
+
+        CapturedUnit c;
+        std::memset(&c, 0, sizeof(c));
+        c.id = unit->getID();
+        c.targetID = unit->getOrderTarget() ? unit->getOrderTarget()->getID() : -1;
+        c.type = int16_t(unit->getType().getID());
+        c.order = int16_t(unit->getOrder().getID());
+        c.x = int16_t(unit->getPosition().x);
+        c.y = int16_t(unit->getPosition().y);
+        c.hitPoints = int16_t(unit->getHitPoints());
+        c.shields = int16_t(unit->getShields());
+        c.energy = int16_t(unit->getEnergy());
+        c.flags = UnitFlags(unit);
+        c.player = unit->getPlayer() == the.self() ? 0 : unit->getPlayer() == the.enemy() ? 1 : 2;
+
+        if (c.player != 2)
+        {
+            FastAPproximation::CaptureStats(unit, c.stats);
+        }
+
+        units.push_back(c);
+    }
+
+    FrameHeader header = { FrameMagic, the.now(), uint32_t(units.size()) };
+    _file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    _file.write(reinterpret_cast<const char *>(units.data()), units.size() * sizeof(CapturedUnit));
+}
+
+void FrameCapture::onEnd()
+{
+    if (_capturing)
+    {
+        _file.close();
+        _capturing = false;
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+FrameCaptureReader::FrameCaptureReader()
+{
+    std::memset(&_header, 0, sizeof(_header));
+}
+
+bool FrameCaptureReader::open(const std::string & filename)
+{
+    _frames.clear();
+    if (!_file.open(filename) || _file.size() < sizeof(FileHeader))
+    {
+        _file.close();
+        return false;
+    }
+
+    std::memcpy(&_header, _file.data(), sizeof(_header));
+    if (_header.magic != Magic || _header.version != Version ||
+        _header.mapWidth <= 0 || _header.mapWidth > 256 ||
+        _header.mapHeight <= 0 || _header.mapHeight > 256 ||
+        _header.nStartLocations < 0 || _header.nStartLocations > 8)
+    {
+        _file.close();
+        return false;
+    }
+
+    const size_t nTiles = size_t(_header.mapWidth) * _header.mapHeight;
+
+    CaptureReader in(_file.data() + sizeof(FileHeader), _file.size() - sizeof(FileHeader));
+    if (!in.getString(_mapName) ||
+        !in.getString(_mapHash) ||
+        in.remaining() < nTiles)
+    {
+        _file.close();
+        return false;
+    }
+    _groundHeight.assign(in.position(), in.position() + nTiles);
+    if (!in.skip(nTiles + (4 - nTiles % 4) % 4) ||
+        !in.getBits(_buildable, nTiles) ||
+        !in.getBits(_walkable, 16 * nTiles))
+    {
+        _file.close();
+        return false;
+    }
+
+    _startLocations.clear();
+    for (int i = 0; i < _header.nStartLocations; ++i)
+    {
+        int32_t x, y;
+        if (!in.getInt(x) || !in.getInt(y))
+        {
+            _file.close();
+            return false;
+        }
+        _startLocations.push_back(std::make_pair(x, y));
+    }
+
+    // Index the frames.
+    while (in.remaining() >= sizeof(FrameHeader))
+    {
+        FrameHeader fh;
+        std::memcpy(&fh, in.position(), sizeof(fh));
+        if (fh.magic != FrameMagic ||
+            fh.nUnits > (in.remaining() - sizeof(FrameHeader)) / sizeof(CapturedUnit))
+        {
+            break;
+        }
+        in.skip(sizeof(FrameHeader));
+
+        CapturedFrame frame;
+        frame.frame = fh.frame;
+        frame.units = reinterpret_cast<const CapturedUnit *>(in.position());
+        frame.nUnits = int(fh.nUnits);
+        _frames.push_back(frame);
+
+        in.skip(fh.nUnits * sizeof(CapturedUnit));
+    }
+
+    return true;
+}
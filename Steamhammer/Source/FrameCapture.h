@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+// Frame capture: record what the bot sees, so that its computations can be replayed
+// and timed without StarCraft. See FrameReplay for the replayer.
+// Capture is off unless Config::IO::CaptureFrames is set. It writes one frame
+// every Config::IO::CaptureFrameInterval frames to Config::IO::WriteDir + "frames.bin".
+
+// File layout. All fields are little-endian and 4-byte aligned.
+//   FileHeader
+//   map data: map name and hash (each a length and padded bytes),
+//             ground height per build tile (1 byte each), buildable per build tile (1 bit each),
+//             walkable per walk tile (1 bit each), start locations (x, y in build tiles)
+//   frames, each a FrameHeader followed by FrameHeader::nUnits CapturedUnits
+// The file is written as the game goes, so a crash leaves all frames before the last one readable.
+
+namespace UAlbertaBot
+{
+namespace FrameCaptureFormat
+{
+    const uint32_t Magic = 0x43464853;          // "SHFC"
+    const uint32_t Version = 1;
+    const uint32_t FrameMagic = 0x52464853;     // "SHFR"
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        int32_t mapWidth;                       // build tiles
+        int32_t mapHeight;
+        int32_t nStartLocations;
+        int32_t ourRace;                        // BWAPI race IDs
+        int32_t enemyRace;
+    };
+
+    struct FrameHeader
+    {
+        uint32_t magic;
+        int32_t frame;
+        uint32_t nUnits;
+    };
+
+    namespace Flag
+    {
+        const uint16_t Completed        = 1 << 0;
+        const uint16_t Flying           = 1 << 1;
+        const uint16_t Burrowed         = 1 << 2;
+        const uint16_t Cloaked          = 1 << 3;
+        const uint16_t Lifted           = 1 << 4;
+        const uint16_t Powered          = 1 << 5;
+        const uint16_t Stimmed          = 1 << 6;
+        const uint16_t Ensnared         = 1 << 7;
+        const uint16_t UnderDarkSwarm   = 1 << 8;
+        const uint16_t Detected         = 1 << 9;
+    }
+
+    // The combat stats of a unit as the combat simulator sees them, with upgrades,
+    // stim and ensnare already applied, in the simulator's own units.
+    // Capturing them means the replay needs no BWAPI::Player.
+    struct CombatStats
+    {
+        float speed;
+        int32_t armor;
+        int32_t shieldArmor;
+        int32_t groundDamage;
+        int32_t groundCooldown;
+        int32_t groundMaxRange;                 // squared, as in FAP
+        int32_t groundMinRange;
+        int32_t airDamage;
+        int32_t airCooldown;
+        int32_t airMaxRange;
+        int32_t elevation;
+    };
+
+    struct CapturedUnit
+    {
+        int32_t id;
+        int32_t targetID;                       // -1 if none
+        int16_t type;                           // BWAPI IDs
+        int16_t order;
+        int16_t x;                              // pixels
+        int16_t y;
+        int16_t hitPoints;
+        int16_t shields;
+        int16_t energy;
+        uint16_t flags;
+        uint8_t player;                         // 0 = us, 1 = enemy, 2 = neutral
+        uint8_t pad[3];
+        CombatStats stats;
+    };
+}
+
+// A view of one captured frame, pointing into a mapped file.
+struct CapturedFrame
+{
+    int frame;
+    const FrameCaptureFormat::CapturedUnit * units;
+    int nUnits;
+};
+
+// Write a capture file during a game.
+class FrameCapture
+{
+private:
+    std::ofstream _file;
+    bool _capturing;
+
+    FrameCapture();
+
+    void writeMap();
+
+public:
+    static FrameCapture & Instance();
+
+    // Call after the config file is parsed.
+    void initialize();
+
+    // Call once per frame, before the managers update.
+    void update();
+
+    void onEnd();
+};
+
+// Read a capture file. This does not touch BWAPI::Broodwar, so it works outside the game.
+class FrameCaptureReader
+{
+private:
+    MappedFile _file;
+    FrameCaptureFormat::FileHeader _header;
+
+    std::string _mapName;
+    std::string _mapHash;
+    std::vector<uint8_t> _groundHeight;
+    std::vector<bool> _buildable;
+    std::vector<bool> _walkable;
+    std::vector<std::pair<int, int>> _startLocations;
+
+    std::vector<CapturedFrame> _frames;
+
+public:
+    FrameCaptureReader();
+
+    // Return false if the file does not exist or is not a capture file.
+    // A damaged or incomplete frame ends the index; the frames before it are kept.
+    bool open(const std::string & filename);
+
+    const FrameCaptureFormat::FileHeader & header() const { return _header; };
+    const std::string & mapName() const { return _mapName; };
+    const std::string & mapHash() const { return _mapHash; };
+
+    // Build tile and walk tile map data.
+    int groundHeight(int x, int y) const { return _groundHeight[y * _header.mapWidth + x]; };
+    bool buildable(int x, int y) const { return _buildable[y * _header.mapWidth + x]; };
+    bool walkable(int x, int y) const { return _walkable[y * 4 * _header.mapWidth + x]; };
+    const std::vector<std::pair<int, int>> & startLocations() const { return _startLocations; };
+
+    const std::vector<CapturedFrame> & frames() const { return _frames; };
+};
+
+}
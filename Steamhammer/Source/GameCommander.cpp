@@ -7,6 +7,7 @@
 #include "UnitUtil.h"
 
 #include "BuildingManager.h"
+#include "FrameCapture.h"
 #include "InformationManager.h"
 #include "MapGrid.h"
 #include "OpeningTiming.h"
@@ -30,6 +31,9 @@ void GameCommander::update()
 {
     _timerManager.startTimer(TimerManager::Total);
 
+    // Record the frame as it is before we act on it, if capturing.
+    FrameCapture::Instance().update();
+
     // populate the unit vectors we will pass into various managers
     handleUnitAssignments();
 
@@ -52,6 +56,7 @@ void GameCommander::update()
     // -- Managers that gather inforation. --
 
     _timerManager.startTimer(TimerManager::InformationManager);
+    the.creep.update();
     Bases::Instance().update();
     InformationManager::Instance().update();
     _timerManager.stopTimer(TimerManager::InformationManager);
@@ -112,6 +117,13 @@ void GameCommander::onEnd(bool isWinner)
     // Clean up any data structures that may otherwise not be unwound in the correct order.
     // This fixes an end-of-game bug diagnosed by Bruce Nielsen.
     _combatCommander.onEnd();
+
+    // Write the trace and the per-zone timing summary, if profiling.
+    Profiler::Instance().onEnd();
+    FrameCapture::Instance().onEnd();
+
+    // Write out any log messages still queued.
+    Logger::Flush();
 }
 
 void GameCommander::drawDebugInterface()
@@ -504,6 +516,7 @@ void GameCommander::onUnitShow(BWAPI::Unit unit)
 { 
     InformationManager::Instance().onUnitShow(unit); 
     WorkerManager::Instance().onUnitShow(unit);
+    the.skillkit.postUnitEvent(SkillEventType::UnitDiscovered, unit);
 }
 
 void GameCommander::onUnitHide(BWAPI::Unit unit)			
@@ -514,6 +527,7 @@ void GameCommander::onUnitHide(BWAPI::Unit unit)
 void GameCommander::onUnitCreate(BWAPI::Unit unit)		
 { 
     InformationManager::Instance().onUnitCreate(unit); 
+    the.skillkit.postUnitEvent(SkillEventType::UnitCreated, unit);
 }
 
 void GameCommander::onUnitComplete(BWAPI::Unit unit)
@@ -531,12 +545,14 @@ void GameCommander::onUnitDestroy(BWAPI::Unit unit)
     ProductionManager::Instance().onUnitDestroy(unit);
     WorkerManager::Instance().onUnitDestroy(unit);
     InformationManager::Instance().onUnitDestroy(unit); 
+    the.skillkit.postUnitEvent(SkillEventType::UnitDestroyed, unit);
 }
 
 void GameCommander::onUnitMorph(BWAPI::Unit unit)		
 { 
     InformationManager::Instance().onUnitMorph(unit);
     WorkerManager::Instance().onUnitMorph(unit);
+    the.skillkit.postUnitEvent(SkillEventType::UnitMorphed, unit);
 }
 
 // Used only to choose a worker to scout.
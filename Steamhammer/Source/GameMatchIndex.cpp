@@ -0,0 +1,237 @@
+#include "GameMatchIndex.h"
+
+#include <algorithm>
+
+#include "GameRecord.h"
+#include "PlayerSnapshot.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define GAME_MATCH_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace UAlbertaBot;
+
+// Sum of absolute differences of two rows.
+int GameMatchIndex::RowDistance(const Block * a, const Block * b, int nBlocks)
+{
+#ifdef GAME_MATCH_SSE2
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < nBlocks; ++i)
+    {
+        const __m128i x = _mm_load_si128(reinterpret_cast<const __m128i *>(&a[i]));
+        const __m128i y = _mm_load_si128(reinterpret_cast<const __m128i *>(&b[i]));
+
+        // Counts are >= 0 and at most 32767, so max - min cannot overflow.
+        const __m128i diff = _mm_sub_epi16(_mm_max_epi16(x, y), _mm_min_epi16(x, y));
+
+        // Widen to 32 bits by multiplying pairs by 1 and adding them.
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(diff, ones));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#else
+    int sum = 0;
+    for (int i = 0; i < nBlocks; ++i)
+    {
+        for (int j = 0; j < 8; ++j)
+        {
+            sum += abs(a[i].count[j] - b[i].count[j]);
+        }
+    }
+    return sum;
+#endif
+}
+
+// Find the candidate records and fill in the rows for all their snapshots.
+void GameMatchIndex::build(const GameRecord & now, const std::vector<GameRecord *> & records)
+{
+    _built = true;
+    _ourRace = now.ourRace;
+    _enemyRace = now.enemyRace;
+    _openingName = now.openingName;
+    _nRecords = records.size();
+
+    _candidates.clear();
+    _rows.clear();
+    _frames.clear();
+    _nCompared = 0;
+
+    // Only records of the same matchup can be compared, and only if they have snapshots.
+    std::vector<GameRecord *> sameMatchup;
+    for (GameRecord * record : records)
+    {
+        if (record->ourRace == _ourRace && record->enemyRace == _enemyRace)
+        {
+            record->loadDetails();
+            if (!record->snapshots.empty())
+            {
+                sameMatchup.push_back(record);
+            }
+        }
+    }
+
+    // Give a column to each unit type that appears in any of them.
+    _ourColumn.assign(BWAPI::UnitTypes::Enum::MAX, -1);
+    _enemyColumn.assign(BWAPI::UnitTypes::Enum::MAX, -1);
+    int nColumns = 0;
+    for (const GameRecord * record : sameMatchup)
+    {
+        for (const GameSnapshot * snap : record->snapshots)
+        {
+            for (const auto & unitCount : snap->us.getCounts())
+            {
+                int & column = _ourColumn[unitCount.first.getID()];
+                if (column < 0)
+                {
+                    column = nColumns++;
+                }
+            }
+            for (const auto & unitCount : snap->them.getCounts())
+            {
+                int & column = _enemyColumn[unitCount.first.getID()];
+                if (column < 0)
+                {
+                    column = nColumns++;
+                }
+            }
+        }
+    }
+    _nBlocks = std::max(1, (nColumns + 7) / 8);
+    _now.assign(_nBlocks, Block());
+
+    for (GameRecord * record : sameMatchup)
+    {
+        Candidate c;
+        c.record = record;
+        c.firstRow = int(_frames.size());
+        c.nRows = int(record->snapshots.size());
+        c.distance =
+            (record->mapName != now.mapName ? 20 : 0) +
+            (record->openingName != now.openingName ? 200 : 0);
+        c.alive = true;
+        _candidates.push_back(c);
+
+        _rows.resize(_rows.size() + c.nRows * _nBlocks);
+        for (int i = 0; i < c.nRows; ++i)
+        {
+            const GameSnapshot * snap = record->snapshots[i];
+            (void) fillRow(&_rows[(c.firstRow + i) * _nBlocks], snap->us, snap->them);
+            _frames.push_back(snap->frame);
+        }
+    }
+}
+
+// Fill in a row from a pair of snapshots.
+// Return the distance due to unit types that have no column, which no past game has.
+int GameMatchIndex::fillRow(Block * row, const PlayerSnapshot & us, const PlayerSnapshot & them) const
+{
+    std::fill(row, row + _nBlocks, Block());
+    int16_t * counts = &row[0].count[0];
+
+    int extra = 0;
+    for (const auto & unitCount : us.getCounts())
+    {
+        const int column = _ourColumn[unitCount.first.getID()];
+        if (column >= 0)
+        {
+            counts[column] = int16_t(std::min(unitCount.second, MaxCount));
+        }
+        else
+        {
+            extra += unitCount.second;
+        }
+    }
+    for (const auto & unitCount : them.getCounts())
+    {
+        const int column = _enemyColumn[unitCount.first.getID()];
+        if (column >= 0)
+        {
+            counts[column] = int16_t(EnemyWeight * std::min(unitCount.second, MaxCount));
+        }
+        else
+        {
+            extra += EnemyWeight * unitCount.second;
+        }
+    }
+    return extra;
+}
+
+// Sum in the current game snapshots that are new since the last call.
+// Snapshots are paired by index, as in GameRecord::distance().
+void GameMatchIndex::compareNewSnapshots(const GameRecord & now)
+{
+    for (; _nCompared < int(now.snapshots.size()); ++_nCompared)
+    {
+        const GameSnapshot * snap = now.snapshots[_nCompared];
+        const int extra = fillRow(&_now[0], snap->us, snap->them);
+
+        for (Candidate & c : _candidates)
+        {
+            if (c.alive && _nCompared < c.nRows)
+            {
+                c.distance += extra + RowDistance(&_now[0], &_rows[(c.firstRow + _nCompared) * _nBlocks], _nBlocks);
+            }
+        }
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+GameMatchIndex::GameMatchIndex()
+    : _built(false)
+    , _nRecords(0)
+    , _nBlocks(1)
+    , _nCompared(0)
+{
+}
+
+GameRecord * GameMatchIndex::findBestMatch(const GameRecord & now, const std::vector<GameRecord *> & records)
+{
+    // The enemy race becomes known partway through a game against a random enemy.
+    if (!_built ||
+        now.ourRace != _ourRace ||
+        now.enemyRace != _enemyRace ||
+        now.openingName != _openingName ||
+        records.size() != _nRecords)
+    {
+        build(now, records);
+    }
+
+    compareNewSnapshots(now);
+
+    const int frame = BWAPI::Broodwar->getFrameCount();
+    const int nPaired = int(now.snapshots.size());
+
+    GameRecord * best = nullptr;
+    int bestDistance = -1;
+    for (Candidate & c : _candidates)
+    {
+        if (!c.alive)
+        {
+            continue;
+        }
+
+        // A record that ended too early has no information for us, now or later.
+        const int paired = std::min(nPaired, c.nRows);
+        const int latest = paired > 0 ? _frames[c.firstRow + paired - 1] : 0;
+        if (frame - latest > now.snapshotInterval)
+        {
+            if (paired == c.nRows)
+            {
+                c.alive = false;
+            }
+            continue;
+        }
+
+        if (!best || c.distance < bestDistance)
+        {
+            best = c.record;
+            bestDistance = c.distance;
+        }
+    }
+
+    return best;
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <BWAPI.h>
+
+namespace UAlbertaBot
+{
+class GameRecord;
+class PlayerSnapshot;
+
+// Find the past game record most like the current game. The answer is the same as
+// taking the least GameRecord::distance() over all records, but much cheaper.
+// Each snapshot of each past game in the matchup becomes a fixed-length row of unit counts,
+// so that comparing two snapshots is one pass over two short arrays.
+// Snapshots of the current game never change once taken, so each one is compared
+// with the past games only once, and the sums are kept.
+class GameMatchIndex
+{
+private:
+    // Rows are made of blocks of 8 counts, one SSE2 register each.
+    struct alignas(16) Block
+    {
+        int16_t count[8];
+    };
+
+    // The enemy's units count 5 times as much as ours. Counts are stored pre-multiplied.
+    static const int EnemyWeight = 5;
+    static const int MaxCount = 32767 / EnemyWeight;
+
+    struct Candidate
+    {
+        GameRecord * record;
+        int firstRow;               // into _rows and _frames
+        int nRows;
+        int distance;               // summed so far, including the fixed part
+        bool alive;                 // false once the record is known to have ended too early
+    };
+
+    // What the index was built for. If any changes, rebuild.
+    bool _built;
+    BWAPI::Race _ourRace;
+    BWAPI::Race _enemyRace;
+    std::string _openingName;
+    size_t _nRecords;
+
+    // Unit type ID -> column, or -1 if no past game has the type.
+    std::vector<int> _ourColumn;
+    std::vector<int> _enemyColumn;
+    int _nBlocks;                   // per row
+
+    std::vector<Block> _rows;       // all snapshots of all candidates, _nBlocks each
+    std::vector<int> _frames;       // the frame of each row's snapshot
+    std::vector<Candidate> _candidates;
+
+    int _nCompared;                 // current game snapshots already summed in
+    std::vector<Block> _now;        // scratch row for the current game
+
+    static int RowDistance(const Block * a, const Block * b, int nBlocks);
+
+    void build(const GameRecord & now, const std::vector<GameRecord *> & records);
+    int fillRow(Block * row, const PlayerSnapshot & us, const PlayerSnapshot & them) const;
+    void compareNewSnapshots(const GameRecord & now);
+
+public:
+    GameMatchIndex();
+
+    // Return the best match, or null if no record can be compared.
+    GameRecord * findBestMatch(const GameRecord & now, const std::vector<GameRecord *> & records);
+};
+
+}
@@ -2,6 +2,7 @@
 
 #include "Bases.h"
 #include "Logger.h"
+#include "OpponentFile.h"
 #include "OpponentModel.h"
 #include "The.h"
 
@@ -58,6 +59,17 @@ int GameRecord::readNumber(std::string & s)
     throw game_record_read_error();
 }
 
+// Would readNumber(s) succeed? The same test without the cost of a string stream.
+bool GameRecord::startsWithNumber(const std::string & s) const
+{
+    size_t i = s.find_first_not_of(" \t\r\n\v\f");
+    if (i != std::string::npos && (s[i] == '-' || s[i] == '+'))
+    {
+        ++i;
+    }
+    return i < s.size() && s[i] >= '0' && s[i] <= '9';
+}
+
 void GameRecord::parseMatchup(const std::string & s)
 {
     if (s.length() == 3)        // "ZvT"
@@ -242,8 +254,8 @@ void GameRecord::read_v3_0(std::istream & input)
         {
             break;
         }
+        // The skills get to parse the line later, in readDetails().
         skillKitText.push_back(skillLine);
-        the.skillkit.read(*this, skillLine);
     }
 }
 
@@ -298,10 +310,26 @@ void GameRecord::read_v1_4(std::istream & input)
     frameEnemyGetsMobileDetection = readNumber(input);
     frameGameEnds = readNumber(input);
 
-    GameSnapshot * snap;
-    while (snap = readGameSnapshot(input))
+    // Keep the snapshot text to parse later, in readDetails().
+    // Check it now, so that a damaged record is rejected as a whole, the same as when the
+    // snapshots were parsed right away: every line of a snapshot starts with a number.
+    std::string line;
+    while (true)
     {
-        snapshots.push_back(snap);
+        if (!std::getline(input, line))
+        {
+            throw game_record_read_error();
+        }
+        if (line == gameEndMark)
+        {
+            break;
+        }
+        if (!startsWithNumber(line))
+        {
+            throw game_record_read_error();
+        }
+        snapshotText += line;
+        snapshotText += '\n';
     }
 }
 
@@ -338,6 +366,118 @@ void GameRecord::read(std::istream & input)
     }
 }
 
+// Read the game record from a binary record. The format is the same as the corresponding text format.
+void GameRecord::read(const GameRecordView & view)
+{
+    const OpponentFileFormat::RecordFixed & f = view.fixed();
+
+    recordFormat = std::string(view.format());
+    if (recordFormat != "3.0" && recordFormat != "1.4")
+    {
+        valid = false;
+        return;
+    }
+
+    ourRace = BWAPI::Race(f.ourRace);
+    enemyRace = BWAPI::Race(f.enemyRace);
+    enemyIsRandom = f.enemyIsRandom != 0;
+    if (ourRace == BWAPI::Races::Unknown)
+    {
+        valid = false;
+        return;
+    }
+
+    mapName = std::string(view.string(f.mapName));
+    myStartingBaseID = f.myStartingBaseID;
+    enemyStartingBaseID = f.enemyStartingBaseID;
+    openingName = std::string(view.string(f.openingName));
+    expectedEnemyPlan = OpeningPlanFromString(std::string(view.string(f.expectedEnemyPlan)));
+    enemyPlan = OpeningPlanFromString(std::string(view.string(f.enemyPlan)));
+    win = f.win != 0;
+
+    frameScoutSentForGasSteal = f.frameScoutSentForGasSteal;
+    gasStealHappened = f.gasStealHappened != 0;
+
+    frameWeMadeFirstCombatUnit = f.frameWeMadeFirstCombatUnit;
+    frameWeGatheredGas = f.frameWeGatheredGas;
+
+    frameEnemyScoutsOurBase = f.frameEnemyScoutsOurBase;
+    frameEnemyGetsCombatUnits = f.frameEnemyGetsCombatUnits;
+    frameEnemyUsesGas = f.frameEnemyUsesGas;
+    frameEnemyGetsAirUnits = f.frameEnemyGetsAirUnits;
+    frameEnemyGetsStaticAntiAir = f.frameEnemyGetsStaticAntiAir;
+    frameEnemyGetsMobileAntiAir = f.frameEnemyGetsMobileAntiAir;
+    frameEnemyGetsCloakedUnits = f.frameEnemyGetsCloakedUnits;
+    frameEnemyGetsStaticDetection = f.frameEnemyGetsStaticDetection;
+    frameEnemyGetsMobileDetection = f.frameEnemyGetsMobileDetection;
+    frameGameEnds = f.frameGameEnds;
+
+    // The snapshots and skill lines stay in the file until readDetails().
+    binaryBody = view.body();
+}
+
+// Parse the snapshots and skill data of a past record, the first time anything wants them.
+// Most records are only ever looked at through their header fields, so most are never parsed.
+void GameRecord::loadDetails() const
+{
+    if (!detailsLoaded)
+    {
+        detailsLoaded = true;
+
+        // Loading is a cache fill. The record itself is never a const object.
+        const_cast<GameRecord *>(this)->readDetails();
+    }
+}
+
+void GameRecord::readDetails()
+{
+    if (!binaryBody.empty())
+    {
+        GameRecordView view(binaryBody.data(), uint32_t(binaryBody.size()));
+
+        uint32_t offset = view.firstSnapshot();
+        for (int i = 0; i < view.snapshotCount(); ++i)
+        {
+            int t;
+            PlayerSnapshot me;
+            PlayerSnapshot you;
+            view.readSnapshot(offset, t, me, you);
+            snapshots.push_back(new GameSnapshot(t, me, you));
+        }
+
+        for (int i = 0; i < view.skillLineCount(); ++i)
+        {
+            skillKitText.push_back(std::string(view.skillLine(i)));
+        }
+
+        binaryBody = std::string_view();
+    }
+    else if (!snapshotText.empty())
+    {
+        std::istringstream input(snapshotText + gameEndMark + '\n');
+        try
+        {
+            GameSnapshot * snap;
+            while ((snap = readGameSnapshot(input)) != nullptr)
+            {
+                snapshots.push_back(snap);
+            }
+        }
+        catch (const game_record_read_error &)
+        {
+            // read_v1_4() checked the text, so this should not happen. Keep what was read.
+        }
+
+        snapshotText.clear();
+        snapshotText.shrink_to_fit();
+    }
+
+    for (const std::string & skillLine : skillKitText)
+    {
+        the.skillkit.read(*this, skillLine);
+    }
+}
+
 void GameRecord::writePlayerSnapshot(std::ostream & output, const PlayerSnapshot & snap)
 {
     output << snap.numBases;
@@ -359,12 +499,48 @@ void GameRecord::writeGameSnapshot(std::ostream & output, const GameSnapshot * s
 // GameRecordNow overrides this to write data for the current game.
 void GameRecord::writeSkills(std::ostream & output) const
 {
+    loadDetails();
     for (const std::string & line : skillKitText)
     {
         output << line << '\n';
     }
 }
 
+// Write a 1.4 game record. Only for records that were read in that format.
+void GameRecord::write_v1_4(std::ostream & output)
+{
+    loadDetails();
+
+    output << "1.4" << '\n';
+    output <<
+        RaceChar(ourRace) <<
+        'v' <<
+        (enemyIsRandom ? "R" : "") << RaceChar(enemyRace) << '\n';
+    output << mapName << '\n';
+    output << openingName << '\n';
+    output << OpeningPlanString(expectedEnemyPlan) << '\n';
+    output << OpeningPlanString(enemyPlan) << '\n';
+    output << (win ? '1' : '0') << '\n';
+    output << frameScoutSentForGasSteal << '\n';
+    output << (gasStealHappened ? '1' : '0') << '\n';
+    output << frameEnemyScoutsOurBase << '\n';
+    output << frameEnemyGetsCombatUnits << '\n';
+    output << frameEnemyGetsAirUnits << '\n';
+    output << frameEnemyGetsStaticAntiAir << '\n';
+    output << frameEnemyGetsMobileAntiAir << '\n';
+    output << frameEnemyGetsCloakedUnits << '\n';
+    output << frameEnemyGetsStaticDetection << '\n';
+    output << frameEnemyGetsMobileDetection << '\n';
+    output << frameGameEnds << '\n';
+
+    for (const auto & snap : snapshots)
+    {
+        writeGameSnapshot(output, snap);
+    }
+
+    output << gameEndMark << '\n';
+}
+
 // Calculate a similarity distance between 2 snapshots.
 // This version is a simple first try. Some unit types should matter more than others.
 // 12 vs. 10 zerglings should count less than 2 vs. 0 lurkers.
@@ -372,32 +548,8 @@ void GameRecord::writeSkills(std::ostream & output) const
 // Part of distance().
 int GameRecord::snapDistance(const PlayerSnapshot & a, const PlayerSnapshot & b) const
 {
-    int distance = 0;
-
-    // From a to b, count all differences.
-    for (std::pair<BWAPI::UnitType, int> unitCountA : a.unitCounts)
-    {
-        auto unitCountBIt = b.unitCounts.find(unitCountA.first);
-        if (unitCountBIt == b.unitCounts.end())
-        {
-            distance += unitCountA.second;
-        }
-        else
-        {
-            distance += abs(unitCountA.second - (*unitCountBIt).second);
-        }
-    }
-
-    // From b to a, count differences where a is missing the type.
-    for (std::pair<BWAPI::UnitType, int> unitCountB : b.unitCounts)
-    {
-        if (a.unitCounts.find(unitCountB.first) == a.unitCounts.end())
-        {
-            distance += unitCountB.second;
-        }
-    }
-
-    return distance;
+    // Count all differences. A missing type counts as 0.
+    return UnitCounts::Distance(a.unitCounts, b.unitCounts);
 }
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
@@ -430,6 +582,7 @@ GameRecord::GameRecord()
     , frameEnemyGetsStaticDetection(0)
     , frameEnemyGetsMobileDetection(0)
     , frameGameEnds(0)
+    , detailsLoaded(true)          // there is nothing to load
 {
 }
 
@@ -459,10 +612,42 @@ GameRecord::GameRecord(std::istream & input)
     , frameEnemyGetsStaticDetection(0)
     , frameEnemyGetsMobileDetection(0)
     , frameGameEnds(0)
+    , detailsLoaded(false)
 {
     read(input);
 }
 
+// Constructor for the record of a past game, from a binary opponent model file.
+GameRecord::GameRecord(const GameRecordView & view)
+    : valid(true)                  // until proven otherwise
+    , savedRecord(true)
+    , ourRace(BWAPI::Races::Unknown)
+    , enemyRace(BWAPI::Races::Unknown)
+    , enemyIsRandom(false)
+    , myStartingBaseID(0)
+    , enemyStartingBaseID(0)
+    , expectedEnemyPlan(OpeningPlan::Unknown)
+    , enemyPlan(OpeningPlan::Unknown)
+    , win(false)                   // until proven otherwise
+    , frameScoutSentForGasSteal(0)
+    , gasStealHappened(false)
+    , frameWeMadeFirstCombatUnit(0)
+    , frameWeGatheredGas(0)
+    , frameEnemyScoutsOurBase(0)
+    , frameEnemyGetsCombatUnits(0)
+    , frameEnemyUsesGas(0)
+    , frameEnemyGetsAirUnits(0)
+    , frameEnemyGetsStaticAntiAir(0)
+    , frameEnemyGetsMobileAntiAir(0)
+    , frameEnemyGetsCloakedUnits(0)
+    , frameEnemyGetsStaticDetection(0)
+    , frameEnemyGetsMobileDetection(0)
+    , frameGameEnds(0)
+    , detailsLoaded(false)
+{
+    read(view);
+}
+
 // Write the game record to the given stream. File format:
 void GameRecord::write(std::ostream & output)
 {
@@ -511,6 +696,102 @@ void GameRecord::write(std::ostream & output)
     output << gameEndMark << '\n';
 }
 
+// Write the game record in the text format it was read in, so that nothing is lost.
+// Used to convert a binary opponent model file to text.
+void GameRecord::writeAsRecorded(std::ostream & output)
+{
+    if (savedRecord && recordFormat == "1.4")
+    {
+        write_v1_4(output);
+    }
+    else
+    {
+        write(output);
+    }
+}
+
+// Write the game record as one record of a binary opponent model file.
+// Unlike write(), keep the format the record was read in, so the binary file converts
+// back to the same text.
+void GameRecord::writeBinary(std::ostream & output)
+{
+    if (!savedRecord)
+    {
+        expectedEnemyPlan = OpponentModel::Instance().getInitialExpectedEnemyPlan();
+    }
+    const std::string format = savedRecord ? recordFormat : latestRecordFormat;
+    loadDetails();
+
+    RecordBuilder builder;
+    OpponentFileFormat::RecordFixed & f = builder.fixed();
+
+    format.copy(f.format, 3);
+    f.ourRace = ourRace.getID();
+    f.enemyRace = enemyRace.getID();
+    f.enemyIsRandom = enemyIsRandom;
+    f.myStartingBaseID = myStartingBaseID;
+    f.enemyStartingBaseID = enemyStartingBaseID;
+    f.win = win;
+
+    f.frameScoutSentForGasSteal = frameScoutSentForGasSteal;
+    f.gasStealHappened = gasStealHappened;
+
+    f.frameWeMadeFirstCombatUnit = frameWeMadeFirstCombatUnit;
+    f.frameWeGatheredGas = frameWeGatheredGas;
+
+    f.frameEnemyScoutsOurBase = frameEnemyScoutsOurBase;
+    f.frameEnemyGetsCombatUnits = frameEnemyGetsCombatUnits;
+    f.frameEnemyUsesGas = frameEnemyUsesGas;
+    f.frameEnemyGetsAirUnits = frameEnemyGetsAirUnits;
+    f.frameEnemyGetsStaticAntiAir = frameEnemyGetsStaticAntiAir;
+    f.frameEnemyGetsMobileAntiAir = frameEnemyGetsMobileAntiAir;
+    f.frameEnemyGetsCloakedUnits = frameEnemyGetsCloakedUnits;
+    f.frameEnemyGetsStaticDetection = frameEnemyGetsStaticDetection;
+    f.frameEnemyGetsMobileDetection = frameEnemyGetsMobileDetection;
+    f.frameGameEnds = frameGameEnds;
+
+    f.mapName = builder.addString(mapName);
+    f.openingName = builder.addString(openingName);
+    f.expectedEnemyPlan = builder.addString(OpeningPlanString(expectedEnemyPlan));
+    f.enemyPlan = builder.addString(OpeningPlanString(enemyPlan));
+
+    // As in the text formats, 1.4 records keep their snapshots and 3.0 records keep skill data.
+    f.snapshotsOffset = builder.offset();
+    if (format == "1.4")
+    {
+        f.nSnapshots = uint32_t(snapshots.size());
+        for (const GameSnapshot * snap : snapshots)
+        {
+            builder.addInt(snap->frame);
+            builder.addPlayerSnapshot(snap->us);
+            builder.addPlayerSnapshot(snap->them);
+        }
+    }
+    else
+    {
+        std::ostringstream skills;
+        writeSkills(skills);
+
+        std::vector<OpponentFileFormat::StringRef> lines;
+        std::istringstream skillStream(skills.str());
+        std::string line;
+        while (std::getline(skillStream, line))
+        {
+            lines.push_back(builder.addString(line));
+        }
+
+        f.nSkillLines = uint32_t(lines.size());
+        f.skillLinesOffset = builder.offset();
+        for (const OpponentFileFormat::StringRef & ref : lines)
+        {
+            builder.addInt(int32_t(ref.offset));
+            builder.addInt(int32_t(ref.length));
+        }
+    }
+
+    OpponentFile::WriteRecord(output, builder.finish());
+}
+
 // Calculate a similarity distance between two game records; -1 if they cannot be compared.
 // The more similar they are, the less the distance.
 int GameRecord::distance(const GameRecord & record) const
@@ -522,6 +803,7 @@ int GameRecord::distance(const GameRecord & record) const
     }
 
     // Also return -1 for any record which has no snapshots. It conveys no info.
+    record.loadDetails();
     if (record.snapshots.size() == 0)
     {
         return -1;
@@ -567,6 +849,8 @@ int GameRecord::distance(const GameRecord & record) const
 // The caller promises that there is one, but we check anyway.
 bool GameRecord::findClosestSnapshot(int t, PlayerSnapshot & snap) const
 {
+    loadDetails();
+
     for (const auto & ourSnap : snapshots)
     {
         if (abs(ourSnap->frame - t) < snapshotInterval)
@@ -591,8 +875,16 @@ bool GameRecord::sameMatchup(const GameRecord & record) const
         );
 }
 
+const OpeningTimingRecord & GameRecord::getOpeningTimingRecord() const
+{
+    loadDetails();
+    return openingTimingRecord;
+}
+
 const std::vector<int> * GameRecord::getSkillInfo(Skill * skill, int i) const
 {
+    loadDetails();
+
     auto it1 = skillData.find(skill);
     if (it1 != skillData.end())
     {
@@ -613,6 +905,8 @@ void GameRecord::setSkillInfo(Skill * skill, int i, const std::vector<int> & inf
 
 void GameRecord::debugLog()
 {
+    loadDetails();
+
     BWAPI::Broodwar->printf("best %s %s", mapName, openingName);
 
     std::stringstream msg;
@@ -637,5 +931,5 @@ void GameRecord::debugLog()
     }
     msg  << '\n';
 
-    Logger::LogAppendToFile(Config::IO::ErrorLogFilename, msg.str());
+    Logger::LogAppendToFileNow(Config::IO::ErrorLogFilename, msg.str());
 }
@@ -7,6 +7,7 @@
 #include "Skill.h"
 
 #include <exception>
+#include <string_view>
 
 // NOTE
 // This class does only a little checking of its input file format. Feed it no bad files.
@@ -15,6 +16,8 @@ class game_record_read_error : public std::exception {};
 
 namespace UAlbertaBot
 {
+class GameRecordView;
+
 struct GameSnapshot
 {
     const int frame;
@@ -40,6 +43,8 @@ struct GameSnapshot
 
 class GameRecord
 {
+    friend class GameMatchIndex;
+
 protected:
     const int firstSnapshotTime = 2 * 60 * 24;
     const int snapshotInterval = 30 * 24;
@@ -98,10 +103,22 @@ protected:
     // We allocate the snapshots and never release them.
     std::vector<GameSnapshot *> snapshots;
 
+    // A past record is read in two phases. The header fields above are read right away.
+    // The snapshots and skill data are kept unparsed until something asks for them:
+    // snapshotText holds the text of 1.4 snapshots, and binaryBody points into the
+    // mapped binary file, which OpponentModel keeps open.
+    mutable bool detailsLoaded;
+    std::string snapshotText;
+    std::string_view binaryBody;
+
+    void loadDetails() const;
+    void readDetails();
+
     BWAPI::Race charRace(char ch);
 
     int readNumber(std::istream & input);
     int readNumber(std::string & s);
+    bool startsWithNumber(const std::string & s) const;
 
     void parseMatchup(const std::string & s);
 
@@ -114,21 +131,27 @@ protected:
     void read_v3_0(std::istream & input);
     void read_v1_4(std::istream & input);
     void read(std::istream & input);
+    void read(const GameRecordView & view);
 
     void writePlayerSnapshot(std::ostream & output, const PlayerSnapshot & snap);
     void writeGameSnapshot(std::ostream & output, const GameSnapshot * snap);
     virtual void writeSkills(std::ostream & output) const;
+    void write_v1_4(std::ostream & output);
 
     int snapDistance(const PlayerSnapshot & a, const PlayerSnapshot & b) const;
 
 public:
     // Store opening timing skill data specially.
+    // Filled in when the skill data is loaded; read it with getOpeningTimingRecord().
     OpeningTimingRecord openingTimingRecord;
 
     GameRecord();
     GameRecord(std::istream & input);
+    GameRecord(const GameRecordView & view);
 
     void write(std::ostream & output);
+    void writeAsRecorded(std::ostream & output);
+    void writeBinary(std::ostream & output);
 
     bool isValid() { return valid; };
 
@@ -148,6 +171,7 @@ public:
     bool getGasStealHappened() const { return gasStealHappened; };
     int getFrameEnemyUsesGas() const { return frameEnemyUsesGas; };
 
+    const OpeningTimingRecord & getOpeningTimingRecord() const;
     const std::vector<int> * getSkillInfo(Skill * skill, int i) const;
     void setSkillInfo(Skill * skill, int i, const std::vector<int> & info);
 
@@ -1,5 +1,6 @@
 #include "Grid.h"
 
+#include "MapCache.h"
 #include "UABAssert.h"
 
 using namespace UAlbertaBot;
@@ -62,6 +63,16 @@ void Grid::selfTest(const std::string & message) const
     }
 }
 
+void Grid::write(MapCacheWriter & out) const
+{
+    out.putGrid(grid, width, height);
+}
+
+bool Grid::read(MapCacheReader & in)
+{
+    return in.getGrid(grid, width, height);
+}
+
 // Draw a number in each tile.
 // This default method is overridden in some subclasses.
 void Grid::draw() const
@@ -9,6 +9,9 @@
 
 namespace UAlbertaBot
 {
+class MapCacheReader;
+class MapCacheWriter;
+
 class Grid
 {
 protected:
@@ -30,6 +33,13 @@ public:
 
     virtual void selfTest(const std::string & message) const;
 
+    // The raw values, grid[x][y], for whole-grid computations.
+    const std::vector< std::vector<short> > & values() const { return grid; };
+
+    // For the map cache.
+    void write(MapCacheWriter & out) const;
+    bool read(MapCacheReader & in);
+
     virtual void draw() const;
 };
 }
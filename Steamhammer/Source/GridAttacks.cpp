@@ -1,6 +1,7 @@
 #include "GridAttacks.h"
 
 #include "InformationManager.h"
+#include "Profiler.h"
 #include "UnitUtil.h"
 
 using namespace UAlbertaBot;
@@ -87,6 +88,8 @@ GridAttacks::GridAttacks(bool air)
 // Initialize with attacks by the enemy, against either air or ground units.
 void GridAttacks::update()
 {
+    ProfileZone zone("GridAttacks::update");
+
     // Zero out the grid.
     for (int x = 0; x < width; ++x)
     {
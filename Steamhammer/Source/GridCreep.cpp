@@ -1,20 +1,210 @@
 #include "GridCreep.h"
 
+#include <algorithm>
+#include "The.h"
+
 using namespace UAlbertaBot;
 
-void GridCreep::addKnownCreep()
+namespace
 {
+    // A mask of the bits of x's word from x through right inclusive, or to the end of the word.
+    uint64_t WordMask(int x, int right)
+    {
+        const int lastInWord = std::min(right, (x / 64) * 64 + 63);
+        const int nBits = lastInWord - x + 1;
+        return (nBits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nBits) - 1)) << (x % 64);
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
+bool GridCreep::bit(const std::vector<uint64_t> & bits, const BWAPI::TilePosition & tile) const
+{
+    if (!tile.isValid())
+    {
+        return false;
+    }
+    return (bits[size_t(tile.y) * wordsPerRow + tile.x / 64] >> (tile.x % 64)) & 1;
+}
+
+bool GridCreep::allBits(const std::vector<uint64_t> & bits, const BWAPI::TilePosition & topLeft, int w, int h) const
+{
+    if (topLeft.x < 0 || topLeft.y < 0 || topLeft.x + w > width || topLeft.y + h > height)
+    {
+        return false;
+    }
+
+    const int right = topLeft.x + w - 1;
+    for (int y = topLeft.y; y < topLeft.y + h; ++y)
+    {
+        const uint64_t * row = &bits[size_t(y) * wordsPerRow];
+        for (int x = topLeft.x; x <= right; x = (x / 64 + 1) * 64)
+        {
+            const uint64_t mask = WordMask(x, right);
+            if ((row[x / 64] & mask) != mask)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Allow one extra tile for the rounding of sight range.
+GridCreep::Sight GridCreep::sightOf(BWAPI::Unit unit) const
+{
+    const Sight sight = { unit->getPosition(), the.self()->sightRange(unit->getType()) + 32, unit->getType(), unit->isCompleted() };
+    return sight;
+}
+
+// Mark the tiles within range of the center, a bounding box, to be refreshed.
+void GridCreep::markDirty(const Sight & sight)
+{
+    const int left = std::max(0, (sight.center.x - sight.range) / 32);
+    const int right = std::min(width - 1, (sight.center.x + sight.range) / 32);
+    const int top = std::max(0, (sight.center.y - sight.range) / 32);
+    const int bottom = std::min(height - 1, (sight.center.y + sight.range) / 32);
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        uint64_t * row = &dirtyBits[size_t(y) * wordsPerRow];
+        for (int x = left; x <= right; x = (x / 64 + 1) * 64)
+        {
+            row[x / 64] |= WordMask(x, right);
+        }
+    }
+}
+
+// Read the tile's state from BWAPI. Creep is known only while the tile is visible.
+void GridCreep::refresh(int x, int y)
+{
+    const size_t i = size_t(y) * wordsPerRow + x / 64;
+    const uint64_t b = uint64_t(1) << (x % 64);
+
+    if (BWAPI::Broodwar->isVisible(x, y))
+    {
+        visibleBits[i] |= b;
+        exploredBits[i] |= b;
+        if (BWAPI::Broodwar->hasCreep(x, y))
+        {
+            creepBits[i] |= b;
+        }
+        else
+        {
+            creepBits[i] &= ~b;
+        }
+    }
+    else
+    {
+        visibleBits[i] &= ~b;
+    }
 }
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
+// The grid is empty until initialize().
 GridCreep::GridCreep()
-    : Grid(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight(), 0)
+    : width(0)
+    , height(0)
+    , wordsPerRow(0)
+{
+}
+
+// Read the whole map once. At the start of the game, that includes the creep of
+// the starting bases that are in sight, and the explored tiles around our own base.
+// Remember what our units see, so update() knows when it goes out of sight.
+void GridCreep::initialize()
 {
-    addKnownCreep();
+    width = BWAPI::Broodwar->mapWidth();
+    height = BWAPI::Broodwar->mapHeight();
+    wordsPerRow = (width + 63) / 64;
+    creepBits.assign(size_t(wordsPerRow) * height, 0);
+    visibleBits.assign(size_t(wordsPerRow) * height, 0);
+    exploredBits.assign(size_t(wordsPerRow) * height, 0);
+    dirtyBits.assign(size_t(wordsPerRow) * height, 0);
+    sights.clear();
+
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            refresh(x, y);
+            if (BWAPI::Broodwar->isExplored(x, y))
+            {
+                exploredBits[size_t(y) * wordsPerRow + x / 64] |= uint64_t(1) << (x % 64);
+            }
+        }
+    }
+
+    for (BWAPI::Unit unit : the.self()->getUnits())
+    {
+        if (unit->getPosition().isValid())
+        {
+            sights[unit] = sightOf(unit);
+        }
+    }
 }
 
 void GridCreep::update()
 {
+    // 1. The tiles that may have changed: the old and new sight boxes of units that moved,
+    // appeared, disappeared, morphed, or completed. A building that finishes may see more.
+    // Now and then, every visible tile for the sake of creep.
+    if (the.now() % FullRefreshFrames == 0)
+    {
+        dirtyBits = visibleBits;
+    }
+    else
+    {
+        std::fill(dirtyBits.begin(), dirtyBits.end(), 0);
+    }
+
+    std::map<BWAPI::Unit, Sight> nextSights;
+    for (BWAPI::Unit unit : the.self()->getUnits())
+    {
+        if (unit->getPosition().isValid())      // not loaded into a transport
+        {
+            const Sight sight = sightOf(unit);
+            nextSights[unit] = sight;
+
+            auto it = sights.find(unit);
+            if (it == sights.end())
+            {
+                markDirty(sight);
+            }
+            else
+            {
+                if (it->second != sight)
+                {
+                    markDirty(it->second);
+                    markDirty(sight);
+                }
+                sights.erase(it);
+            }
+        }
+    }
+
+    // The units left over are gone or loaded. What they saw may have gone out of sight.
+    for (const auto & gone : sights)
+    {
+        markDirty(gone.second);
+    }
+    sights.swap(nextSights);
+
+    // 2. Refresh them, skipping whole words of clean tiles.
+    for (int y = 0; y < height; ++y)
+    {
+        const uint64_t * row = &dirtyBits[size_t(y) * wordsPerRow];
+        for (int w = 0; w < wordsPerRow; ++w)
+        {
+            uint64_t word = row[w];
+            for (int x = w * 64; word; ++x, word >>= 1)
+            {
+                if (word & 1)
+                {
+                    refresh(x, y);
+                }
+            }
+        }
+    }
 }
@@ -1,28 +1,79 @@
-#pragma once
-
-#include "BWAPI.h"
-#include "Grid.h"
-
-// TODO unfinished and unused
-
-// Keep track of zerg creep across the map.
-// 1. Scout enemy zerg bases more quickly--if we see unexplained new creep on a tile
-// where it was formerly missing, it's enemy. (If it was formerly unseen, it may be static creep.)
-// 2. Know where zerg can build beyond its own bases (locate static or enemy creep).
-
-namespace UAlbertaBot
-{
-class GridCreep : public Grid
-{
-
-    // To run once at the start of the game.
-    void addKnownCreep();
-
-public:
-
-    GridCreep();
-
-    void update();
-};
-
-}
\ No newline at end of file
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "BWAPI.h"
+
+// Keep track of creep, visibility, and exploration across the map, at build tile resolution.
+// 1. Remember creep under the fog. BWAPI only reports creep on tiles that are visible now.
+// 2. Answer "is all of this rectangle creep/visible/explored?" for building placement
+//    and for resources, a few word operations per row instead of a BWAPI call per tile.
+// 3. Someday: Scout enemy zerg bases more quickly--if we see unexplained new creep on a tile
+//    where it was formerly missing, it's enemy. (If it was formerly unseen, it may be static creep.)
+
+// Each property is a bitmap, one bit per tile, stored by rows of 64-bit words like the
+// walkability bitmap of MapPartitions.
+// Only tiles that may have changed are refreshed each frame: the sight boxes of our units
+// that moved, appeared, disappeared, morphed, or completed, both where they were and where
+// they are. A unit that stays put as it was sees the same tiles, so its box is skipped. Creep can still spread or recede
+// under a stationary unit's sight, so every visible tile is refreshed every FullRefreshFrames.
+// Tiles in the fog keep their last known state.
+
+namespace UAlbertaBot
+{
+class GridCreep
+{
+    static const int FullRefreshFrames = 24;
+
+    // Where a unit sees from, and what might change what it sees in place.
+    struct Sight
+    {
+        BWAPI::Position center;
+        int range;
+        BWAPI::UnitType type;
+        bool completed;
+
+        bool operator!=(const Sight & other) const
+        {
+            return center != other.center || range != other.range || type != other.type || completed != other.completed;
+        };
+    };
+
+    int width;
+    int height;
+    int wordsPerRow;
+
+    std::vector<uint64_t> creepBits;        // 1 if the tile had creep when last seen
+    std::vector<uint64_t> visibleBits;      // 1 if visible now
+    std::vector<uint64_t> exploredBits;     // 1 if ever seen
+    std::vector<uint64_t> dirtyBits;        // 1 if to be refreshed this frame
+
+    std::map<BWAPI::Unit, Sight> sights;    // our units' sight boxes as of the last update
+
+    bool bit(const std::vector<uint64_t> & bits, const BWAPI::TilePosition & tile) const;
+    bool allBits(const std::vector<uint64_t> & bits, const BWAPI::TilePosition & topLeft, int w, int h) const;
+    Sight sightOf(BWAPI::Unit unit) const;
+    void markDirty(const Sight & sight);
+    void refresh(int x, int y);
+
+public:
+    GridCreep();
+
+    // Call once at the start of the game.
+    void initialize();
+
+    // Call once per frame, before the information managers.
+    void update();
+
+    bool creep(const BWAPI::TilePosition & tile) const { return bit(creepBits, tile); };
+    bool visible(const BWAPI::TilePosition & tile) const { return bit(visibleBits, tile); };
+    bool explored(const BWAPI::TilePosition & tile) const { return bit(exploredBits, tile); };
+
+    // Is every tile of the w x h rectangle creep/visible/explored? False if it is off the map.
+    bool allCreep(const BWAPI::TilePosition & topLeft, int w, int h) const { return allBits(creepBits, topLeft, w, h); };
+    bool allVisible(const BWAPI::TilePosition & topLeft, int w, int h) const { return allBits(visibleBits, topLeft, w, h); };
+    bool allExplored(const BWAPI::TilePosition & topLeft, int w, int h) const { return allBits(exploredBits, topLeft, w, h); };
+};
+
+}
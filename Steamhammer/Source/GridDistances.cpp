@@ -43,9 +43,82 @@ int GridDistances::getStaticUnitDistance(const BWAPI::Unit unit) const
     return dist;
 }
 
-const std::vector<BWAPI::TilePosition> & GridDistances::getSortedTiles() const
+// The distances don't change, so the waypoint from a tile is always the same.
+// Look it up if we found it before, so that many units following the same distances
+// pay for each tile once.
+BWAPI::TilePosition GridDistances::getWaypoint(const BWAPI::TilePosition & tile) const
 {
-    return sortedTilePositions;
+    if (waypoints.empty())
+    {
+        waypoints.assign(width * height, -1);
+    }
+
+    int & waypoint = waypoints[tile.x + tile.y * width];
+    if (waypoint < 0)
+    {
+        const BWAPI::TilePosition found = findWaypoint(tile);
+        waypoint = found.x + found.y * width;
+    }
+    return BWAPI::TilePosition(waypoint % width, waypoint / width);
+}
+
+// Is the distance inside the target distance?
+bool GridDistances::distanceIs(int x, int y, int target) const
+{
+    BWAPI::TilePosition xy(x, y);
+    return xy.isValid() && at(xy) < target && at(xy) >= 0;
+}
+
+// Follow the distances downhill to find the waypoint.
+BWAPI::TilePosition GridDistances::findWaypoint(const BWAPI::TilePosition & tile) const
+{
+    const int StepSize = 8;
+    int here = at(tile);
+    if (here < StepSize)
+    {
+        // Either we're already very near, or we can't get there. Same answer for both.
+        // NOTE This lets distances be slightluy offset from the true distances without error.
+        return tile;
+    }
+
+    // One tile of every StepSize tiles along the path is a waypoint.
+    // When we are halfway between waypoints, we switch to the following one.
+    // In other words, if we're going to X and we're halfway between B and C, we switch from waypoint C to D.
+    const int phase = here % StepSize;
+    const int target = std::max(0, here - phase - (phase > StepSize / 2 ? 0 : StepSize));
+
+    int x = tile.x;
+    int y = tile.y;
+    while (here > target)
+    {
+        UAB_ASSERT(BWAPI::TilePosition(x, y).isValid(), "bad tile %d,%d", x, y);
+        UAB_ASSERT(at(BWAPI::TilePosition(x, y)) >= 0, "inaccessible tile %d,%d", x, y);
+
+        // Unroll the loop by hand.
+        // Check diagonals first, so that we prefer to move diagonally when it's shortest.
+             if (distanceIs(x-1, y-1, here)) { x = x-1; y = y-1; }
+        else if (distanceIs(x+1, y-1, here)) { x = x+1; y = y-1; }
+        else if (distanceIs(x+1, y+1, here)) { x = x+1; y = y+1; }
+        else if (distanceIs(x-1, y+1, here)) { x = x-1; y = y+1; }
+        // Then check the orthogonal directions.
+        else if (distanceIs(x-1, y  , here)) { x = x-1; y = y  ; }
+        else if (distanceIs(x+1, y  , here)) { x = x+1; y = y  ; }
+        else if (distanceIs(x  , y-1, here)) { x = x  ; y = y-1; }
+        else if (distanceIs(x  , y+1, here)) { x = x  ; y = y+1; }
+        else
+        {
+            // We failed to find a way to advance. That should not happen.
+            UAB_ASSERT(false, "can't go from %d,%d", x, y);
+            break;
+        }
+
+        here = at(BWAPI::TilePosition(x, y));        // closer by 1 or 2 tiles
+    }
+
+    UAB_ASSERT(BWAPI::TilePosition(x, y).isValid(), "bad tile %d,%d", x, y);
+    UAB_ASSERT(at(BWAPI::TilePosition(x, y)) >= 0, "inaccessible tile %d,%d", x, y);
+
+    return BWAPI::TilePosition(x, y);
 }
 
 // Computes grid[x][y] = Manhattan ground distance from the starting tile to (x,y),
@@ -62,7 +135,6 @@ void GridDistances::compute(const BWAPI::TilePosition & start, int limit, bool n
     fringe.push_back(start);
 
     grid[start.x][start.y] = 0;
-    sortedTilePositions.push_back(start);
 
     for (size_t fringeIndex=0; fringeIndex<fringe.size(); ++fringeIndex)
     {
@@ -86,7 +158,6 @@ void GridDistances::compute(const BWAPI::TilePosition & start, int limit, bool n
             {
                 fringe.push_back(nextTile);
                 grid[nextTile.x][nextTile.y] = currentDist + 1;
-                sortedTilePositions.push_back(nextTile);
             }
         }
     }
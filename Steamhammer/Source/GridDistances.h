@@ -8,9 +8,12 @@ namespace UAlbertaBot
 {
 class GridDistances : public Grid
 {
-    std::vector<BWAPI::TilePosition> sortedTilePositions;
+    // The waypoint from each tile, filled in as units ask. -1 if not known yet, by rows.
+    mutable std::vector<int> waypoints;
 
     void compute(const BWAPI::TilePosition & start, int limit, bool neutralBlocks);
+    bool distanceIs(int x, int y, int target) const;
+    BWAPI::TilePosition findWaypoint(const BWAPI::TilePosition & tile) const;
 
 public:
     GridDistances();
@@ -19,6 +22,8 @@ public:
 
     int getStaticUnitDistance(const BWAPI::Unit unit) const;
 
-    const std::vector<BWAPI::TilePosition> & getSortedTiles() const;
+    // The next waypoint on a shortest path from the tile toward the start.
+    // The tile itself if it is near the start or can't reach it.
+    BWAPI::TilePosition getWaypoint(const BWAPI::TilePosition & tile) const;
 };
 }
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "GridInset.h"
 
+#include "DistanceTransform.h"
 #include "The.h"
 #include "UABAssert.h"
 
@@ -19,104 +20,23 @@ GridInset::GridInset()
 }
 
 // This depends on the.partitions already being initialized.
+// The inset is the distance to the nearest unwalkable walk tile, counting off the map as
+// unwalkable. Unwalkable tiles get 0.
 void GridInset::initialize()
 {
     width = 4 * BWAPI::Broodwar->mapWidth();
     height = 4 * BWAPI::Broodwar->mapHeight();
-    grid = std::vector< std::vector<short> >(width, std::vector<short>(height, short(-1)));
+    grid = std::vector< std::vector<short> >(width, std::vector<short>(height));
 
-    std::vector<BWAPI::WalkPosition> fringe;
-    fringe.reserve(width * height);
-
-    // 1. Put any walkable tiles on the edge of the map into the fringe.
-    // They are next to an unwalkable edge and have inset == 1.
-    for (int x = 0; x < width; ++x)				// this includes the corner tiles
-    {
-        if (the.partitions.walkable(x, 0))
-        {
-            fringe.push_back(BWAPI::WalkPosition(x, 0));
-            grid[x][0] = 1;
-        }
-        else
-        {
-            grid[x][0] = 0;
-        }
-        if (the.partitions.walkable(x, height-1))
-        {
-            fringe.push_back(BWAPI::WalkPosition(x, height-1));
-            grid[x][height-1] = 1;
-        }
-        else
-        {
-            grid[x][height-1] = 0;
-        }
-    }
-    for (int y = 1; y < height-1; ++y)			// don't add the corner tiles again
-    {
-        if (the.partitions.walkable(0, y))
-        {
-            fringe.push_back(BWAPI::WalkPosition(0, y));
-            grid[0][y] = 1;
-        }
-        else
-        {
-            grid[0][y] = 0;
-        }
-        if (the.partitions.walkable(width-1, y))
-        {
-            fringe.push_back(BWAPI::WalkPosition(width-1, y));
-            grid[width-1][y] = 1;
-        }
-        else
-        {
-            grid[width-1][y] = 0;
-        }
-    }
-
-    // 2. Put any interior walkable tiles which are adjacent to unwalkable terrain into the fringe.
-    for (int x = 1; x < width-1; ++x)
+    for (int x = 0; x < width; ++x)
     {
-        for (int y = 1; y < height-1; ++y)
+        for (int y = 0; y < height; ++y)
         {
-            if (the.partitions.walkable(x, y))
-            {
-                if (!the.partitions.walkable(x + 1, y) ||
-                    !the.partitions.walkable(x - 1, y) ||
-                    !the.partitions.walkable(x, y + 1) ||
-                    !the.partitions.walkable(x, y - 1))
-                {
-                    fringe.push_back(BWAPI::WalkPosition(x, y));
-                    grid[x][y] = 1;
-                }
-            }
-            else
-            {
-                grid[x][y] = 0;
-            }
+            grid[x][y] = the.partitions.walkable(x, y) ? 1 : 0;
         }
     }
 
-    // 3. Now compute the next distance from each fringe tile.
-    for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
-    {
-        const BWAPI::WalkPosition & tile = fringe[fringeIndex];
-
-        int currentDist = grid[tile.x][tile.y];
-
-        // The legal actions define which tiles are nearest neighbors of this one.
-        for (size_t a = 0; a < LegalActions; ++a)
-        {
-            BWAPI::WalkPosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
-
-            // If the new tile is inside the map bounds, has not been visited yet, and is walkable.
-            if (nextTile.isValid() &&
-                grid[nextTile.x][nextTile.y] == -1)		// unwalkable tiles were set to 0 above
-            {
-                fringe.push_back(nextTile);
-                grid[nextTile.x][nextTile.y] = currentDist + 1;
-            }
-        }
-    }
+    DistanceTransform::Manhattan(grid);
 }
 
 // Try to find a position near the start with the given inset.
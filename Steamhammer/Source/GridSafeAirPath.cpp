@@ -1,74 +1,377 @@
 #include "GridSafeAirPath.h"
 
-#include "MapTools.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <tuple>
 #include "The.h"
 
 using namespace UAlbertaBot;
 
+namespace
+{
+    const short Infinity = SHRT_MAX;    // no path known
+    const int DangerCost = 16;          // extra cost per air attack on a tile...
+    const int MaxDanger = 3;            // ...counting up to this many attacks
+    const int RepairLimit = 10;         // percent of the tiles a repair may settle
+
+    const size_t LegalActions = 8;
+    const int actionX[LegalActions] = { 1, -1, 0, 0, 1, 1, -1, -1 };
+    const int actionY[LegalActions] = { 0, 0, 1, -1, 1, -1, 1, -1 };
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// The cost of flying from one tile to a neighboring tile.
+int GridSafeAirPath::stepCost(int fromX, int fromY, int toX, int toY) const
+{
+    const int step = fromX != toX && fromY != toY ? 3 : 2;
+    return step + DangerCost * std::min(MaxDanger, the.airAttacks.at(toX, toY));
+}
+
+// Return the lowest cost to the goal by way of a neighbor, and which neighbor.
+int GridSafeAirPath::bestNeighbor(int x, int y, int & nextX, int & nextY) const
+{
+    int best = Infinity;
+    for (size_t a = 0; a < LegalActions; ++a)
+    {
+        const int nx = x + actionX[a];
+        const int ny = y + actionY[a];
+        if (nx >= 0 && ny >= 0 && nx < width && ny < height && grid[nx][ny] < Infinity)
+        {
+            const int cost = grid[nx][ny] + stepCost(x, y, nx, ny);
+            if (cost < best)
+            {
+                best = cost;
+                nextX = nx;
+                nextY = ny;
+            }
+        }
+    }
+    return best;
+}
+
+// Recompute the tile's lookahead cost, and put it on the open list if it is inconsistent.
+void GridSafeAirPath::updateTile(int x, int y)
+{
+    if (x != goal.x || y != goal.y)
+    {
+        int nx, ny;
+        rhs[x][y] = short(std::min(int(Infinity), bestNeighbor(x, y, nx, ny)));
+    }
+
+    if (grid[x][y] != rhs[x][y])
+    {
+        open.push(Entry(std::min(grid[x][y], rhs[x][y]), x + y * width));
+    }
+}
+
+// Settle tiles in order of cost until all are consistent.
+// Open list entries whose key is out of date are skipped.
+// Give up and return false if more than the limit of tiles need settling.
+bool GridSafeAirPath::computePaths(int limit)
+{
+    while (!open.empty())
+    {
+        const Entry entry = open.top();
+        open.pop();
+
+        const int x = entry.second % width;
+        const int y = entry.second / width;
+        short & g = grid[x][y];
+        if (g == rhs[x][y] || entry.first != std::min(g, rhs[x][y]))
+        {
+            continue;
+        }
+
+        if (--limit < 0)
+        {
+            return false;
+        }
+
+        if (g > rhs[x][y])
+        {
+            // The cost went down. Settle it.
+            g = rhs[x][y];
+        }
+        else
+        {
+            // The cost went up. Forget it, and find it again from the neighbors.
+            g = Infinity;
+            updateTile(x, y);
+        }
+
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const int nx = x + actionX[a];
+            const int ny = y + actionY[a];
+            if (nx >= 0 && ny >= 0 && nx < width && ny < height)
+            {
+                updateTile(nx, ny);
+            }
+        }
+    }
+    return true;
+}
+
+// Find the cost of every tile from scratch. There is nothing to repair, so it is a plain
+// Dijkstra search. Afterward every tile is consistent.
+void GridSafeAirPath::search()
+{
+    for (std::vector<short> & column : grid)
+    {
+        std::fill(column.begin(), column.end(), Infinity);
+    }
+    open = decltype(open)();
+
+    grid[goal.x][goal.y] = 0;
+    open.push(Entry(0, goal.x + goal.y * width));
+    while (!open.empty())
+    {
+        const Entry entry = open.top();
+        open.pop();
+
+        const int x = entry.second % width;
+        const int y = entry.second / width;
+        if (entry.first > grid[x][y])
+        {
+            continue;
+        }
+
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const int nx = x + actionX[a];
+            const int ny = y + actionY[a];
+            if (nx >= 0 && ny >= 0 && nx < width && ny < height)
+            {
+                const int cost = entry.first + stepCost(nx, ny, x, y);
+                if (cost < grid[nx][ny])
+                {
+                    grid[nx][ny] = short(cost);
+                    open.push(Entry(cost, nx + ny * width));
+                }
+            }
+        }
+    }
+    rhs = grid;
+}
+
 GridSafeAirPath::GridSafeAirPath()
     : Grid()
 {
 }
 
-GridSafeAirPath::GridSafeAirPath(const BWAPI::TilePosition & start)
-    : Grid(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight(), -1)
+GridSafeAirPath::GridSafeAirPath(const BWAPI::TilePosition & destination)
+    : Grid(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight(), Infinity)
+    , goal(destination)
+{
+    search();
+}
+
+// A change in the air attacks at a tile changes the cost of flying into it from each neighbor.
+void GridSafeAirPath::repair(const std::vector<BWAPI::TilePosition> & changed)
+{
+    for (const BWAPI::TilePosition & tile : changed)
+    {
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const int nx = tile.x + actionX[a];
+            const int ny = tile.y + actionY[a];
+            if (nx >= 0 && ny >= 0 && nx < width && ny < height)
+            {
+                updateTile(nx, ny);
+            }
+        }
+    }
+
+    // A change near the goal can raise the cost of most of the map. Repairing that is
+    // slower than starting over, so past a limit, start over.
+    if (!computePaths(RepairLimit * width * height / 100))
+    {
+        search();
+    }
+}
+
+BWAPI::TilePosition GridSafeAirPath::getWaypoint(const BWAPI::TilePosition & tile) const
 {
-    computeAir(start, 256 * 256 + 1);
+    const int StepSize = 6;
+
+    int x = tile.x;
+    int y = tile.y;
+    for (int step = 0; step < StepSize && (x != goal.x || y != goal.y); ++step)
+    {
+        int nx, ny;
+        if (bestNeighbor(x, y, nx, ny) >= Infinity || grid[nx][ny] >= grid[x][y])
+        {
+            break;
+        }
+        x = nx;
+        y = ny;
+    }
+    return BWAPI::TilePosition(x, y);
 }
 
-// Compute the map only up to the given distance limit.
-// Tiles beyond the limit are "unreachable".
-GridSafeAirPath::GridSafeAirPath(const BWAPI::TilePosition & start, int limit)
-    : Grid(BWAPI::Broodwar->mapWidth(), BWAPI::Broodwar->mapHeight(), -1)
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+SafeAirPaths::SafeAirPaths()
+    : _newPathFrame(-1)
+    , _newPaths(0)
 {
-    computeAir(start, limit);
 }
 
-const std::vector<BWAPI::TilePosition> & GridSafeAirPath::getSortedTiles() const
+// Is every tile on the straight line out of range of air defense?
+bool SafeAirPaths::straightLineIsSafe(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to) const
 {
-    return sortedTilePositions;
+    const int dx = to.x - from.x;
+    const int dy = to.y - from.y;
+    const int steps = std::max(std::abs(dx), std::abs(dy));
+    for (int i = 0; i <= steps; ++i)
+    {
+        const int x = from.x + int(std::lround(double(dx * i) / steps));
+        const int y = from.y + int(std::lround(double(dy * i) / steps));
+        if (the.airAttacks.at(x, y) > 0)
+        {
+            return false;
+        }
+    }
+    return true;
 }
 
-// Computes grid[x][y] = Manhattan ground distance from the starting tile to (x,y),
-// up to the given limiting distance (and no farther, to save time).
-// Uses BFS, since the map is quite large and DFS may cause a stack overflow
-void GridSafeAirPath::computeAir(const BWAPI::TilePosition & start, int limit)
+void SafeAirPaths::forgetLeastRecentlyUsed()
 {
-    const size_t LegalActions = 4;
-    const int actionX[LegalActions] = { 1, -1, 0, 0 };
-    const int actionY[LegalActions] = { 0, 0, 1, -1 };
+    auto oldest = _lastUsed.begin();
+    for (auto it = _lastUsed.begin(); it != _lastUsed.end(); ++it)
+    {
+        if (it->second < oldest->second)
+        {
+            oldest = it;
+        }
+    }
+    if (oldest != _lastUsed.end())
+    {
+        forget(oldest->first);
+    }
+}
 
-    // the fringe for the BFS we will perform to calculate distances
-    std::vector<BWAPI::TilePosition> fringe;
-    fringe.reserve(width * height);
-    fringe.push_back(start);
+void SafeAirPaths::forget(const BWAPI::TilePosition & goal)
+{
+    _paths.erase(goal);
+    _lastUsed.erase(goal);
+    _unrepaired.erase(goal);
+}
 
-    grid[start.x][start.y] = 0;
-    sortedTilePositions.push_back(start);
+void SafeAirPaths::update()
+{
+    // Forget paths that no flyer wants any more.
+    std::vector<BWAPI::TilePosition> unused;
+    for (const auto & used : _lastUsed)
+    {
+        if (the.now() - used.second > KeepFrames)
+        {
+            unused.push_back(used.first);
+        }
+    }
+    for (const BWAPI::TilePosition & goal : unused)
+    {
+        forget(goal);
+    }
 
-    for (size_t fringeIndex=0; fringeIndex<fringe.size(); ++fringeIndex)
+    // With no paths there is nothing to repair. The next new path starts from the current attacks.
+    if (_paths.empty())
     {
-        const BWAPI::TilePosition & tile = fringe[fringeIndex];
+        _attacks.clear();
+        return;
+    }
 
-        int currentDist = grid[tile.x][tile.y];
-        if (currentDist >= limit)
+    // Note where the air attacks changed, for each path.
+    const std::vector< std::vector<short> > & attacks = the.airAttacks.values();
+    if (!_attacks.empty())
+    {
+        std::vector<BWAPI::TilePosition> changed;
+        for (size_t x = 0; x < attacks.size(); ++x)
         {
-            continue;
+            for (size_t y = 0; y < attacks[x].size(); ++y)
+            {
+                if (attacks[x][y] != _attacks[x][y])
+                {
+                    changed.push_back(BWAPI::TilePosition(int(x), int(y)));
+                }
+            }
         }
 
-        // The legal actions define which tiles are nearest neighbors of this one.
-        for (size_t a=0; a<LegalActions; ++a)
+        if (!changed.empty())
         {
-            BWAPI::TilePosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+            for (const auto & path : _paths)
+            {
+                std::vector<BWAPI::TilePosition> & unrepaired = _unrepaired[path.first];
+                unrepaired.insert(unrepaired.end(), changed.begin(), changed.end());
+            }
+        }
+    }
+    _attacks = attacks;
 
-            if (nextTile.isValid() &&
-                grid[nextTile.x][nextTile.y] == -1 &&
-                the.airAttacks.at(nextTile) == 0)
+    // Repair a few paths per frame, the most recently used first. Until its turn comes,
+    // a path steers around the air defense as it was.
+    for (int n = 0; n < MaxRepairsPerFrame && !_unrepaired.empty(); ++n)
+    {
+        auto next = _unrepaired.begin();
+        for (auto it = _unrepaired.begin(); it != _unrepaired.end(); ++it)
+        {
+            if (_lastUsed[it->first] > _lastUsed[next->first])
             {
-                fringe.push_back(nextTile);
-                grid[nextTile.x][nextTile.y] = currentDist;
-                sortedTilePositions.push_back(nextTile);
+                next = it;
             }
         }
+        _paths.at(next->first).repair(next->second);
+        _unrepaired.erase(next);
+    }
+}
+
+BWAPI::Position SafeAirPaths::nextDestination(BWAPI::Unit unit, const BWAPI::Position & destination)
+{
+    const BWAPI::TilePosition here(unit->getTilePosition());
+    const BWAPI::TilePosition goal(destination);
+    if (!here.isValid() || !goal.isValid() || here == goal)
+    {
+        return destination;
+    }
+
+    // With no air defense in the way, fly straight. This is the usual case.
+    if (straightLineIsSafe(here, goal))
+    {
+        return destination;
+    }
+
+    auto it = _paths.find(goal);
+    if (it == _paths.end())
+    {
+        // Limit the cost of new paths in one frame. The flyer goes straight for now
+        // and asks again next frame.
+        if (_newPathFrame != the.now())
+        {
+            _newPathFrame = the.now();
+            _newPaths = 0;
+        }
+        if (_newPaths >= MaxNewPathsPerFrame)
+        {
+            return destination;
+        }
+        ++_newPaths;
+
+        if (_paths.size() >= MaxPaths)
+        {
+            forgetLeastRecentlyUsed();
+        }
+
+        // A new path is computed with the current air attacks. Later changes are repaired in update().
+        if (_attacks.empty())
+        {
+            _attacks = the.airAttacks.values();
+        }
+        it = _paths.emplace(std::piecewise_construct, std::forward_as_tuple(goal), std::forward_as_tuple(goal)).first;
     }
+    _lastUsed[goal] = the.now();
+
+    const BWAPI::TilePosition waypoint = it->second.getWaypoint(here);
+    return waypoint == goal ? destination : TileCenter(waypoint);
 }
@@ -1,24 +1,83 @@
 #pragma once
 
+#include <map>
+#include <queue>
 #include <vector>
 #include "BWAPI.h"
 #include "Grid.h"
 
+// Safe air paths to a destination, avoiding the enemy's static air defense.
+
+// GridSafeAirPath holds the cost of flying from each tile to the destination.
+// Flying is 8-connected, 2 per orthogonal step and 3 per diagonal step, plus a
+// penalty for each tile in range of enemy air defense (the.airAttacks). Danger is
+// avoided where possible and crossed where there is no way around.
+
+// The air attacks change as the enemy builds or loses static defense. The grid is
+// repaired incrementally, in the manner of LPA*: only the tiles whose cost to the
+// destination changes are visited. There is no heuristic, because the grid serves
+// every flyer going to the destination, wherever it is. A repair that would visit much
+// of the map, as when air defense appears next to the destination, starts over instead.
+
 namespace UAlbertaBot
 {
 class GridSafeAirPath : public Grid
 {
 private:
-    std::vector<BWAPI::TilePosition> sortedTilePositions;
+    typedef std::pair<int, int> Entry;      // key, tile index x + y * width
 
-    void compute(const BWAPI::TilePosition & start, int limit);
+    BWAPI::TilePosition goal;
+    std::vector< std::vector<short> > rhs;  // one-step lookahead costs, like grid
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+
+    int stepCost(int fromX, int fromY, int toX, int toY) const;
+    int bestNeighbor(int x, int y, int & nextX, int & nextY) const;
+    void updateTile(int x, int y);
+    bool computePaths(int limit);
+    void search();
 
 public:
     GridSafeAirPath();
-    GridSafeAirPath(const BWAPI::TilePosition & start);
-    GridSafeAirPath(const BWAPI::TilePosition & start, int limit);
+    GridSafeAirPath(const BWAPI::TilePosition & destination);
+
+    // Tiles where the air attacks changed.
+    void repair(const std::vector<BWAPI::TilePosition> & changed);
 
-    const std::vector<BWAPI::TilePosition> & getSortedTiles() const;
-    void computeAir(const BWAPI::TilePosition & start, int limit);
+    // A tile a few steps along the safest path from the given tile. The destination if near.
+    BWAPI::TilePosition getWaypoint(const BWAPI::TilePosition & tile) const;
 };
-}
\ No newline at end of file
+
+// Keep safe air paths to the destinations that flyers are going to, and repair them
+// when the air attacks change. A path is forgotten when no flyer has asked for it lately.
+// A flyer whose straight line is safe needs no path, so most flyers never make one.
+class SafeAirPaths
+{
+private:
+    const int KeepFrames = 10 * 24;
+    const size_t MaxPaths = 8;              // when full, the least recently used path goes
+    const int MaxNewPathsPerFrame = 1;      // each new path searches the whole map
+    const int MaxRepairsPerFrame = 1;       // a repair may have to redo much of a path
+
+    std::map<BWAPI::TilePosition, GridSafeAirPath> _paths;
+    std::map<BWAPI::TilePosition, int> _lastUsed;
+    std::map<BWAPI::TilePosition, std::vector<BWAPI::TilePosition>> _unrepaired;   // changes not yet repaired
+    std::vector< std::vector<short> > _attacks;     // the air attacks the paths know about
+
+    int _newPathFrame;                      // the frame that _newPaths counts for
+    int _newPaths;
+
+    bool straightLineIsSafe(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to) const;
+    void forget(const BWAPI::TilePosition & goal);
+    void forgetLeastRecentlyUsed();
+
+public:
+    SafeAirPaths();
+
+    // Call after the.airAttacks is updated.
+    void update();
+
+    // Where the flyer should move to next on its way to the destination.
+    BWAPI::Position nextDestination(BWAPI::Unit unit, const BWAPI::Position & destination);
+};
+
+}
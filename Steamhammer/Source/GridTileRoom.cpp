@@ -24,12 +24,13 @@ void GridTileRoom::initialize()
     grid = std::vector< std::vector<short> >(width, std::vector<short>(height, short(-1)));
 
     // 2. Loop over each walk tile.
+    const std::vector< std::vector<short> > & room = the.vWalkRoom.values();
     for (int x = 0; x < 4 * width; ++x)
     {
+        std::vector<short> & tileColumn = grid[x / 4];
         for (int y = 0; y < 4 * height; ++y)
         {
-            BWAPI::TilePosition tile(BWAPI::WalkPosition(x, y));
-            grid[tile.x][tile.y] = std::max(grid[tile.x][tile.y], short(the.vWalkRoom.at(x,y)));
+            tileColumn[y / 4] = std::max(tileColumn[y / 4], room[x][y]);
         }
     }
 }
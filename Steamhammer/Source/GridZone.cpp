@@ -1,5 +1,6 @@
 #include "GridZone.h"
 
+#include "MapCache.h"
 #include "The.h"
 
 using namespace UAlbertaBot;
@@ -87,6 +88,16 @@ void GridZone::newZoneID(const Zone * zone, int id)
     }
 }
 
+// Forget any zones, in case the map cache was partly read before it failed.
+void GridZone::clearZones()
+{
+    for (Zone * zone : zones)
+    {
+        delete zone;
+    }
+    zones.clear();
+}
+
 // This is a little expensive, but it is a valuable test during development.
 void GridZone::sanityCheck()
 {
@@ -175,6 +186,7 @@ void GridZone::initialize()
     width = BWAPI::Broodwar->mapWidth();
     height = BWAPI::Broodwar->mapHeight();
     grid = std::vector< std::vector<short> >(width, std::vector<short>(height, short(0)));
+    clearZones();
 
     // 0 is the id of the "not a zone" zone.
     // 0 values in the grid that are found to be part of a zone will be overwritten.
@@ -323,6 +335,84 @@ void GridZone::initialize()
     // sanityCheck();
 }
 
+// Each zone is saved with its tiles, and its neighbors by ID.
+void GridZone::write(MapCacheWriter & out) const
+{
+    Grid::write(out);
+
+    out.putInt(int32_t(zones.size()));
+    for (const Zone * zone : zones)
+    {
+        out.putInt(int32_t(zone->_state));
+        out.putInt(zone->_groundHeight);
+        out.putInt(int32_t(zone->_tiles.size()));
+        for (const BWAPI::TilePosition & tile : zone->_tiles)
+        {
+            out.putTile(tile);
+        }
+        out.putInt(int32_t(zone->_neighbors.size()));
+        for (const Zone * neighbor : zone->_neighbors)
+        {
+            out.putInt(neighbor->_id);
+        }
+    }
+}
+
+bool GridZone::read(MapCacheReader & in)
+{
+    clearZones();
+
+    int32_t nZones;
+    if (!Grid::read(in) || width != BWAPI::Broodwar->mapWidth() ||
+        !in.getInt(nZones) || nZones <= 0 || nZones > width * height + 1)
+    {
+        return false;
+    }
+
+    // Create the zones first, so that neighbors can refer to any of them.
+    for (int id = 0; id < nZones; ++id)
+    {
+        zones.push_back(new Zone(id));
+    }
+
+    for (Zone * zone : zones)
+    {
+        int32_t state, nTiles, nNeighbors;
+        if (!in.getInt(state) || state < int(ZoneState::Choke) || state > int(ZoneState::Invalid) ||
+            !in.getInt(zone->_groundHeight) ||
+            !in.getInt(nTiles) || nTiles < 0 || nTiles > width * height)
+        {
+            return false;
+        }
+        zone->_state = ZoneState(state);
+
+        zone->_tiles.resize(nTiles);
+        for (BWAPI::TilePosition & tile : zone->_tiles)
+        {
+            if (!in.getTile(tile))
+            {
+                return false;
+            }
+        }
+
+        if (!in.getInt(nNeighbors) || nNeighbors < 0 || nNeighbors >= nZones)
+        {
+            return false;
+        }
+        for (int i = 0; i < nNeighbors; ++i)
+        {
+            int32_t id;
+            if (!in.getInt(id) || id <= 0 || id >= nZones)
+            {
+                return false;
+            }
+            zone->_neighbors.insert(zones[id]);
+        }
+    }
+
+    return true;
+}
+
 // The zone with id N is stored at index N in the vector.
 Zone * GridZone::ptr(int id)
 {
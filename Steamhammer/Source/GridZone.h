@@ -51,6 +51,7 @@ private:
     std::vector<Zone *> zones;
 
     void newZoneID(const Zone * zone, int id);
+    void clearZones();
 
     void sanityCheck();
 
@@ -59,6 +60,10 @@ public:
 
     void initialize();
 
+    // For the map cache. The zones are saved along with the grid.
+    void write(MapCacheWriter & out) const;
+    bool read(MapCacheReader & in);
+
     // Return nullptr for zone 0, a pointer to the zone otherwise.
     Zone * ptr(int id);
     Zone * ptr(int x, int y);
@@ -1,41 +1,334 @@
 #include "Logger.h"
 #include <BWAPI.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdarg>
 #include <fstream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "Config.h"
 
 using namespace UAlbertaBot;
 
+// Log messages are written to files by a background thread, so that the game thread
+// never waits for file I/O. Callers on any thread put messages into a bounded lock-free
+// queue (Dmitry Vyukov's bounded MPMC queue, used here with a single consumer).
+// The writer drains the queue in batches and writes each file once per batch.
+// If the queue is full or holds too many bytes, the message is dropped and counted.
+// The writer thread must be stopped by Logger::Flush() from onEnd(). The static LogWriter
+// is destroyed while the DLL unloads, under the loader lock, where joining a thread
+// can deadlock. Logger::Start() from onStart() lets the thread run again in the next game.
+
+namespace
+{
+void WriteNow(const std::string & file, const std::string & text, bool overwrite)
+{
+    std::ofstream logStream(file.c_str(), overwrite ? std::ofstream::trunc : std::ofstream::app);
+    logStream << text;
+}
+
+struct LogMessage
+{
+    std::string file;
+    std::string text;
+    bool overwrite;         // replace the file contents instead of appending
+};
+
+class LogWriter
+{
+private:
+    static const size_t Capacity = 1 << 12;                 // messages, power of 2
+    static const size_t MaxPendingBytes = 4 * 1024 * 1024;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence;
+        LogMessage message;
+    };
+
+    std::vector<Cell> _cells;
+    std::atomic<size_t> _enqueuePos;
+    size_t _dequeuePos;                     // only the writer thread touches it
+    std::atomic<size_t> _pendingBytes;
+
+    std::atomic<size_t> _droppedMessages;
+    std::atomic<size_t> _droppedBytes;
+
+    // The writer thread is started on the first message and stopped by flush().
+    // After that, _closed is set and messages are written by the caller.
+    std::mutex _threadMutex;
+    std::thread _thread;
+    std::atomic<bool> _running;
+    std::atomic<bool> _stopping;
+    std::atomic<bool> _closed;
+
+    // Wakeups for the writer, and completion for flush().
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    std::atomic<size_t> _written;           // messages taken from the queue and written
+    std::condition_variable _done;
+
+    bool tryPush(LogMessage && message)
+    {
+        size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+        Cell * cell;
+        for (;;)
+        {
+            cell = &_cells[pos & (Capacity - 1)];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = intptr_t(sequence) - intptr_t(pos);
+            if (diff == 0)
+            {
+                if (_enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (diff < 0)
+            {
+                return false;       // full
+            }
+            else
+            {
+                pos = _enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+
+        cell->message = std::move(message);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(LogMessage & message)
+    {
+        Cell & cell = _cells[_dequeuePos & (Capacity - 1)];
+        if (cell.sequence.load(std::memory_order_acquire) != _dequeuePos + 1)
+        {
+            return false;           // empty, or the next message is not finished yet
+        }
+
+        message = std::move(cell.message);
+        cell.sequence.store(_dequeuePos + Capacity, std::memory_order_release);
+        ++_dequeuePos;
+        return true;
+    }
+
+    // Take everything in the queue and write it, one open and close per file.
+    void writeBatch()
+    {
+        struct FileBatch
+        {
+            std::string text;
+            bool overwrite = false;
+        };
+        std::map<std::string, FileBatch> batches;
+
+        size_t n = 0;
+        LogMessage message;
+        while (tryPop(message))
+        {
+            FileBatch & batch = batches[message.file];
+            if (message.overwrite)
+            {
+                batch.text.clear();
+                batch.overwrite = true;
+            }
+            batch.text += message.text;
+            _pendingBytes.fetch_sub(message.text.size(), std::memory_order_relaxed);
+            ++n;
+        }
+
+        for (const auto & batch : batches)
+        {
+            WriteNow(batch.first, batch.second.text, batch.second.overwrite);
+        }
+
+        if (n > 0)
+        {
+            std::lock_guard<std::mutex> lock(_wakeMutex);
+            _written.fetch_add(n);
+            _done.notify_all();
+        }
+    }
+
+    void run()
+    {
+        while (!_stopping.load())
+        {
+            writeBatch();
+
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wake.wait_for(lock, std::chrono::milliseconds(50));
+        }
+        writeBatch();
+    }
+
+    void start()
+    {
+        std::lock_guard<std::mutex> lock(_threadMutex);
+        if (!_thread.joinable() && !_closed)
+        {
+            _stopping = false;
+            _thread = std::thread(&LogWriter::run, this);
+            _running = true;
+        }
+    }
+
+public:
+    LogWriter()
+        : _cells(Capacity)
+        , _enqueuePos(0)
+        , _dequeuePos(0)
+        , _pendingBytes(0)
+        , _droppedMessages(0)
+        , _droppedBytes(0)
+        , _running(false)
+        , _stopping(false)
+        , _closed(false)
+        , _written(0)
+    {
+        for (size_t i = 0; i < Capacity; ++i)
+        {
+            _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    // Never join here; see above. If flush() was not called, let the thread go.
+    ~LogWriter()
+    {
+        if (_thread.joinable())
+        {
+            _thread.detach();
+        }
+    }
+
+    void push(const std::string & file, std::string && text, bool overwrite)
+    {
+        if (_closed.load())
+        {
+            WriteNow(file, text, overwrite);
+            return;
+        }
+
+        const size_t size = text.size();
+        if (_pendingBytes.fetch_add(size, std::memory_order_relaxed) + size > MaxPendingBytes ||
+            !tryPush(LogMessage{ file, std::move(text), overwrite }))
+        {
+            _pendingBytes.fetch_sub(size, std::memory_order_relaxed);
+            _droppedMessages.fetch_add(1, std::memory_order_relaxed);
+            _droppedBytes.fetch_add(size, std::memory_order_relaxed);
+            return;
+        }
+
+        if (!_running.load())
+        {
+            start();
+        }
+        _wake.notify_one();
+    }
+
+    // Wait until everything queued so far is written, then stop the writer thread.
+    // Anything still in the queue after that is written here.
+    void flush()
+    {
+        const size_t target = _enqueuePos.load();
+        {
+            std::unique_lock<std::mutex> lock(_wakeMutex);
+            _wake.notify_one();
+            _done.wait_for(lock, std::chrono::seconds(2), [&] { return _written.load() >= target; });
+        }
+
+        std::lock_guard<std::mutex> lock(_threadMutex);
+        if (_thread.joinable())
+        {
+            _stopping = true;
+            _wake.notify_one();
+            _thread.join();
+            _running = false;
+        }
+        _closed = true;
+        writeBatch();
+    }
+
+    // Undo flush(). The writer thread starts again with the next message.
+    void reopen()
+    {
+        std::lock_guard<std::mutex> lock(_threadMutex);
+        _closed = false;
+    }
+
+    // Return the counts of dropped messages and bytes since the last call.
+    void takeDropped(size_t & messages, size_t & bytes)
+    {
+        messages = _droppedMessages.exchange(0);
+        bytes = _droppedBytes.exchange(0);
+    }
+};
+
+LogWriter & Writer()
+{
+    static LogWriter writer;
+    return writer;
+}
+}
+
 void Logger::LogAppendToFile(const std::string & logFile, const std::string & msg)
 {
-    std::ofstream logStream;
-    logStream.open(logFile.c_str(), std::ofstream::app);
-    logStream << msg;
-    logStream.flush();
-    logStream.close();
+    Writer().push(logFile, std::string(msg), false);
 }
 
 void Logger::LogAppendToFile(const std::string & logFile, const char *fmt, ...)
 {
     va_list arg;
-        
+
     va_start(arg, fmt);
-    //vfprintf(log_file, fmt, arg);
-    char buff[256];
-    vsnprintf_s(buff, 256, fmt, arg);
+    va_list argCopy;
+    va_copy(argCopy, arg);
+    const int length = vsnprintf(nullptr, 0, fmt, argCopy);
+    va_end(argCopy);
+
+    std::string msg;
+    if (length > 0)
+    {
+        msg.resize(length + 1);
+        vsnprintf(&msg[0], msg.size(), fmt, arg);
+        msg.resize(length);
+    }
     va_end(arg);
-        
-    std::ofstream logStream;
-    logStream.open(logFile.c_str(), std::ofstream::app);
-    logStream << buff;
-    logStream.flush();
-    logStream.close();
+
+    Writer().push(logFile, std::move(msg), false);
 }
 
 void Logger::LogOverwriteToFile(const std::string & logFile, const std::string & msg)
 {
-    std::ofstream logStream(logFile.c_str());
-    logStream << msg;
-    logStream.flush();
-    logStream.close();
+    Writer().push(logFile, std::string(msg), true);
+}
+
+void Logger::LogAppendToFileNow(const std::string & logFile, const std::string & msg)
+{
+    WriteNow(logFile, msg, false);
+}
+
+void Logger::Start()
+{
+    Writer().reopen();
+}
+
+void Logger::Flush()
+{
+    LogWriter & writer = Writer();
+    writer.flush();
+
+    size_t messages, bytes;
+    writer.takeDropped(messages, bytes);
+    if (messages > 0)
+    {
+        std::ofstream logStream(Config::IO::ErrorLogFilename.c_str(), std::ofstream::app);
+        logStream << "Logger dropped " << messages << " messages, " << bytes << " bytes\n";
+    }
 }
 
 std::string FileUtils::ReadFile(const std::string & filename)
@@ -58,4 +351,4 @@ std::string FileUtils::ReadFile(const std::string & filename)
     }
 
     return ss.str();
-}
\ No newline at end of file
+}
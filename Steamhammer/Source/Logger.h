@@ -9,6 +9,19 @@ namespace Logger
     void LogAppendToFile(const std::string & logFile, const std::string & msg);
     void LogAppendToFile(const std::string & logFile, const char *fmt, ...);
     void LogOverwriteToFile(const std::string & logFile, const std::string & msg);
+
+    // Write the message before returning, bypassing the queue. For errors and assertion
+    // failures, which must reach the file even if the bot is about to crash.
+    void LogAppendToFileNow(const std::string & logFile, const std::string & msg);
+
+    // Allow the background writer thread again after Flush(). Call at the start of each game;
+    // a process may play several games.
+    void Start();
+
+    // Messages are written by a background thread. Wait until they are all written,
+    // stop the thread, and report any that were dropped to the error log.
+    // Call at the end of the game. Later messages are written synchronously until Start().
+    void Flush();
 };
 
 namespace FileUtils
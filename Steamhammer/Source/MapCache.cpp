@@ -0,0 +1,195 @@
+#include "MapCache.h"
+
+#include "Bases.h"
+#include "MappedFile.h"
+#include "OpponentFile.h"
+#include "The.h"
+
+using namespace UAlbertaBot;
+
+// Bits packed 32 to a word, low bit first.
+void MapCacheWriter::putBits(const std::vector< std::vector<bool> > & grid, int width, int height)
+{
+    putInt(width);
+    putInt(height);
+
+    uint32_t word = 0;
+    int nBits = 0;
+    for (const std::vector<bool> & column : grid)
+    {
+        for (const bool bit : column)
+        {
+            if (bit)
+            {
+                word |= 1u << nBits;
+            }
+            if (++nBits == 32)
+            {
+                putInt(int32_t(word));
+                word = 0;
+                nBits = 0;
+            }
+        }
+    }
+    if (nBits > 0)
+    {
+        putInt(int32_t(word));
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+MapCacheReader::MapCacheReader(const char * data, size_t size, int mapWidth, int mapHeight)
+    : _p(data)
+    , _end(data + size)
+    , _mapWidth(mapWidth)
+    , _mapHeight(mapHeight)
+{
+}
+
+// Every grid is at build tile or walk tile resolution.
+bool MapCacheReader::gridSize(int & width, int & height)
+{
+    return
+        getInt(width) &&
+        getInt(height) &&
+        (width == _mapWidth && height == _mapHeight || width == 4 * _mapWidth && height == 4 * _mapHeight);
+}
+
+bool MapCacheReader::skip(size_t size)
+{
+    if (size > size_t(_end - _p))
+    {
+        return false;
+    }
+    _p += size;
+    return true;
+}
+
+bool MapCacheReader::getInt(int32_t & n)
+{
+    if (size_t(_end - _p) < sizeof(n))
+    {
+        return false;
+    }
+    std::memcpy(&n, _p, sizeof(n));
+    _p += sizeof(n);
+    return true;
+}
+
+bool MapCacheReader::getString(std::string & s)
+{
+    int32_t length;
+    if (!getInt(length) || length < 0 || size_t(length) > size_t(_end - _p))
+    {
+        return false;
+    }
+    s.assign(_p, length);
+    return skip(length + (4 - length % 4) % 4);
+}
+
+bool MapCacheReader::getTile(BWAPI::TilePosition & tile)
+{
+    return getInt(tile.x) && getInt(tile.y) && tile.isValid();
+}
+
+bool MapCacheReader::getBits(std::vector< std::vector<bool> > & grid, int & width, int & height)
+{
+    if (!gridSize(width, height) ||
+        size_t(_end - _p) < 4 * ((size_t(width) * height + 31) / 32))
+    {
+        return false;
+    }
+
+    grid.assign(width, std::vector<bool>(height));
+    uint32_t word = 0;
+    int nBits = 32;
+    for (int x = 0; x < width; ++x)
+    {
+        for (int y = 0; y < height; ++y)
+        {
+            if (nBits == 32)
+            {
+                std::memcpy(&word, _p, sizeof(word));
+                _p += sizeof(word);
+                nBits = 0;
+            }
+            grid[x][y] = (word >> nBits) & 1;
+            ++nBits;
+        }
+    }
+    return true;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+std::string MapCache::Filename()
+{
+    return "map_" + BWAPI::Broodwar->mapHash() + ".bin";
+}
+
+bool MapCache::Read(const std::string & filename)
+{
+    MappedFile file;
+    if (!file.open(filename) || file.size() < sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    const size_t bodySize = file.size() - sizeof(uint32_t);
+    uint32_t checksum;
+    std::memcpy(&checksum, file.data() + bodySize, sizeof(checksum));
+    if (checksum != OpponentFileFormat::Checksum(file.data(), bodySize))
+    {
+        return false;
+    }
+
+    const int mapWidth = BWAPI::Broodwar->mapWidth();
+    const int mapHeight = BWAPI::Broodwar->mapHeight();
+
+    MapCacheReader in(file.data(), bodySize, mapWidth, mapHeight);
+    int32_t magic, version, width, height;
+    std::string hash;
+    if (!in.getInt(magic) || uint32_t(magic) != Magic ||
+        !in.getInt(version) || uint32_t(version) != Version ||
+        !in.getInt(width) || width != mapWidth ||
+        !in.getInt(height) || height != mapHeight ||
+        !in.getString(hash) || hash != BWAPI::Broodwar->mapHash())
+    {
+        return false;
+    }
+
+    // The order matches The::initialize(), though only Bases depends on the others when reading.
+    return
+        the.partitions.read(in) &&
+        the.inset.read(in) &&
+        the.vWalkRoom.read(in) &&
+        the.tileRoom.read(in) &&
+        the.zone.read(in) &&
+        the.map.read(in) &&
+        the.bases.read(in);
+}
+
+bool MapCache::Write(const std::string & filename)
+{
+    MapCacheWriter out;
+    out.putInt(int32_t(Magic));
+    out.putInt(int32_t(Version));
+    out.putInt(BWAPI::Broodwar->mapWidth());
+    out.putInt(BWAPI::Broodwar->mapHeight());
+    out.putString(BWAPI::Broodwar->mapHash());
+
+    the.partitions.write(out);
+    the.inset.write(out);
+    the.vWalkRoom.write(out);
+    the.tileRoom.write(out);
+    the.zone.write(out);
+    the.map.write(out);
+    the.bases.write(out);
+
+    std::string contents(out.data());
+    const uint32_t checksum = OpponentFileFormat::Checksum(contents.data(), contents.size());
+    contents.append(reinterpret_cast<const char *>(&checksum), sizeof(checksum));
+
+    return OpponentFile::Replace(filename, contents);
+}
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <BWAPI.h>
+
+// The static map analysis, cached in a binary file per map.
+// The analysis in The::initialize() does the same work every time a map is played. With the
+// cache, a map seen before skips it: The grids, zones, and base locations are read instead.
+// The file is keyed by the map hash. Bump Version whenever the analysis changes, so that
+// old caches are recomputed instead of read.
+
+// The cache is read before the config file is parsed, so it uses the default directories.
+
+// File layout. Integers are 4-byte little-endian.
+//   magic, version, map width, map height (in tiles), map hash string
+//   sections for MapPartitions, GridInset, GridRoom, GridTileRoom, GridZone, MapTools, Bases
+//   checksum of everything before it
+// A string is its length followed by its bytes, padded to a multiple of 4.
+// A grid is its width and height, then either the raw 16-bit values or runs of equal values.
+// Bit grids are packed 32 to a word. Both are stored in column order, grid[x][y].
+
+namespace UAlbertaBot
+{
+class MapCacheWriter
+{
+private:
+    std::string _out;
+
+    template <class T>
+    size_t countRuns(const T * values, size_t n) const
+    {
+        size_t runs = 0;
+        size_t length = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (length == 0 || values[i] != values[i - 1] || length == 0xFFFF)
+            {
+                ++runs;
+                length = 0;
+            }
+            ++length;
+        }
+        return runs;
+    }
+
+    void putRun(uint16_t length, uint16_t value)
+    {
+        putInt(int32_t(uint32_t(length) | (uint32_t(value) << 16)));
+    }
+
+public:
+    const std::string & data() const { return _out; };
+
+    void putInt(int32_t n)
+    {
+        _out.append(reinterpret_cast<const char *>(&n), sizeof(n));
+    }
+
+    void putString(const std::string & s)
+    {
+        putInt(int32_t(s.size()));
+        _out += s;
+        _out.append((4 - s.size() % 4) % 4, '\0');
+    }
+
+    void putTile(const BWAPI::TilePosition & tile)
+    {
+        putInt(tile.x);
+        putInt(tile.y);
+    }
+
+    // For 16-bit values only. Runs are chosen when they are smaller.
+    template <class T>
+    void putValues(const T * values, size_t n)
+    {
+        static_assert(sizeof(T) == 2, "16-bit values only");
+
+        const size_t runs = countRuns(values, n);
+        if (2 * runs < n)
+        {
+            putInt(1);
+            putInt(int32_t(runs));
+            size_t length = 0;
+            for (size_t i = 0; i < n; ++i)
+            {
+                if (length > 0 && (values[i] != values[i - 1] || length == 0xFFFF))
+                {
+                    putRun(uint16_t(length), uint16_t(values[i - 1]));
+                    length = 0;
+                }
+                ++length;
+            }
+            if (length > 0)
+            {
+                putRun(uint16_t(length), uint16_t(values[n - 1]));
+            }
+        }
+        else
+        {
+            putInt(0);
+            _out.append(reinterpret_cast<const char *>(values), n * sizeof(T));
+            _out.append((4 - _out.size() % 4) % 4, '\0');
+        }
+    }
+
+    template <class T>
+    void putGrid(const std::vector< std::vector<T> > & grid, int width, int height)
+    {
+        putInt(width);
+        putInt(height);
+
+        std::vector<T> values;
+        values.reserve(size_t(width) * height);
+        for (const std::vector<T> & column : grid)
+        {
+            values.insert(values.end(), column.begin(), column.end());
+        }
+        putValues(values.data(), values.size());
+    }
+
+    void putBits(const std::vector< std::vector<bool> > & grid, int width, int height);
+};
+
+// Read from a buffer, failing without reading past its end.
+class MapCacheReader
+{
+private:
+    const char * _p;
+    const char * _end;
+    int _mapWidth;          // in tiles; a grid is either this size or 4 times this size
+    int _mapHeight;
+
+    bool gridSize(int & width, int & height);
+
+public:
+    MapCacheReader(const char * data, size_t size, int mapWidth, int mapHeight);
+
+    bool skip(size_t size);
+    bool getInt(int32_t & n);
+    bool getString(std::string & s);
+    bool getTile(BWAPI::TilePosition & tile);
+
+    template <class T>
+    bool getValues(T * values, size_t n)
+    {
+        static_assert(sizeof(T) == 2, "16-bit values only");
+
+        int32_t mode;
+        if (!getInt(mode))
+        {
+            return false;
+        }
+
+        if (mode == 0)
+        {
+            const size_t bytes = n * sizeof(T);
+            if (size_t(_end - _p) < bytes)
+            {
+                return false;
+            }
+            std::memcpy(values, _p, bytes);
+            _p += bytes;
+            return skip((4 - bytes % 4) % 4);
+        }
+
+        int32_t runs;
+        if (mode != 1 || !getInt(runs) || runs < 0 || size_t(runs) > size_t(_end - _p) / 4)
+        {
+            return false;
+        }
+        size_t i = 0;
+        for (int32_t r = 0; r < runs; ++r)
+        {
+            int32_t run;
+            getInt(run);
+            const size_t length = uint32_t(run) & 0xFFFF;
+            if (length > n - i)
+            {
+                return false;
+            }
+            std::fill(values + i, values + i + length, T(uint32_t(run) >> 16));
+            i += length;
+        }
+        return i == n;
+    }
+
+    template <class T>
+    bool getGrid(std::vector< std::vector<T> > & grid, int & width, int & height)
+    {
+        std::vector<T> values;
+        if (!gridSize(width, height))
+        {
+            return false;
+        }
+        values.resize(size_t(width) * height);
+        if (!getValues(values.data(), values.size()))
+        {
+            return false;
+        }
+
+        grid.assign(width, std::vector<T>());
+        for (int x = 0; x < width; ++x)
+        {
+            grid[x].assign(values.begin() + size_t(x) * height, values.begin() + size_t(x + 1) * height);
+        }
+        return true;
+    }
+
+    bool getBits(std::vector< std::vector<bool> > & grid, int & width, int & height);
+};
+
+class MapCache
+{
+private:
+    static const uint32_t Magic = 0x434d4853;      // "SHMC"
+    static const uint32_t Version = 2;
+
+public:
+    // The cache file name for the current map.
+    static std::string Filename();
+
+    // Fill in the map analysis from the file. Return false if the file is missing, damaged,
+    // for a different map, or from a different version. Then the analysis must be done
+    // from scratch, since some of it may have been overwritten.
+    static bool Read(const std::string & filename);
+
+    // Write the map analysis, after it is done.
+    static bool Write(const std::string & filename);
+};
+
+}
@@ -1,6 +1,7 @@
 #include "MapGrid.h"
 
 #include "Bases.h"
+#include "Profiler.h"
 #include "The.h"
 
 using namespace UAlbertaBot;
@@ -10,6 +11,9 @@ using namespace UAlbertaBot;
 // updated each frame, as well as when the cell was last seen and whether there is a comsat scan
 // active there.
 // Also the last time an enemy was seen in the cell, but that is unused so far.
+// Cell membership is incremental: A unit is moved between cells only when it crosses a cell
+// boundary, and a cell's visit time is stored only when its last unit leaves. While a cell
+// holds one of our units, it is being visited right now.
 
 MapGrid & MapGrid::Instance() 
 {
@@ -71,7 +75,7 @@ BWAPI::Position MapGrid::getLeastExplored(bool byGround, int partition)
 
             BWAPI::Position home(the.self()->getStartLocation());
             double dist = home.getDistance(getCellByIndex(r, c).center);
-            int lastVisited = getCellByIndex(r, c).timeLastVisited;
+            int lastVisited = this->lastVisited(getCellByIndex(r, c));
             if (lastVisited < minSeen || (lastVisited == minSeen && dist > minSeenDist))
             {
                 leastRow = r;
@@ -106,7 +110,7 @@ BWAPI::Position MapGrid::getLeastExploredNear(const BWAPI::Position & center, bo
 
             if (center.getApproxDistance(cellCenter) <= 32 * 32 && the.zone.at(center) == the.zone.at(cellCenter))
             {
-                int lastVisited = getCellByIndex(r, c).timeLastVisited;
+                int lastVisited = this->lastVisited(getCellByIndex(r, c));
                 if (lastVisited < minSeen)
                 {
                     leastRow = r;
@@ -153,7 +157,7 @@ BWAPI::Position MapGrid::getLeastExploredNearBase(Base * base, bool byGround)
             if (center1.getApproxDistance(cellCenter) <= 32 * 32 && the.zone.at(center1) == the.zone.at(cellCenter) ||
                 center2.getApproxDistance(cellCenter) <= 24 * 32 && the.zone.at(center2) == the.zone.at(cellCenter))
             {
-                int lastVisited = getCellByIndex(r, c).timeLastVisited;
+                int lastVisited = this->lastVisited(getCellByIndex(r, c));
                 if (lastVisited < minSeen)
                 {
                     leastRow = r;
@@ -221,22 +225,87 @@ BWAPI::Position MapGrid::getCellCenter(int row, int col)
     return getCellByIndex(row, col).center;
 }
 
-// clear the vectors in the grid
-void MapGrid::clearGrid() { 
+// The index into cells[] of the cell containing the position.
+int MapGrid::cellIndex(const BWAPI::Position & pos) const
+{
+    return (pos.y / cellSize) * cols + pos.x / cellSize;
+}
+
+// The frame the cell was last visited by one of our units.
+// If one of our units is there now, that's the last frame we updated.
+int MapGrid::lastVisited(const GridCell & cell) const
+{
+    return cell.ourUnits.empty() ? cell.timeLastVisited : lastUpdated;
+}
+
+void MapGrid::addToCell(BWAPI::Unit unit, int cell, bool ours)
+{
+    std::vector<BWAPI::Unit> & units = ours ? cells[cell].ourUnits : cells[cell].oppUnits;
+    units.push_back(unit);
+}
+
+// Remove the unit from the cell's vector. The vectors are short, so a linear search is fine.
+// When the last unit of a side leaves, remember when the cell was last occupied.
+void MapGrid::removeFromCell(BWAPI::Unit unit, int cell, bool ours)
+{
+    GridCell & gridCell = cells[cell];
+    std::vector<BWAPI::Unit> & units = ours ? gridCell.ourUnits : gridCell.oppUnits;
+
+    auto it = std::find(units.begin(), units.end(), unit);
+    if (it != units.end())
+    {
+        *it = units.back();
+        units.pop_back();
+    }
+
+    if (units.empty())
+    {
+        if (ours)
+        {
+            gridCell.timeLastVisited = lastUpdated;
+        }
+        else
+        {
+            gridCell.timeLastOpponentSeen = lastUpdated;
+        }
+    }
+}
+
+// The unit is present this frame. File it under its current cell, moving it only if
+// it has crossed into a different cell since the last update.
+void MapGrid::place(BWAPI::Unit unit, bool ours)
+{
+    const int frame = BWAPI::Broodwar->getFrameCount();
+    const int cell = cellIndex(unit->getPosition());
+
+    auto it = members.find(unit);
+    if (it == members.end())
+    {
+        addToCell(unit, cell, ours);
+        members[unit] = GridMember{ cell, frame, ours };
+        return;
+    }
 
-    for (size_t i(0); i<cells.size(); ++i) 
+    GridMember & member = it->second;
+    if (member.cell != cell || member.ours != ours)
     {
-        cells[i].ourUnits.clear();
-        cells[i].oppUnits.clear();
+        removeFromCell(unit, member.cell, member.ours);
+        addToCell(unit, cell, ours);
+        member.cell = cell;
+        member.ours = ours;
     }
+    member.frame = frame;
 }
 
-// Populate the grid with units.
+// Keep the grid populated with units.
 // Include all buildings, but other units only if they are completed.
 // For the enemy, only include visible units (InformationManager remembers units which are out of sight).
-// TODO a crash occurred in here once... somewhere
+// Units that were not seen this frame (they died, went out of sight, or were loaded into
+// a transport) are dropped afterward.
 void MapGrid::update() 
 {
+    ProfileZone zone("MapGrid::update");
+
     if (Config::Debug::DrawMapGrid) 
     {
         for (int i=0; i<cols; i++) 
@@ -255,22 +324,20 @@ void MapGrid::update()
             {
                 GridCell & cell = getCellByIndex(r,c);
             
-                BWAPI::Broodwar->drawTextMap(cell.center.x, cell.center.y, "Last Seen %d", cell.timeLastVisited);
+                BWAPI::Broodwar->drawTextMap(cell.center.x, cell.center.y, "Last Seen %d", lastVisited(cell));
                 BWAPI::Broodwar->drawTextMap(cell.center.x, cell.center.y+10, "Row/Col (%d, %d)", r, c);
             }
         }
     }
 
-    clearGrid();
-
-    //BWAPI::Broodwar->printf("MapGrid info: WH(%d, %d)  CS(%d)  RC(%d, %d)  C(%d)", mapWidth, mapHeight, cellSize, rows, cols, cells.size());
+    const int frame = BWAPI::Broodwar->getFrameCount();
 
     for (BWAPI::Unit unit : the.self()->getUnits()) 
     {
-        if (unit->isCompleted() || unit->getType().isBuilding())
+        if ((unit->isCompleted() || unit->getType().isBuilding()) &&
+            unit->getPosition().isValid())
         {
-            getCell(unit).ourUnits.insert(unit);
-            getCell(unit).timeLastVisited = BWAPI::Broodwar->getFrameCount();
+            place(unit, true);
         }
     }
 
@@ -278,12 +345,29 @@ void MapGrid::update()
     {
         if ((unit->isCompleted() || unit->getType().isBuilding()) &&
             unit->getHitPoints() > 0 &&
-            unit->getType() != BWAPI::UnitTypes::Unknown) 
+            unit->getType() != BWAPI::UnitTypes::Unknown &&
+            unit->getPosition().isValid())
         {
-            getCell(unit).oppUnits.insert(unit);
-            getCell(unit).timeLastOpponentSeen = BWAPI::Broodwar->getFrameCount();
+            place(unit, false);
         }
     }
+
+    // Drop units which were not seen this frame.
+    // lastUpdated still holds the previous update frame, the last time they were present.
+    for (auto it = members.begin(); it != members.end(); )
+    {
+        if (it->second.frame != frame)
+        {
+            removeFromCell(it->first, it->second.cell, it->second.ours);
+            it = members.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    lastUpdated = frame;
 }
 
 // Return the set of units in the given circle.
@@ -299,10 +383,7 @@ void MapGrid::getUnits(BWAPI::Unitset & units, BWAPI::Position center, int radiu
     {
         for(int x(x0); x<=x1; ++x)
         {
-            int row = y;
-            int col = x;
-
-            const GridCell & cell(getCellByIndex(row,col));
+            const GridCell & cell(getCellByIndex(y,x));
             if(ourUnits)
             {
                 for (BWAPI::Unit unit : cell.ourUnits)
@@ -310,10 +391,7 @@ void MapGrid::getUnits(BWAPI::Unitset & units, BWAPI::Position center, int radiu
                     BWAPI::Position d(unit->getPosition() - center);
                     if(d.x * d.x + d.y * d.y <= radiusSq)
                     {
-                        if (!units.contains(unit)) 
-                        {
-                            units.insert(unit);
-                        }
+                        units.insert(unit);
                     }
                 }
             }
@@ -324,10 +402,7 @@ void MapGrid::getUnits(BWAPI::Unitset & units, BWAPI::Position center, int radiu
                     BWAPI::Position d(unit->getPosition() - center);
                     if(d.x * d.x + d.y * d.y <= radiusSq)
                     {
-                        if (!units.contains(unit))
-                        { 
-                            units.insert(unit); 
-                        }
+                        units.insert(unit);
                     }
                 }
             }
@@ -8,11 +8,11 @@ class GridCell
 {
 public:
 
-    int             timeLastVisited;
-    int             timeLastOpponentSeen;
+    int             timeLastVisited;        // valid only while ourUnits is empty
+    int             timeLastOpponentSeen;   // valid only while oppUnits is empty
     int				timeLastScan;
-    BWAPI::Unitset  ourUnits;
-    BWAPI::Unitset  oppUnits;
+    std::vector<BWAPI::Unit> ourUnits;
+    std::vector<BWAPI::Unit> oppUnits;
     BWAPI::Position center;
 
     // Not the ideal place for this constant, but this is where it is used.
@@ -29,6 +29,14 @@ public:
 // Forward declaration.
 class Base;
 
+// Which cell a unit is filed under, and the last frame it was seen there.
+struct GridMember
+{
+    int  cell;
+    int  frame;
+    bool ours;
+};
+
 class MapGrid 
 {
     MapGrid();
@@ -40,11 +48,16 @@ class MapGrid
     int							lastUpdated;
 
     std::vector< GridCell >		cells;
+    std::map<BWAPI::Unit, GridMember> members;
 
     void						calculateCellCenters();
 
-    void						clearGrid();
+    int                         cellIndex(const BWAPI::Position & pos) const;
+    void						place(BWAPI::Unit unit, bool ours);
+    void						addToCell(BWAPI::Unit unit, int cell, bool ours);
+    void						removeFromCell(BWAPI::Unit unit, int cell, bool ours);
     BWAPI::Position				getCellCenter(int x, int y);
+    int                         lastVisited(const GridCell & cell) const;
 
 public:
 
@@ -1,86 +1,228 @@
 #include "MapPartitions.h"
 
+#include <algorithm>
+#ifdef WIN32
+#include <intrin.h>
+#endif
+
+#include "MapCache.h"
 #include "UABAssert.h"
 
 using namespace UAlbertaBot;
 
-// Calculate the unwalkability map, which for each walk tile stores the number of obstacles
-// which make the tile unwalkable. Unwalkable terrain counts as one obstacle. Immobile neutral
-// units (whether destructible or not) count as one obstacle each.
-// A tile with value 0 is walkable.
-// The idea is that it is easy to update when a neutral unit is destroyed: Simply subtract 1 from
-// each walk tile the neutral unit blocked.
-void MapPartitions::findUnwalkability()
+namespace
 {
-    // Fill with zeroes.
-    unwalkability = std::vector< std::vector<unsigned short> >(width, std::vector<unsigned short>(height, 0));
+    // The index of the lowest set bit. The word must not be 0.
+    int LowestBit(uint64_t word)
+    {
+#ifdef WIN32
+        unsigned long i;
+        if (_BitScanForward(&i, uint32_t(word)))
+        {
+            return int(i);
+        }
+        _BitScanForward(&i, uint32_t(word >> 32));
+        return 32 + int(i);
+#else
+        return __builtin_ctzll(word);
+#endif
+    }
 
-    // First count terrain.
-    for (int x = 0; x < width; ++x)
+    // A horizontal run of walkable walk tiles, left to right inclusive.
+    struct Run
     {
-        for (int y = 0; y < height; ++y)
+        int y;
+        int left;
+        int right;
+    };
+
+    int FindRoot(std::vector<int> & parent, int i)
+    {
+        while (parent[i] != i)
+        {
+            parent[i] = parent[parent[i]];      // path halving
+            i = parent[i];
+        }
+        return i;
+    }
+
+    void Union(std::vector<int> & parent, int a, int b)
+    {
+        a = FindRoot(parent, a);
+        b = FindRoot(parent, b);
+        if (a < b)
+        {
+            parent[b] = a;
+        }
+        else if (b < a)
+        {
+            parent[a] = b;
+        }
+    }
+}
+
+// Calculate the walkability bitmap. A walk tile is walkable if the terrain is walkable
+// and no immobile neutral unit (whether destructible or not) covers it.
+void MapPartitions::findWalkability()
+{
+    walkBits.assign(size_t(wordsPerRow) * height, 0);
+
+    // First the terrain.
+    for (int y = 0; y < height; ++y)
+    {
+        uint64_t * row = &walkBits[size_t(y) * wordsPerRow];
+        for (int x = 0; x < width; ++x)
         {
-            if (!BWAPI::Broodwar->isWalkable(x, y))
+            if (BWAPI::Broodwar->isWalkable(x, y))
             {
-                unwalkability[x][y] = 1;
+                row[x / 64] |= uint64_t(1) << (x % 64);
             }
         }
     }
 
-    // Then count neutral units.
+    // Then the neutral units.
     for (BWAPI::Unit unit : BWAPI::Broodwar->getStaticNeutralUnits())
     {
         // The neutral units may include moving critters which do not permanently block tiles.
         // Something immobile blocks tiles it occupies until it is destroyed. (Are there exceptions?)
         if (!unit->getType().canMove() && !unit->isFlying())
         {
-
-            for (int x = unit->getLeft() / 8; x <= unit->getRight() / 8; ++x)
+            // Assume it may be partly off the edge.
+            const int left = std::max(0, unit->getLeft() / 8);
+            const int right = std::min(width - 1, unit->getRight() / 8);
+            for (int y = std::max(0, unit->getTop() / 8); y <= std::min(height - 1, unit->getBottom() / 8); ++y)
             {
-                for (int y = unit->getTop() / 8; y <= unit->getBottom() / 8; ++y)
-                {
-                    if (BWAPI::WalkPosition(x, y).isValid())   // assume it may be partly off the edge
-                    {
-                        unwalkability[x][y] += 1;
-                    }
-                }
+                setUnwalkable(y, left, right);
             }
         }
     }
 }
 
-// Mark a partition: Fill a connected region with the value of numPartitions.
-// This depends on unwalkability[], which must be initialized first.
-// TODO This could be made faster by marking a whole line of tiles at once.
-void MapPartitions::markOnePartition(const BWAPI::WalkPosition & start)
+// Clear the walkable bits from left to right inclusive in one row, a word at a time.
+void MapPartitions::setUnwalkable(int y, int left, int right)
 {
-    const size_t LegalActions = 4;
-    const int actionX[LegalActions] = { 1, -1, 0, 0 };
-    const int actionY[LegalActions] = { 0, 0, 1, -1 };
-
-    std::vector<BWAPI::WalkPosition> fringe;
-    fringe.reserve(width * height);
-    fringe.push_back(start);
+    uint64_t * row = &walkBits[size_t(y) * wordsPerRow];
+    for (int x = left; x <= right; x = (x / 64 + 1) * 64)
+    {
+        const int lastInWord = std::min(right, (x / 64) * 64 + 63);
+        const int nBits = lastInWord - x + 1;
+        const uint64_t mask = (nBits == 64 ? ~uint64_t(0) : ((uint64_t(1) << nBits) - 1)) << (x % 64);
+        row[x / 64] &= ~mask;
+    }
+}
 
-    partition[start.x][start.y] = numPartitions;
+// Label the partitions. This depends on the walkability bitmap.
+// 1. Find the runs of walkable tiles in each row, taking whole words of unwalkable tiles at a step.
+// 2. Union each run with the runs it touches in the row above.
+// 3. Number the partitions in the order of their first tile by columns, x then y,
+//    and fill in the partition IDs a run at a time.
+void MapPartitions::findPartitions()
+{
+    std::vector<Run> runs;
+    std::vector<int> parent;
+    size_t prevStart = 0;           // runs of the previous row are [prevStart, rowStart)
 
-    for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
+    for (int y = 0; y < height; ++y)
     {
-        const BWAPI::WalkPosition & tile = fringe[fringeIndex];
+        const uint64_t * row = &walkBits[size_t(y) * wordsPerRow];
+        const size_t rowStart = runs.size();
+        size_t prev = prevStart;
 
-        // The legal actions define which tiles are nearest neighbors of this one.
-        for (size_t a = 0; a < LegalActions; ++a)
+        int x = 0;
+        while (x < width)
         {
-            BWAPI::WalkPosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+            // Find the start of the next run: the next set bit at or after x.
+            uint64_t word = row[x / 64] & (~uint64_t(0) << (x % 64));
+            while (!word && (x = (x / 64 + 1) * 64) < width)
+            {
+                word = row[x / 64];
+            }
+            if (!word)
+            {
+                break;
+            }
+            const int left = (x / 64) * 64 + LowestBit(word);
+
+            // Find the end of the run: the next clear bit.
+            x = left;
+            word = ~row[x / 64] & (~uint64_t(0) << (x % 64));
+            while (!word && (x = (x / 64 + 1) * 64) < width)
+            {
+                word = ~row[x / 64];
+            }
+            const int end = word ? std::min(width, (x / 64) * 64 + LowestBit(word)) : width;
+
+            Run run = { y, left, end - 1 };
+            const int id = int(runs.size());
+            runs.push_back(run);
+            parent.push_back(id);
 
-            // If the new tile is inside the map bounds, has not been marked yet, and is walkable.
-            if (nextTile.isValid() &&
-                partition[nextTile.x][nextTile.y] == 0 &&
-                walkable(nextTile))
+            // Union with overlapping runs in the previous row. They are sorted by x.
+            while (prev < rowStart && runs[prev].right < run.left)
             {
-                fringe.push_back(nextTile);
-                partition[nextTile.x][nextTile.y] = numPartitions;
+                ++prev;
             }
+            for (size_t p = prev; p < rowStart && runs[p].left <= run.right; ++p)
+            {
+                Union(parent, int(p), id);
+            }
+            // The last overlapping run may also overlap the next run in this row.
+            while (prev < rowStart && runs[prev].right <= run.right)
+            {
+                ++prev;
+            }
+
+            x = end;
+        }
+
+        prevStart = rowStart;
+    }
+
+    // The first tile of each partition, as a column order index.
+    std::vector<int> firstTile(runs.size(), INT_MAX);
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        int & first = firstTile[FindRoot(parent, int(i))];
+        first = std::min(first, runs[i].left * height + runs[i].y);
+    }
+    std::vector<std::pair<int, int>> roots;        // first tile, root
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        if (parent[i] == int(i))
+        {
+            roots.push_back(std::make_pair(firstTile[i], int(i)));
+        }
+    }
+    std::sort(roots.begin(), roots.end());
+
+    UAB_ASSERT(roots.size() < 0xFFFF, "too many partitions");
+    numPartitions = int(roots.size());
+    std::vector<unsigned short> rootID(runs.size(), 0);
+    for (size_t i = 0; i < roots.size(); ++i)
+    {
+        rootID[roots[i].second] = (unsigned short)(i + 1);
+    }
+
+    partition.assign(size_t(width) * height, 0);
+    for (size_t i = 0; i < runs.size(); ++i)
+    {
+        const Run & run = runs[i];
+        unsigned short * row = &partition[size_t(run.y) * width];
+        std::fill(row + run.left, row + run.right + 1, rootID[parent[i]]);
+    }
+}
+
+// The partition of each build tile is that of its top left walk tile.
+void MapPartitions::findTilePartitions()
+{
+    const int tileWidth = width / 4;
+    const int tileHeight = height / 4;
+    tilePartition.resize(size_t(tileWidth) * tileHeight);
+    for (int ty = 0; ty < tileHeight; ++ty)
+    {
+        for (int tx = 0; tx < tileWidth; ++tx)
+        {
+            tilePartition[size_t(ty) * tileWidth + tx] = partition[size_t(4 * ty) * width + 4 * tx];
         }
     }
 }
@@ -90,6 +232,7 @@ void MapPartitions::markOnePartition(const BWAPI::WalkPosition & start)
 MapPartitions::MapPartitions()
     : width(0)
     , height(0)
+    , wordsPerRow(0)
     , numPartitions(0)
 {
 }
@@ -98,32 +241,65 @@ void MapPartitions::initialize()
 {
     width = 4 * BWAPI::Broodwar->mapWidth();
     height = 4 * BWAPI::Broodwar->mapHeight();
+    wordsPerRow = (width + 63) / 64;
 
-    findUnwalkability();
+    findWalkability();
+    findPartitions();
+    findTilePartitions();
 
-    partition = std::vector< std::vector<unsigned short> >(width, std::vector<unsigned short>(height, 0));
+    // BWAPI::Broodwar->printf("map partitions: %d", numPartitions);
 
-    for (int x = 0; x < width; ++x)
+    UAB_ASSERT(numPartitions > 0, "no partitions");
+}
+
+void MapPartitions::write(MapCacheWriter & out) const
+{
+    out.putInt(numPartitions);
+    out.putInt(int32_t(walkBits.size()));
+    for (const uint64_t word : walkBits)
     {
-        for (int y = 0; y < height; ++y)
+        out.putInt(int32_t(uint32_t(word)));
+        out.putInt(int32_t(uint32_t(word >> 32)));
+    }
+    out.putValues(partition.data(), partition.size());
+}
+
+bool MapPartitions::read(MapCacheReader & in)
+{
+    width = 4 * BWAPI::Broodwar->mapWidth();
+    height = 4 * BWAPI::Broodwar->mapHeight();
+    wordsPerRow = (width + 63) / 64;
+
+    int32_t nWords;
+    if (!in.getInt(numPartitions) || numPartitions <= 0 ||
+        !in.getInt(nWords) || nWords != wordsPerRow * height)
+    {
+        return false;
+    }
+    walkBits.resize(nWords);
+    for (uint64_t & word : walkBits)
+    {
+        int32_t low, high;
+        if (!in.getInt(low) || !in.getInt(high))
         {
-            if (partition[x][y] == 0 && walkable(x, y))
-            {
-                ++numPartitions;
-                markOnePartition(BWAPI::WalkPosition(x, y));
-            }
+            return false;
         }
+        word = uint64_t(uint32_t(low)) | (uint64_t(uint32_t(high)) << 32);
     }
 
-    // BWAPI::Broodwar->printf("map partitions: %d", numPartitions);
-
-    UAB_ASSERT(numPartitions > 0, "no partitions");
+    partition.resize(size_t(width) * height);
+    if (!in.getValues(partition.data(), partition.size()))
+    {
+        return false;
+    }
+    findTilePartitions();
+    return true;
 }
 
 bool MapPartitions::walkable(int walkX, int walkY) const
 {
     UAB_ASSERT(walkX >= 0 && walkY >= 0 && walkX < width && walkY < height, "bad walk tile");
-    return unwalkability[walkX][walkY] == 0;
+    return (walkBits[size_t(walkY) * wordsPerRow + walkX / 64] >> (walkX % 64)) & 1;
 }
 
 bool MapPartitions::walkable(const BWAPI::WalkPosition & pos) const
@@ -134,7 +310,7 @@ bool MapPartitions::walkable(const BWAPI::WalkPosition & pos) const
 int MapPartitions::id(int walkX, int walkY) const
 {
     UAB_ASSERT(walkX >= 0 && walkY >= 0 && walkX < width && walkY < height, "bad walk tile");
-    return partition[walkX][walkY];
+    return partition[size_t(walkY) * width + walkX];
 }
 
 int MapPartitions::id(const BWAPI::WalkPosition & pos) const
@@ -144,7 +320,8 @@ int MapPartitions::id(const BWAPI::WalkPosition & pos) const
 
 int MapPartitions::id(const BWAPI::TilePosition & pos) const
 {
-    return id(BWAPI::WalkPosition(pos));
+    UAB_ASSERT(pos.x >= 0 && pos.y >= 0 && 4 * pos.x < width && 4 * pos.y < height, "bad tile");
+    return tilePartition[size_t(pos.y) * (width / 4) + pos.x];
 }
 
 int MapPartitions::id(const BWAPI::Position & pos) const
@@ -188,7 +365,7 @@ void MapPartitions::drawPartition(int i, BWAPI::Color color) const
         {
             for (int y = 0; y < height; ++y)
             {
-                if (partition[x][y] == i)
+                if (partition[size_t(y) * width + x] == i)
                 {
                     BWAPI::Position pos = BWAPI::Position(BWAPI::WalkPosition(x, y));
                     BWAPI::Broodwar->drawCircleMap(pos.x + 4, pos.y + 4, 1, color);
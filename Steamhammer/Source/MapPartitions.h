@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <vector>
 #include "BWAPI.h"
 
@@ -18,24 +19,40 @@
 // it is wide enough at every point for the unit to pass.
 // If two walk tiles are not in the same partition, no unit can walk between them.
 
+// Walkability is a bitmap, one bit per walk tile, stored by rows of 64-bit words.
+// Partitions are labeled by union-find over the runs of walkable tiles in each row.
+// They are numbered in the order of their first tile, scanning by columns.
+// A separate table at build tile resolution answers the TilePosition queries.
+
 namespace UAlbertaBot
 {
+    class MapCacheReader;
+    class MapCacheWriter;
+
     class MapPartitions
     {
         int width;		// in walk tiles
         int height;		// in walk tiles
+        int wordsPerRow;
         int numPartitions;
 
-        std::vector< std::vector<unsigned short> > unwalkability;	// 0 if walkable, otherwise count of blockages
-        std::vector< std::vector<unsigned short> > partition;		// 0 if unwalkable, otherwise partition ID
+        std::vector<uint64_t> walkBits;                 // 1 if walkable, by rows
+        std::vector<unsigned short> partition;          // 0 if unwalkable, otherwise partition ID; by rows
+        std::vector<unsigned short> tilePartition;      // partition of the top left walk tile of each build tile
 
-        void findUnwalkability();
-        void markOnePartition(const BWAPI::WalkPosition & start);
+        void findWalkability();
+        void setUnwalkable(int y, int left, int right);
+        void findPartitions();
+        void findTilePartitions();
 
     public:
         MapPartitions();
         void initialize();
 
+        // For the map cache.
+        void write(MapCacheWriter & out) const;
+        bool read(MapCacheReader & in);
+
         bool walkable(int walkX, int walkY) const;
         bool walkable(const BWAPI::WalkPosition & pos) const;
         
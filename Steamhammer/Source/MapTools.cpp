@@ -3,6 +3,7 @@
 #include "Bases.h"
 #include "BuildingPlacer.h"
 #include "InformationManager.h"
+#include "MapCache.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -112,10 +113,37 @@ void MapTools::setBWAPIMapData()
     }
 }
 
-// Ground distance in tiles, -1 if no path exists.
-// This is Manhattan distance, not true walking distance. Still good for finding paths.
-int MapTools::getGroundTileDistance(BWAPI::TilePosition origin, BWAPI::TilePosition destination)
+void MapTools::write(MapCacheWriter & out) const
+{
+    const int width = BWAPI::Broodwar->mapWidth();
+    const int height = BWAPI::Broodwar->mapHeight();
+
+    out.putBits(_terrainWalkable, width, height);
+    out.putBits(_walkable, width, height);
+    out.putBits(_buildable, width, height);
+    out.putBits(_depotBuildable, width, height);
+}
+
+// The grids are all at build tile resolution.
+bool MapTools::read(MapCacheReader & in)
 {
+    int width[4], height[4];
+    return
+        in.getBits(_terrainWalkable, width[0], height[0]) && width[0] == BWAPI::Broodwar->mapWidth() &&
+        in.getBits(_walkable, width[1], height[1]) && width[1] == width[0] &&
+        in.getBits(_buildable, width[2], height[2]) && width[2] == width[0] &&
+        in.getBits(_depotBuildable, width[3], height[3]) && width[3] == width[0];
+}
+
+// Return the distance map to the destination, computing it if needed.
+const GridDistances & MapTools::getDistanceMap(BWAPI::TilePosition destination)
+{
+    auto it = _allMaps.find(destination);
+    if (it != _allMaps.end())
+    {
+        return (*it).second;
+    }
+
     // if we have too many maps, reset our stored maps in case we run out of memory
     if (_allMaps.size() > allMapsSize)
     {
@@ -127,6 +155,51 @@ int MapTools::getGroundTileDistance(BWAPI::TilePosition origin, BWAPI::TilePosit
         }
     }
 
+    return (*_allMaps.insert(std::pair<BWAPI::TilePosition, GridDistances>(destination, GridDistances(destination))).first).second;
+}
+
+// Ground distance in tiles, -1 if no path exists.
+// This is Manhattan distance, not true walking distance. Still good for finding paths.
+// The answer always comes from the zone graph when it finds a path, even if an exact distance
+// map is cached, so that it does not depend on what is cached. It may be a few tiles long.
+// Callers that compare distances to pick the nearest unit use getExactGroundTileDistance().
+int MapTools::getGroundTileDistance(BWAPI::TilePosition origin, BWAPI::TilePosition destination)
+{
+    int dist = the.zoneGraph.distance(origin, destination);
+    if (dist >= 0)
+    {
+        return dist;
+    }
+
+    // The zone graph found no path. Usually there is none, but a tile may be out of reach
+    // of the zones. Make a new map for this destination to be sure.
+    return getDistanceMap(destination).at(origin);
+}
+
+int MapTools::getGroundTileDistance(BWAPI::Position origin, BWAPI::Position destination)
+{
+    return getGroundTileDistance(BWAPI::TilePosition(origin), BWAPI::TilePosition(destination));
+}
+
+// Ground distance in pixels (with TilePosition granularity), -1 if no path exists.
+// TilePosition granularity means that the distance is a multiple of 32 pixels.
+int MapTools::getGroundDistance(BWAPI::Position origin, BWAPI::Position destination)
+{
+    int tiles = getGroundTileDistance(origin, destination);
+    if (tiles > 0)
+    {
+        return 32 * tiles;
+    }
+    return tiles;    // 0 or -1
+}
+
+// Exact ground distance in tiles, -1 if no path exists.
+// The zone graph's answer can be a few tiles long, and by different amounts for different
+// origins. A caller that ranks units by distance to one place, or compares a distance to a
+// tight threshold, uses this instead. It costs one full-map search per destination, which is
+// cached, so ranking many units by distance to the same place is cheap.
+int MapTools::getExactGroundTileDistance(BWAPI::TilePosition origin, BWAPI::TilePosition destination)
+{
     // Do we have a distance map to the destination?
     auto it = _allMaps.find(destination);
     if (it != _allMaps.end())
@@ -142,20 +215,13 @@ int MapTools::getGroundTileDistance(BWAPI::TilePosition origin, BWAPI::TilePosit
     }
 
     // Make a new map for this destination.
-    _allMaps.insert(std::pair<BWAPI::TilePosition, GridDistances>(destination, GridDistances(destination)));
-    return _allMaps[destination].at(origin);
+    return getDistanceMap(destination).at(origin);
 }
 
-int MapTools::getGroundTileDistance(BWAPI::Position origin, BWAPI::Position destination)
+// Exact ground distance in pixels (with TilePosition granularity), -1 if no path exists.
+int MapTools::getExactGroundDistance(BWAPI::Position origin, BWAPI::Position destination)
 {
-    return getGroundTileDistance(BWAPI::TilePosition(origin), BWAPI::TilePosition(destination));
-}
-
-// Ground distance in pixels (with TilePosition granularity), -1 if no path exists.
-// TilePosition granularity means that the distance is a multiple of 32 pixels.
-int MapTools::getGroundDistance(BWAPI::Position origin, BWAPI::Position destination)
-{
-    int tiles = getGroundTileDistance(origin, destination);
+    int tiles = getExactGroundTileDistance(BWAPI::TilePosition(origin), BWAPI::TilePosition(destination));
     if (tiles > 0)
     {
         return 32 * tiles;
@@ -163,15 +229,12 @@ int MapTools::getGroundDistance(BWAPI::Position origin, BWAPI::Position destinat
     return tiles;    // 0 or -1
 }
 
-const std::vector<BWAPI::TilePosition> & MapTools::getClosestTilesTo(BWAPI::TilePosition pos)
+ClosestTiles MapTools::getClosestTilesTo(BWAPI::TilePosition pos) const
 {
-    // make sure the distance map is calculated with pos as a destination
-    int a = getGroundTileDistance(pos, pos);
-
-    return _allMaps[pos].getSortedTiles();
+    return ClosestTiles(pos);
 }
 
-const std::vector<BWAPI::TilePosition> & MapTools::getClosestTilesTo(BWAPI::Position pos)
+ClosestTiles MapTools::getClosestTilesTo(BWAPI::Position pos) const
 {
     return getClosestTilesTo(BWAPI::TilePosition(pos));
 }
@@ -2,6 +2,7 @@
 
 #include <map>
 #include <vector>
+#include "ClosestTiles.h"
 #include "GridDistances.h"
 
 // Keep track of map information, like what tiles are walkable or buildable.
@@ -10,6 +11,8 @@ namespace UAlbertaBot
 {
 class Base;
 class GridDistances;
+class MapCacheReader;
+class MapCacheWriter;
 
 class MapTools
 {
@@ -27,16 +30,25 @@ class MapTools
                         _depotBuildable;
 
     void				setBWAPIMapData();					// reads in the map data from bwapi and stores it in our map format
+    const GridDistances & getDistanceMap(BWAPI::TilePosition destination);
 
 public:
 
     MapTools();
     void initialize();
 
+    // For the map cache.
+    void write(MapCacheWriter & out) const;
+    bool read(MapCacheReader & in);
+
     int		getGroundTileDistance(BWAPI::TilePosition from, BWAPI::TilePosition to);
     int		getGroundTileDistance(BWAPI::Position from, BWAPI::Position to);
     int		getGroundDistance(BWAPI::Position from, BWAPI::Position to);
 
+    // Exact distances from a full-map search, for callers that compare distances to a destination.
+    int		getExactGroundTileDistance(BWAPI::TilePosition from, BWAPI::TilePosition to);
+    int		getExactGroundDistance(BWAPI::Position from, BWAPI::Position to);
+
     // Pass only valid tiles to these routines!
     bool	isTerrainWalkable(BWAPI::TilePosition tile) const { return _terrainWalkable[tile.x][tile.y]; };
     bool	isWalkable(BWAPI::TilePosition tile) const { return _walkable[tile.x][tile.y]; };
@@ -46,8 +58,9 @@ public:
     // TODO deprecated method, used only in Bases
     bool	isBuildable(BWAPI::TilePosition tile, BWAPI::UnitType type) const;
 
-    const std::vector<BWAPI::TilePosition> & getClosestTilesTo(BWAPI::TilePosition pos);
-    const std::vector<BWAPI::TilePosition> & getClosestTilesTo(BWAPI::Position pos);
+    // Walkable tiles in order of distance, searched only as far as the caller iterates.
+    ClosestTiles getClosestTilesTo(BWAPI::TilePosition pos) const;
+    ClosestTiles getClosestTilesTo(BWAPI::Position pos) const;
 
     void	drawHomeDistances();
     void    drawExpoScores();
@@ -0,0 +1,153 @@
+#include "MappedFile.h"
+
+#ifdef WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace UAlbertaBot;
+
+MappedFile::MappedFile()
+    : _open(false)
+    , _data(nullptr)
+    , _size(0)
+#ifdef WIN32
+    , _file(INVALID_HANDLE_VALUE)
+    , _mapping(nullptr)
+#else
+    , _fd(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef WIN32
+
+bool MappedFile::open(const std::string & filename)
+{
+    close();
+
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+    {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+    _file = file;
+    _open = true;
+
+    // A zero-length file cannot be mapped, but it is a valid empty file.
+    if (size.QuadPart == 0)
+    {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping)
+    {
+        close();
+        return false;
+    }
+    _mapping = mapping;
+
+    _data = static_cast<const char *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!_data)
+    {
+        close();
+        return false;
+    }
+    _size = size_t(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data)
+    {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping)
+    {
+        CloseHandle(_mapping);
+    }
+    if (_file != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_file);
+    }
+    _open = false;
+    _data = nullptr;
+    _size = 0;
+    _mapping = nullptr;
+    _file = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+bool MappedFile::open(const std::string & filename)
+{
+    close();
+
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        return false;
+    }
+    _fd = fd;
+    _open = true;
+
+    if (st.st_size == 0)
+    {
+        return true;
+    }
+
+    void * data = mmap(nullptr, size_t(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        close();
+        return false;
+    }
+    _data = static_cast<const char *>(data);
+    _size = size_t(st.st_size);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_data)
+    {
+        munmap(const_cast<char *>(_data), _size);
+    }
+    if (_fd >= 0)
+    {
+        ::close(_fd);
+    }
+    _open = false;
+    _data = nullptr;
+    _size = 0;
+    _fd = -1;
+}
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+// A read-only file mapped into memory. The contents stay valid as long as the object lives.
+
+namespace UAlbertaBot
+{
+class MappedFile
+{
+private:
+    bool _open;
+    const char * _data;
+    size_t _size;
+
+#ifdef WIN32
+    void * _file;
+    void * _mapping;
+#else
+    int _fd;
+#endif
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    // Return false if the file does not exist or cannot be mapped. An empty file maps to size 0.
+    bool open(const std::string & filename);
+    void close();
+
+    bool isOpen() const { return _open; };
+    const char * data() const { return _data; };
+    size_t size() const { return _size; };
+};
+
+}
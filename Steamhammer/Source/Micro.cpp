@@ -2,6 +2,7 @@
 #include "Base.h"
 #include "InformationManager.h"
 #include "MapGrid.h"
+#include "Profiler.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -279,6 +280,8 @@ const int dotRadius = 2;
 // that units do what they have been ordered to.
 void Micro::update()
 {
+    ProfileZone zone("Micro::update");
+
     for (auto it = orders.begin(); it != orders.end(); )
     {
         BWAPI::Unit u = (*it).first;
@@ -319,13 +322,6 @@ bool Micro::alwaysKite(BWAPI::UnitType type) const
         type == BWAPI::UnitTypes::Zerg_Guardian;
 }
 
-// Is the distance inside the target distance?
-bool Micro::distanceIs(int x, int y, const GridDistances * distances, int target) const
-{
-    BWAPI::TilePosition xy(x, y);
-    return xy.isValid() && distances->at(xy) < target && distances->at(xy) >= 0;
-}
-
 // If the distances are given and we can get there from here, return a nearby position on a good path.
 // In any other case, return the ultimate destination.
 BWAPI::Position Micro::nextGroundDestination(BWAPI::Unit unit, const BWAPI::Position & destination, const GridDistances * distances) const
@@ -335,54 +331,13 @@ BWAPI::Position Micro::nextGroundDestination(BWAPI::Unit unit, const BWAPI::Posi
         return destination;
     }
 
-    const int StepSize = 8;
-    int here = distances->at(unit->getTilePosition());
-    if (here < StepSize)
+    const BWAPI::TilePosition waypoint = distances->getWaypoint(unit->getTilePosition());
+    if (waypoint == unit->getTilePosition())
     {
         // Either we're already very near, or we can't get there. Same answer for both.
-        // NOTE This lets distances be slightluy offset from the true distances without error.
         return destination;
     }
-
-    // Use the distances map to find our next waypoint.
-    // One tile of every StepSize tiles along the path is a waypoint.
-    // When we are halfway between waypoints, we switch to the following one.
-    // In other words, if we're going to X and we're halfway between B and C, we switch from waypoint C to D.
-    const int phase = here % StepSize;
-    const int target = std::max(0, here - phase - (phase > StepSize / 2 ? 0 : StepSize));
-
-    int x = unit->getTilePosition().x;
-    int y = unit->getTilePosition().y;
-    while (here > target)
-    {
-        UAB_ASSERT(BWAPI::TilePosition(x, y).isValid(), "bad tile %d,%d", x, y);
-        UAB_ASSERT(distances->at(BWAPI::TilePosition(x, y)) >= 0, "inaccessible tile %d,%d", x, y);
-
-        // Unroll the loop by hand.
-        // Check diagonals first, so that we prefer to move diagonally when it's shortest.
-             if (distanceIs(x-1, y-1, distances, here)) { x = x-1; y = y-1; }
-        else if (distanceIs(x+1, y-1, distances, here)) { x = x+1; y = y-1; }
-        else if (distanceIs(x+1, y+1, distances, here)) { x = x+1; y = y+1; }
-        else if (distanceIs(x-1, y+1, distances, here)) { x = x-1; y = y+1; }
-        // Then check the orthogonal directions.
-        else if (distanceIs(x-1, y  , distances, here)) { x = x-1; y = y  ; }
-        else if (distanceIs(x+1, y  , distances, here)) { x = x+1; y = y  ; }
-        else if (distanceIs(x  , y-1, distances, here)) { x = x  ; y = y-1; }
-        else if (distanceIs(x  , y+1, distances, here)) { x = x  ; y = y+1; }
-        else
-        {
-            // We failed to find a way to advance. That should not happen.
-            UAB_ASSERT(false, "can't go from %d,%d", x, y);
-            break;
-        }
-
-        here = distances->at(BWAPI::TilePosition(x, y));        // closer by 1 or 2 tiles
-    }
-
-    UAB_ASSERT(BWAPI::TilePosition(x, y).isValid(), "bad tile %d,%d", x, y);
-    UAB_ASSERT(distances->at(BWAPI::TilePosition(x, y)) >= 0, "inaccessible tile %d,%d", x, y);
-
-    return TileCenter(BWAPI::TilePosition(x, y));
+    return TileCenter(waypoint);
 }
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
@@ -549,9 +504,23 @@ bool Micro::kiteBack(BWAPI::Unit unit, BWAPI::Unit enemy)
     return false;
 }
 
+// A ground unit flees to the nearest walkable tile on its own side of any cliff or water,
+// so that it does not run into a wall.
 BWAPI::Position Micro::fleeTo(BWAPI::Unit unit, const BWAPI::Position & danger, int distance) const
 {
-    return DistanceAndDirection(unit->getPosition(), danger, -distance);
+    const BWAPI::Position destination = DistanceAndDirection(unit->getPosition(), danger, -distance);
+    if (unit->isFlying())
+    {
+        return destination;
+    }
+
+    const BWAPI::TilePosition tile(destination);
+    const BWAPI::TilePosition walkable = the.nearest.walkable(tile, the.partitions.id(unit->getPosition()));
+    if (!walkable.isValid() || walkable == tile)
+    {
+        return destination;
+    }
+    return TileCenter(walkable);
 }
 
 void Micro::fleePosition(BWAPI::Unit unit, const BWAPI::Position & danger, int distance)
@@ -882,7 +851,15 @@ bool Micro::MoveSafely(BWAPI::Unit unit, const BWAPI::Position & targetPosition,
         return true;
     }
 
-    MoveNear(unit, targetPosition, distances);
+    if (unit->isFlying())
+    {
+        // Go around enemy static air defense. If none is in the way, this is a plain MoveNear().
+        MoveNear(unit, the.safeAirPaths.nextDestination(unit, targetPosition));
+    }
+    else
+    {
+        MoveNear(unit, targetPosition, distances);
+    }
     return false;
 }
 
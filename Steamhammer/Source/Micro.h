@@ -69,7 +69,6 @@ class Micro
 
     bool alwaysKite(BWAPI::UnitType type) const;
 
-    bool distanceIs(int x, int y, const GridDistances * distances, int target) const;
     BWAPI::Position nextGroundDestination(BWAPI::Unit unit, const BWAPI::Position & destination, const GridDistances * distances) const;
 
 public:
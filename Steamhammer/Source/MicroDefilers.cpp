@@ -147,13 +147,13 @@ bool MicroDefilers::maybeSwarm(BWAPI::Unit defiler)
     // NOTE A carrier does not have a ground weapon, but its interceptors do. Swarm under interceptors.
     // If the defiler is about to die, swarm may still be worth it even if it covers nothing.
     if (!dying &&
-        BWAPI::Broodwar->getUnitsInRadius(defiler->getPosition(), limit * 32,
+        !the.unitIndex.anyUnitInRadius(defiler->getPosition(), limit * 32,
         BWAPI::Filter::IsEnemy && (BWAPI::Filter::IsBuilding ||
                                    BWAPI::Filter::IsFlyer && BWAPI::Filter::GroundWeapon != BWAPI::WeaponTypes::None ||
                                    BWAPI::Filter::GetType == BWAPI::UnitTypes::Terran_Marine ||
                                    BWAPI::Filter::GetType == BWAPI::UnitTypes::Protoss_Dragoon ||
                                    BWAPI::Filter::GetType == BWAPI::UnitTypes::Zerg_Hydralisk)
-                                   ).empty())
+                                   ))
     {
         return false;
     }
@@ -290,7 +290,7 @@ bool MicroDefilers::maybePlague(BWAPI::Unit defiler)
     const bool dying = aboutToDie(defiler);
 
     // Don't bother to look for units to plague if no enemy is close enough.
-    BWAPI::Unit closest = BWAPI::Broodwar->getClosestUnit(defiler->getPosition(),
+    BWAPI::Unit closest = the.unitIndex.getClosestUnit(defiler->getPosition(),
         BWAPI::Filter::IsEnemy && !BWAPI::Filter::IsBurrowed,
         limit * 32);
 
@@ -3,6 +3,7 @@
 #include "InformationManager.h"
 #include "MapGrid.h"
 #include "MapTools.h"
+#include "Profiler.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -46,7 +47,8 @@ bool CasterState::waitToCast() const
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
 MicroManager::MicroManager()
-    : order(nullptr)
+    : _profileName("MicroManager::execute")
+    , order(nullptr)
 {
 }
 
@@ -60,8 +62,16 @@ void MicroManager::setOrder(const SquadOrder & inputOrder)
     order = &inputOrder;
 }
 
+// Name the profiler zone after the squad and the kind of micro, so each shows up separately.
+void MicroManager::setProfileName(const std::string & name)
+{
+    _profileName = Profiler::Name(name);
+}
+
 void MicroManager::execute(const UnitCluster & cluster)
 {
+    ProfileZone zone(_profileName);
+
     // Nothing to do if we have no units.
     if (_units.empty())
     {
@@ -303,7 +313,7 @@ void MicroManager::regroup(const BWAPI::Position & regroupPosition, const UnitCl
                 (BWAPI::Broodwar->self()->deadUnitCount(BWAPI::UnitTypes::Protoss_Dark_Templar) == 0 || !UnitUtil::EnemyDetectorInRange(unit)) ||
             (BWAPI::Broodwar->enemy()->getRace() == BWAPI::Races::Terran &&
             !unit->isFlying() &&
-            BWAPI::Broodwar->getClosestUnit(unit->getPosition(),
+            the.unitIndex.getClosestUnit(unit->getPosition(),
                 BWAPI::Filter::IsEnemy &&
                     (BWAPI::Filter::GetType == BWAPI::UnitTypes::Terran_Siege_Tank_Siege_Mode ||
                     BWAPI::Filter::CurrentOrder == BWAPI::Orders::Sieging ||
@@ -337,14 +347,16 @@ void MicroManager::regroup(const BWAPI::Position & regroupPosition, const UnitCl
             }
             if (!mustFight && unit->isUnderDarkSwarm())
             {
-                BWAPI::Unitset enemies = BWAPI::Broodwar->getUnitsInRadius(
+                std::vector<BWAPI::Unit> nearbyEnemies;
+                the.unitIndex.getUnitsInRadius(
+                    nearbyEnemies,
                     unit->getPosition(),
                     the.info.enemyHasSiegeMode() ? 12 * 32 : 8 * 32,
                     BWAPI::Filter::IsEnemy && !BWAPI::Filter::IsFlyer
                 );
                 // If no enemy can hit us under dark swarm, then stay there.
                 // If there are no enemies near at all, mustFight remains false and we regroup. Should be rare.
-                for (BWAPI::Unit enemy : enemies)
+                for (BWAPI::Unit enemy : nearbyEnemies)
                 {
                     mustFight = true;       // until proven otherwise
                     if (UnitUtil::HitsUnderSwarm(enemy))
@@ -381,7 +393,7 @@ void MicroManager::regroup(const BWAPI::Position & regroupPosition, const UnitCl
         {
             // Scourge away from the retreat point.
             // If the scourge is next to an enemy, attack anyway.
-            BWAPI::Unit target = BWAPI::Broodwar->getClosestUnit(
+            BWAPI::Unit target = the.unitIndex.getClosestUnit(
                 unit->getPosition(),
                 BWAPI::Filter::IsEnemy && BWAPI::Filter::IsFlying && !BWAPI::Filter::IsBuilding && BWAPI::Filter::IsDetected,
                 64
@@ -687,7 +699,7 @@ bool MicroManager::infestable(BWAPI::Unit target) const
     return
         target->getType() == BWAPI::UnitTypes::Terran_Command_Center &&
         target->getHitPoints() < 750 &&
-        BWAPI::Broodwar->getClosestUnit(
+        the.unitIndex.getClosestUnit(
             target->getPosition(),
             BWAPI::Filter::GetType == BWAPI::UnitTypes::Zerg_Queen && BWAPI::Filter::IsOwned,
             10 * 32
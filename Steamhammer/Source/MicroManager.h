@@ -43,9 +43,13 @@ class MicroManager
 {
     BWAPI::Unitset						_units;
     std::map<BWAPI::Unit, CasterState>	_casterState;
+    const char *                        _profileName;   // for the profiler zone
 
 protected:
 
+    // Reusable result buffer for the.unitIndex queries.
+    std::vector<BWAPI::Unit>			_nearbyUnits;
+
     virtual void	executeMicro(const BWAPI::Unitset & targets, const UnitCluster & cluster) = 0;
     int             getBackstopAttackPriority(BWAPI::Unit target) const;
 
@@ -81,6 +85,7 @@ public:
 
     void				setUnits(const BWAPI::Unitset & u);
     void				setOrder(const SquadOrder & inputOrder);
+    void                setProfileName(const std::string & name);
     void				execute(const UnitCluster & cluster);
     void				regroup(const BWAPI::Position & regroupPosition, const UnitCluster & cluster) const;
 
@@ -3,6 +3,7 @@
 
 #include "Bases.h"
 #include "InformationManager.h"
+#include "TargetBatch.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -46,6 +47,16 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::U
         underThreat = anyUnderThreat(meleeUnits);
     }
 
+    // Per-target features, computed once for all the melee units.
+    // Melee units do not spread their attacks to avoid overkill; switching targets costs them too much.
+    TargetBatch batch(meleeUnitTargets, order->getPosition(),
+        [this](BWAPI::UnitType attackerType, BWAPI::Unit target, bool outsideThreat)
+        {
+            return getAttackPriority(attackerType, target, outsideThreat);
+        },
+        32, false);
+    std::vector<TargetInfo *> candidates;
+
     for (BWAPI::Unit meleeUnit : meleeUnits)
     {
         // Try to avoid being hit by an undetected enemy dark templar.
@@ -76,10 +87,13 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::U
             }
             else
             {
-                BWAPI::Unit target = getTarget(meleeUnit, meleeUnitTargets, underThreat);
+                AttackerInfo attacker(meleeUnit, order->getPosition());
+                batch.candidates(meleeUnit, 13 * 32, candidates);
+                TargetInfo * target = getTarget(attacker, batch, candidates, underThreat);
                 if (target)
                 {
-                    the.micro.CatchAndAttackUnit(meleeUnit, target);
+                    batch.assign(attacker, *target);
+                    the.micro.CatchAndAttackUnit(meleeUnit, target->unit);
                 }
                 else if (meleeUnit->getDistance(order->getPosition()) > 96)
                 {
@@ -97,19 +111,20 @@ void MicroMelee::assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::U
     }
 }
 
-// Choose a target from the set.
+// Choose a target from the candidates, the targets near the melee unit.
 // underThreat is true if any of the melee units is under immediate threat of attack.
-BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset & targets, bool underThreat)
+TargetInfo * MicroMelee::getTarget(const AttackerInfo & attacker, TargetBatch & batch, const std::vector<TargetInfo *> & candidates, bool underThreat)
 {
+    BWAPI::Unit meleeUnit = attacker.unit;
+
     int bestScore = INT_MIN;
-    BWAPI::Unit bestTarget = nullptr;
+    TargetInfo * bestTarget = nullptr;
 
-    for (const auto target : targets)
+    for (TargetInfo * targetInfo : candidates)
     {
-        const int priority = getAttackPriority(meleeUnit, target);		// 0..12
-        const int range = meleeUnit->getDistance(target);				// 0..map size in pixels
-        const int closerToGoal =										// positive if target is closer than us to the goal
-            meleeUnit->getDistance(order->getPosition()) - target->getDistance(order->getPosition());
+        const TargetInfo & target = *targetInfo;
+
+        const int range = meleeUnit->getDistance(target.unit);			// 0..map size in pixels
 
         // Skip targets that are too far away to worry about.
         if (range >= 13 * 32)
@@ -117,6 +132,10 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
             continue;
         }
 
+        const int priority = batch.priority(attacker, target, range);	// 0..12
+        const int closerToGoal =										// positive if target is closer than us to the goal
+            attacker.distanceToGoal - target.distanceToGoal;
+
         // TODO disabled - seems to be wrong, skips targets it should not
         // Don't chase targets that we can't catch.
         //if (!CanCatchUnit(meleeUnit, target))
@@ -132,9 +151,9 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
 
         // Prefer targets under dark swarm, on the expectation that then we'll be under it too.
         // It doesn't matter whether the target is a building.
-        if (target->isUnderDarkSwarm())
+        if (target.underDarkSwarm)
         {
-            if (meleeUnit->getType().isWorker())
+            if (attacker.type.isWorker())
             {
                 // Workers can't hit under dark swarm. Skip this target.
                 continue;
@@ -142,7 +161,7 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
             score += 4 * 32;
         }
 
-        if (target->isUnderStorm())
+        if (target.underStorm)
         {
             score -= 6 * 32;
         }
@@ -150,12 +169,12 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
         if (!underThreat)
         {
             // We're not under threat. Prefer to attack stuff outside enemy static defense range.
-            if (!the.groundAttacks.inRange(target))
+            if (!target.inGroundAttacks)
             {
                 score += 2 * 32;
             }
             // Also prefer to attack stuff that can't shoot back.
-            if (!UnitUtil::CanAttackGround(target))
+            if (!target.canAttackGround)
             {
                 score += 2 * 32;
             }
@@ -169,9 +188,9 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
         }
 
         // This could adjust for relative speed and direction, so that we don't chase what we can't catch.
-        if (meleeUnit->isInWeaponRange(target))
+        if (meleeUnit->isInWeaponRange(target.unit))
         {
-            if (meleeUnit->getType() == BWAPI::UnitTypes::Zerg_Ultralisk)
+            if (attacker.type == BWAPI::UnitTypes::Zerg_Ultralisk)
             {
                 score += 12 * 32;   // because they're big and awkward
             }
@@ -180,11 +199,9 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
                 score += 4 * 32;
             }
         }
-        else if (!target->isMoving())
+        else if (!target.moving)
         {
-            if (target->isSieged() ||
-                target->getOrder() == BWAPI::Orders::Sieging ||
-                target->getOrder() == BWAPI::Orders::Unsieging)
+            if (target.sieging)
             {
                 score += 48;
             }
@@ -193,21 +210,21 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
                 score += 32;
             }
         }
-        else if (target->isBraking())
+        else if (target.braking)
         {
             score += 16;
         }
-        else if (target->getPlayer()->topSpeed(target->getType()) >= meleeUnit->getPlayer()->topSpeed(meleeUnit->getType()))
+        else if (target.topSpeed >= attacker.topSpeed)
         {
             score -= 2 * 32;
         }
 
         // Prefer targets that are already hurt.
-        if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() == 0)
+        if (target.noShields)
         {
             score += 32;
         }
-        else if (target->getHitPoints() < target->getType().maxHitPoints())
+        else if (target.hurt)
         {
             score += 24;
         }
@@ -215,14 +232,16 @@ BWAPI::Unit MicroMelee::getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset &
         if (score > bestScore)
         {
             bestScore = score;
-            bestTarget = target;
+            bestTarget = targetInfo;
         }
     }
 
     return bestTarget;
 }
 
-int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) const
+// outsideThreat is true if the attacker is more than a tile outside the target's attack range.
+// The priority depends only on the attacker's type and outsideThreat, so TargetBatch can cache it.
+int MicroMelee::getAttackPriority(BWAPI::UnitType attackerType, BWAPI::Unit target, bool outsideThreat) const
 {
     BWAPI::UnitType targetType = target->getType();
 
@@ -235,7 +254,7 @@ int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) cons
     }
 
     // Exceptions for dark templar.
-    if (attacker->getType() == BWAPI::UnitTypes::Protoss_Dark_Templar)
+    if (attackerType == BWAPI::UnitTypes::Protoss_Dark_Templar)
     {
         if (targetType == BWAPI::UnitTypes::Terran_Vulture_Spider_Mine)
         {
@@ -257,10 +276,10 @@ int MicroMelee::getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit target) cons
     }
 
     // Short circuit: Enemy unit which is far enough outside its range is lower priority than a worker.
-    int enemyRange = UnitUtil::GetAttackRange(target, attacker);
-    if (enemyRange &&
-        !targetType.isWorker() &&
-        attacker->getDistance(target) > 32 + enemyRange)
+    // Melee units are on the ground, so the enemy has a range against us if it can attack ground.
+    if (outsideThreat &&
+        UnitUtil::CanAttackGround(target) &&
+        !targetType.isWorker())
     {
         return 8;
     }
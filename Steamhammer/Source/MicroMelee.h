@@ -3,6 +3,9 @@
 namespace UAlbertaBot
 {
 class MicroManager;
+struct AttackerInfo;
+struct TargetInfo;
+class TargetBatch;
 
 class MicroMelee : public MicroManager
 {
@@ -14,8 +17,8 @@ public:
     void executeMicro(const BWAPI::Unitset & targets, const UnitCluster & cluster);
     void assignTargets(const BWAPI::Unitset & meleeUnits, const BWAPI::Unitset & targets);
 
-    int getAttackPriority(BWAPI::Unit attacker, BWAPI::Unit unit) const;
-    BWAPI::Unit getTarget(BWAPI::Unit meleeUnit, const BWAPI::Unitset & targets, bool underThreat);
+    int getAttackPriority(BWAPI::UnitType attackerType, BWAPI::Unit target, bool outsideThreat) const;
+    TargetInfo * getTarget(const AttackerInfo & attacker, TargetBatch & batch, const std::vector<TargetInfo *> & candidates, bool underThreat);
     bool meleeUnitShouldRetreat(BWAPI::Unit meleeUnit, const BWAPI::Unitset & targets);
 };
 }
\ No newline at end of file
@@ -86,11 +86,11 @@ bool MicroQueens::maybeParasite(BWAPI::Unit queen, int minScore)
     // Parasite has range 12. We look for targets within the limit range.
     const int limit = 12 + 2;
 
-    BWAPI::Unitset targets = BWAPI::Broodwar->getUnitsInRadius(queen->getPosition(), limit * 32,
+    the.unitIndex.getUnitsInRadius(_nearbyUnits, queen->getPosition(), limit * 32,
         !BWAPI::Filter::IsBuilding && (BWAPI::Filter::IsEnemy || BWAPI::Filter::IsCritter) &&
         !BWAPI::Filter::IsInvincible && !BWAPI::Filter::IsParasited);
 
-    if (targets.empty())
+    if (_nearbyUnits.empty())
     {
         return false;
     }
@@ -99,7 +99,7 @@ bool MicroQueens::maybeParasite(BWAPI::Unit queen, int minScore)
     const bool dying = aboutToDie(queen);
     int bestScore = dying ? 0 : minScore - 1;
     BWAPI::Unit bestTarget = nullptr;
-    for (BWAPI::Unit target : targets)
+    for (BWAPI::Unit target : _nearbyUnits)
     {
         int score = parasiteScore(target);
         if (score > bestScore)
@@ -213,7 +213,7 @@ bool MicroQueens::maybeEnsnare(BWAPI::Unit queen)
     const bool dying = aboutToDie(queen);
 
     // Don't bother to look for units to ensnare if no enemy is close enough.
-    BWAPI::Unit closest = BWAPI::Broodwar->getClosestUnit(queen->getPosition(),
+    BWAPI::Unit closest = the.unitIndex.getClosestUnit(queen->getPosition(),
         BWAPI::Filter::IsEnemy && !BWAPI::Filter::IsBuilding,
         limit * 32);
 
@@ -339,7 +339,7 @@ bool MicroQueens::maybeBroodling(BWAPI::Unit queen)
     // Ignore the possibility that you may want to broodling a non-enemy unit.
     // E.g., a neutral critter, so the broodlings can scout or tear down an unattended building.
     // Or maybe your own larva, say for your defiler to consume.
-    BWAPI::Unitset targets = BWAPI::Broodwar->getUnitsInRadius(queen->getPosition(), limit * 32,
+    the.unitIndex.getUnitsInRadius(_nearbyUnits, queen->getPosition(), limit * 32,
         BWAPI::Filter::IsEnemy && !BWAPI::Filter::IsBuilding && !BWAPI::Filter::IsFlyer &&
         !BWAPI::Filter::IsRobotic &&            // not probe or reaver
         BWAPI::Filter::GetType != BWAPI::UnitTypes::Protoss_Archon &&
@@ -347,7 +347,7 @@ bool MicroQueens::maybeBroodling(BWAPI::Unit queen)
         BWAPI::Filter::IsDetected &&
         !BWAPI::Filter::IsInvincible);
 
-    if (targets.empty())
+    if (_nearbyUnits.empty())
     {
         return false;
     }
@@ -355,7 +355,7 @@ bool MicroQueens::maybeBroodling(BWAPI::Unit queen)
     // Look for the target with the best score.
     int bestScore = 0;
     BWAPI::Unit bestTarget = nullptr;
-    for (BWAPI::Unit target : targets)
+    for (BWAPI::Unit target : _nearbyUnits)
     {
         int score = broodlingScore(queen, target);
         if (score > bestScore)
@@ -405,7 +405,7 @@ BWAPI::Position MicroQueens::getQueenDestination(BWAPI::Unit queen, const BWAPI:
             }
         }
 
-        BWAPI::Unit danger = BWAPI::Broodwar->getClosestUnit(queen->getPosition(),
+        BWAPI::Unit danger = the.unitIndex.getClosestUnit(queen->getPosition(),
             BWAPI::Filter::IsEnemy &&
             (BWAPI::Filter::AirWeapon != BWAPI::WeaponTypes::None ||
             BWAPI::Filter::GetType == BWAPI::UnitTypes::Terran_Science_Vessel ||
@@ -2,6 +2,7 @@
 
 #include "Bases.h"
 #include "InformationManager.h"
+#include "TargetBatch.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -67,6 +68,15 @@ void MicroRanged::assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI:
     // Are any enemies in range to shoot at the ranged units?
     bool underThreat = order->isCombatOrder() && anyUnderThreat(rangedUnits);
 
+    // Per-target features, computed once for all the ranged units.
+    TargetBatch batch(rangedUnitTargets, order->getPosition(),
+        [this](BWAPI::UnitType rangedType, BWAPI::Unit target, bool outsideThreat)
+        {
+            return getAttackPriority(rangedType, target, outsideThreat);
+        },
+        48, Config::Micro::LimitOverkill);
+    std::vector<TargetInfo *> candidates;
+
     for (BWAPI::Unit rangedUnit : rangedUnits)
     {
         if (rangedUnit->isBurrowed())
@@ -96,9 +106,14 @@ void MicroRanged::assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI:
 
         if (order->isCombatOrder())
         {
-            BWAPI::Unit target = getTarget(rangedUnit, rangedUnitTargets, underThreat);
-            if (target)
+            AttackerInfo attacker(rangedUnit, order->getPosition());
+            batch.candidates(rangedUnit, 13 * 32, candidates);
+            TargetInfo * targetInfo = getTarget(attacker, batch, candidates, underThreat);
+            if (targetInfo)
             {
+                BWAPI::Unit target = targetInfo->unit;
+                batch.assign(attacker, *targetInfo);
+
                 if (Config::Debug::DrawUnitTargets)
                 {
                     BWAPI::Broodwar->drawLineMap(rangedUnit->getPosition(), rangedUnit->getTargetPosition(), BWAPI::Colors::Purple);
@@ -128,30 +143,36 @@ void MicroRanged::assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI:
 
 // This can return null if no target is worth attacking.
 // underThreat is true if any of the melee units is under immediate threat of attack.
-BWAPI::Unit MicroRanged::getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets, bool underThreat)
+// The candidates are the targets near the ranged unit, from the batch.
+TargetInfo * MicroRanged::getTarget(const AttackerInfo & attacker, TargetBatch & batch, const std::vector<TargetInfo *> & candidates, bool underThreat)
 {
+    BWAPI::Unit rangedUnit = attacker.unit;
+
     int bestScore = INT_MIN;
-    BWAPI::Unit bestTarget = nullptr;
+    TargetInfo * bestTarget = nullptr;
 
-    for (BWAPI::Unit target : targets)
+    for (TargetInfo * targetInfo : candidates)
     {
+        const TargetInfo & target = *targetInfo;
+
         // Skip targets under dark swarm that we can't hit.
-        if (target->isUnderDarkSwarm() && !target->getType().isBuilding() && !goodUnderDarkSwarm(rangedUnit->getType()))
+        if (target.underDarkSwarm && !target.type.isBuilding() && !goodUnderDarkSwarm(attacker.type))
         {
             continue;
         }
 
-        const int priority = getAttackPriority(rangedUnit, target);		// 0..12
-        const int range = rangedUnit->getDistance(target);				// 0..map diameter in pixels
-        const int closerToGoal =										// positive if target is closer than us to the goal
-            rangedUnit->getDistance(order->getPosition()) - target->getDistance(order->getPosition());
-        
+        const int range = rangedUnit->getDistance(target.unit);			// 0..map diameter in pixels
+
         // Skip targets that are too far away to worry about--outside tank range.
         if (range >= 13 * 32)
         {
             continue;
         }
 
+        const int priority = batch.priority(attacker, target, range);	// 0..12
+        const int closerToGoal =										// positive if target is closer than us to the goal
+            attacker.distanceToGoal - target.distanceToGoal;
+
         // TODO disabled - seems to be wrong, skips targets it should not
         // Don't chase targets that we can't catch.
         //if (!CanCatchUnit(meleeUnit, target))
@@ -174,14 +195,14 @@ BWAPI::Unit MicroRanged::getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset
         if (!underThreat)
         {
             // We're not under threat. Prefer to attack stuff outside enemy static defense range.
-            if (rangedUnit->isFlying() ? !the.airAttacks.inRange(target) : !the.groundAttacks.inRange(target))
+            if (attacker.flying ? !target.inAirAttacks : !target.inGroundAttacks)
             {
                 score += 4 * 32;
             }
         }
 
-        const bool isThreat = UnitUtil::CanAttack(target, rangedUnit);   // may include workers as threats
-        const bool canShootBack = isThreat && range <= 32 + UnitUtil::GetAttackRange(target, rangedUnit);
+        const bool isThreat = attacker.flying ? target.canAttackAir : target.canAttackGround;   // may include workers as threats
+        const bool canShootBack = isThreat && range <= 32 + UnitUtil::GetAttackRange(target.unit, rangedUnit);
 
         if (isThreat)
         {
@@ -189,21 +210,14 @@ BWAPI::Unit MicroRanged::getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset
             {
                 score += 7 * 32;
             }
-            else if (rangedUnit->isInWeaponRange(target))
-            {
-                score += 5 * 32;
-            }
             else
             {
                 score += 5 * 32;
             }
         }
-        else if (!target->isMoving())
+        else if (!target.moving)
         {
-            if (target->isSieged() ||
-                target->getOrder() == BWAPI::Orders::Sieging ||
-                target->getOrder() == BWAPI::Orders::Unsieging ||
-                target->isBurrowed())
+            if (target.sieging || target.burrowed)
             {
                 score += 48;
             }
@@ -212,64 +226,71 @@ BWAPI::Unit MicroRanged::getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset
                 score += 24;
             }
         }
-        else if (target->isBraking())
+        else if (target.braking)
         {
             score += 16;
         }
-        else if (target->getPlayer()->topSpeed(target->getType()) >= rangedUnit->getPlayer()->topSpeed(rangedUnit->getType()))
+        else if (target.topSpeed >= attacker.topSpeed)
         {
             score -= 4 * 32;
         }
         
         // Prefer targets that are already hurt.
-        if (target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() <= 5)
+        if (target.shieldsDown)
         {
             score += 32;
         }
-        if (target->getHitPoints() < target->getType().maxHitPoints())
+        if (target.hurt)
         {
             score += 24;
         }
 
         // Prefer to hit air units that have acid spores on them from devourers.
-        if (target->getAcidSporeCount() > 0)
+        if (target.acidSpores > 0)
         {
             // Especially if we're a mutalisk with a bounce attack.
-            if (rangedUnit->getType() == BWAPI::UnitTypes::Zerg_Mutalisk)
+            if (attacker.type == BWAPI::UnitTypes::Zerg_Mutalisk)
             {
-                score += 16 * target->getAcidSporeCount();
+                score += 16 * target.acidSpores;
             }
             else
             {
-                score += 8 * target->getAcidSporeCount();
+                score += 8 * target.acidSpores;
             }
         }
 
         // Take the damage type into account.
-        BWAPI::DamageType damage = UnitUtil::GetWeapon(rangedUnit, target).damageType();
+        BWAPI::DamageType damage = UnitUtil::GetWeapon(attacker.type, target.unit).damageType();
         if (damage == BWAPI::DamageTypes::Explosive)
         {
-            if (target->getType().size() == BWAPI::UnitSizeTypes::Large)
+            if (target.type.size() == BWAPI::UnitSizeTypes::Large)
             {
                 score += 48;
             }
         }
         else if (damage == BWAPI::DamageTypes::Concussive)
         {
-            if (target->getType().size() == BWAPI::UnitSizeTypes::Small)
+            if (target.type.size() == BWAPI::UnitSizeTypes::Small)
             {
                 score += 48;
             }
-            else if (target->getType().size() == BWAPI::UnitSizeTypes::Large)
+            else if (target.type.size() == BWAPI::UnitSizeTypes::Large)
             {
                 score -= 48;
             }
         }
 
+        // Avoid overkill: If other units are already shooting enough to kill the target,
+        // prefer something else. Keep shooting if we were already on it.
+        if (target.overkilled() && rangedUnit->getOrderTarget() != target.unit)
+        {
+            score -= 3 * 32;
+        }
+
         if (score > bestScore)
         {
             bestScore = score;
-            bestTarget = target;
+            bestTarget = targetInfo;
         }
     }
 
@@ -277,9 +298,10 @@ BWAPI::Unit MicroRanged::getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset
 }
 
 // How much do we want to attack this enenmy target?
-int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target) 
+// outsideThreat is true if we are well outside the target's attack range.
+// The priority depends only on our unit type and outsideThreat, so TargetBatch can cache it.
+int MicroRanged::getAttackPriority(BWAPI::UnitType rangedType, BWAPI::Unit target, bool outsideThreat)
 {
-    const BWAPI::UnitType rangedType = rangedUnit->getType();
     const BWAPI::UnitType targetType = target->getType();
 
     if (rangedType == BWAPI::UnitTypes::Zerg_Guardian && target->isFlying())
@@ -388,7 +410,7 @@ int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target)
     if (UnitUtil::CanAttack(targetType, rangedType) && !targetType.isWorker())
     {
         // Enemy unit which is far enough outside its range is lower priority than a worker.
-        if (rangedUnit->getDistance(target) > 48 + UnitUtil::GetAttackRange(target, rangedUnit))
+        if (outsideThreat)
         {
             return 8;
         }
@@ -419,7 +441,7 @@ int MicroRanged::getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target)
     // Next are workers.
     if (targetType.isWorker()) 
     {
-        if (rangedUnit->getType() == BWAPI::UnitTypes::Terran_Vulture)
+        if (rangedType == BWAPI::UnitTypes::Terran_Vulture)
         {
             return 11;
         }
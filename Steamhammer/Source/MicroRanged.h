@@ -4,6 +4,10 @@
 
 namespace UAlbertaBot
 {
+struct AttackerInfo;
+struct TargetInfo;
+class TargetBatch;
+
 class MicroRanged : public MicroManager
 {
 private:
@@ -18,8 +22,8 @@ public:
     void executeMicro(const BWAPI::Unitset & targets, const UnitCluster & cluster);
     void assignTargets(const BWAPI::Unitset & rangedUnits, const BWAPI::Unitset & targets);
 
-    int getAttackPriority(BWAPI::Unit rangedUnit, BWAPI::Unit target);
-    BWAPI::Unit getTarget(BWAPI::Unit rangedUnit, const BWAPI::Unitset & targets, bool underThreat);
+    int getAttackPriority(BWAPI::UnitType rangedType, BWAPI::Unit target, bool outsideThreat);
+    TargetInfo * getTarget(const AttackerInfo & attacker, TargetBatch & batch, const std::vector<TargetInfo *> & candidates, bool underThreat);
 
     bool stayHomeUntilReady(const BWAPI::Unit u) const;
 };
@@ -0,0 +1,107 @@
+#include "NearestTiles.h"
+
+#include "Bases.h"
+#include "GridBuildable.h"
+#include "The.h"
+
+using namespace UAlbertaBot;
+
+namespace
+{
+    const size_t LegalActions = 4;
+    const int actionX[LegalActions] = { 1, -1, 0, 0 };
+    const int actionY[LegalActions] = { 0, 0, 1, -1 };
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+NearestTiles::NearestTiles()
+    : tileWidth(0)
+    , tileHeight(0)
+{
+}
+
+// Search outward from the goal tiles over the whole map, so that each goal tile is its own
+// nearest. Each tile reached takes the nearest goal of the tile it was reached from.
+// The search ignores terrain, so "nearest" is by Manhattan distance.
+template <class IsGoal>
+void NearestTiles::search(std::vector<int> & nearest, IsGoal isGoal) const
+{
+    nearest.assign(size_t(tileWidth) * tileHeight, -1);
+
+    std::vector<int> queue;
+    queue.reserve(nearest.size());
+    for (int y = 0; y < tileHeight; ++y)
+    {
+        for (int x = 0; x < tileWidth; ++x)
+        {
+            if (isGoal(x, y))
+            {
+                nearest[x + y * tileWidth] = x + y * tileWidth;
+                queue.push_back(x + y * tileWidth);
+            }
+        }
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        const int i = queue[head];
+        const int x = i % tileWidth;
+        const int y = i / tileWidth;
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const int nx = x + actionX[a];
+            const int ny = y + actionY[a];
+            if (nx >= 0 && ny >= 0 && nx < tileWidth && ny < tileHeight &&
+                nearest[nx + ny * tileWidth] < 0)
+            {
+                nearest[nx + ny * tileWidth] = nearest[i];
+                queue.push_back(nx + ny * tileWidth);
+            }
+        }
+    }
+}
+
+void NearestTiles::initialize()
+{
+    tileWidth = BWAPI::Broodwar->mapWidth();
+    tileHeight = BWAPI::Broodwar->mapHeight();
+    search(walkableTile, [](int x, int y) { return the.map.isWalkable(BWAPI::TilePosition(x, y)); });
+    connectedBuildableTile.clear();
+}
+
+// The goals are the tiles at even x and y that are buildable and connected to our start.
+// Every building is at least 2x2, so a building placer that starts from one of those
+// tiles covers the whole buildable area.
+void NearestTiles::initializeConnectedBuildable(const GridBuildable & buildable)
+{
+    search(connectedBuildableTile, [&buildable](int x, int y)
+    {
+        return x % 2 == 0 && y % 2 == 0 &&
+            buildable.at(x, y) > 0 &&
+            the.bases.connectedToStart(BWAPI::TilePosition(x, y));
+    });
+}
+
+BWAPI::TilePosition NearestTiles::walkable(const BWAPI::TilePosition & tile, int partition) const
+{
+    if (!tile.isValid() || walkableTile[tile.x + tile.y * tileWidth] < 0)
+    {
+        return BWAPI::TilePositions::None;
+    }
+
+    const int i = walkableTile[tile.x + tile.y * tileWidth];
+    const BWAPI::TilePosition nearest(i % tileWidth, i / tileWidth);
+    return the.partitions.id(nearest) == partition ? nearest : BWAPI::TilePositions::None;
+}
+
+BWAPI::TilePosition NearestTiles::connectedBuildable(const BWAPI::TilePosition & tile) const
+{
+    if (!tile.isValid() || connectedBuildableTile.empty() || connectedBuildableTile[tile.x + tile.y * tileWidth] < 0)
+    {
+        return BWAPI::TilePositions::None;
+    }
+
+    const int i = connectedBuildableTile[tile.x + tile.y * tileWidth];
+    return BWAPI::TilePosition(i % tileWidth, i / tileWidth);
+}
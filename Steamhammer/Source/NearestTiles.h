@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vector>
+#include "BWAPI.h"
+
+// Lookup tables for "where is the nearest tile of this kind?", computed once at the start
+// of the game so that each answer is O(1). They cover build tiles.
+// 1. The nearest walkable tile by the.map, in any partition.
+// 2. The nearest tile that the building placer may start from, connected to our start.
+
+// A table holds, for each tile, the index x + y * width of its nearest tile of the kind, or -1.
+// It is filled by one breadth-first search outward from all the tiles of the kind at once.
+
+namespace UAlbertaBot
+{
+class GridBuildable;
+
+class NearestTiles
+{
+    int tileWidth;
+    int tileHeight;
+
+    std::vector<int> walkableTile;                  // by rows of build tiles
+    std::vector<int> connectedBuildableTile;        // by rows of build tiles; empty until initialized
+
+    template <class IsGoal>
+    void search(std::vector<int> & nearest, IsGoal isGoal) const;
+
+public:
+    NearestTiles();
+
+    // Depends on the.map.
+    void initialize();
+
+    // Depends on the.bases and the building placer's buildable grid. The building placer calls it.
+    void initializeConnectedBuildable(const GridBuildable & buildable);
+
+    // The nearest tile that the.map says is walkable; the tile itself if it is.
+    // BWAPI::TilePositions::None if that tile is not in the given partition.
+    // Only the single nearest tile is checked, so callers that must get an answer
+    // need a fallback for when it is across a cliff or water.
+    BWAPI::TilePosition walkable(const BWAPI::TilePosition & tile, int partition) const;
+
+    // The nearest tile, by Manhattan distance, at even x and y that is buildable and connected
+    // by ground to our start. BWAPI::TilePositions::None if there is none.
+    BWAPI::TilePosition connectedBuildable(const BWAPI::TilePosition & tile) const;
+};
+
+}
@@ -0,0 +1,226 @@
+#include "OpeningBook.h"
+
+#include <cstring>
+#include <regex>
+
+#include "MacroAct.h"
+#include "MappedFile.h"
+#include "OpponentFile.h"
+#include "ParseUtils.h"
+
+using namespace UAlbertaBot;
+
+namespace
+{
+    void AddInt(std::string & out, uint32_t n)
+    {
+        out.append(reinterpret_cast<const char *>(&n), sizeof(n));
+    }
+
+    void AddString(std::string & out, const std::string & s)
+    {
+        AddInt(out, uint32_t(s.size()));
+        out += s;
+    }
+
+    // Read from a buffer, failing without reading past its end.
+    class BookReader
+    {
+    private:
+        const char * _p;
+        const char * _end;
+
+    public:
+        BookReader(const char * data, size_t size)
+            : _p(data)
+            , _end(data + size)
+        {
+        }
+
+        bool get(void * out, size_t size)
+        {
+            if (size > size_t(_end - _p))
+            {
+                return false;
+            }
+            std::memcpy(out, _p, size);
+            _p += size;
+            return true;
+        }
+
+        bool getInt(uint32_t & n)
+        {
+            return get(&n, sizeof(n));
+        }
+
+        bool getString(std::string & s)
+        {
+            uint32_t length;
+            if (!getInt(length) || length > size_t(_end - _p))
+            {
+                return false;
+            }
+            s.assign(_p, length);
+            _p += length;
+            return true;
+        }
+    };
+}
+
+// FNV-1a, 64 bits.
+uint64_t OpeningBook::Hash(const std::string & configText)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (const char c : configText)
+    {
+        hash ^= uint8_t(c);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+void OpeningBook::compile(const rapidjson::Value & strategies)
+{
+    // You can specify a count, like "6 x mutalisk". The spaces are required.
+    // Mostly useful for units, but "2 x creep colony @ natural" also works.
+    static const std::regex countRegex("([0-9]+)\\s+x\\s+([a-zA-Z_ ]+(\\s+@\\s+[a-zA-Z_ ]+)?)");
+
+    _entries.clear();
+    for (rapidjson::Value::ConstMemberIterator itr = strategies.MemberBegin(); itr != strategies.MemberEnd(); ++itr)
+    {
+        const std::string &		 name = itr->name.GetString();
+        const rapidjson::Value & val = itr->value;
+
+        OpeningBookEntry entry;
+        entry.name = name;
+
+        if (val.HasMember("Race") && val["Race"].IsString())
+        {
+            entry.race = ParseUtils::GetRace(val["Race"].GetString());
+        }
+        else
+        {
+            UAB_ASSERT_WARNING(false, "Strategy must have a Race string. Skipping %s", name.c_str());
+            continue;
+        }
+
+        if (val.HasMember("OpeningGroup") && val["OpeningGroup"].IsString())
+        {
+            entry.openingGroup = val["OpeningGroup"].GetString();
+        }
+
+        if (val.HasMember("OpeningBuildOrder") && val["OpeningBuildOrder"].IsArray())
+        {
+            const rapidjson::Value & build = val["OpeningBuildOrder"];
+
+            for (size_t b(0); b < build.Size(); ++b)
+            {
+                if (build[b].IsString())
+                {
+                    std::string itemName = build[b].GetString();
+
+                    int unitCount = 1;    // the default count
+
+                    std::smatch m;
+                    if (std::regex_match(itemName, m, countRegex)) {
+                        unitCount = GetIntFromString(m[1].str());
+                        itemName = m[2].str();
+                    }
+
+                    // Parse the item only to check that it is valid.
+                    (void) MacroAct(itemName);
+                    entry.items.insert(entry.items.end(), unitCount, itemName);
+                }
+                else
+                {
+                    UAB_ASSERT_WARNING(false, "Build order item must be a string %s", name.c_str());
+                    continue;
+                }
+            }
+        }
+
+        _entries.push_back(entry);
+    }
+}
+
+bool OpeningBook::read(const std::string & filename, uint64_t hash)
+{
+    _entries.clear();
+
+    MappedFile file;
+    if (!file.open(filename) || file.size() < sizeof(uint32_t))
+    {
+        return false;
+    }
+
+    const size_t bodySize = file.size() - sizeof(uint32_t);
+    uint32_t checksum;
+    std::memcpy(&checksum, file.data() + bodySize, sizeof(checksum));
+    if (checksum != OpponentFileFormat::Checksum(file.data(), bodySize))
+    {
+        return false;
+    }
+
+    BookReader in(file.data(), bodySize);
+    uint32_t magic, version, nEntries;
+    uint64_t fileHash;
+    if (!in.getInt(magic) || magic != Magic ||
+        !in.getInt(version) || version != Version ||
+        !in.get(&fileHash, sizeof(fileHash)) || fileHash != hash ||
+        !in.getInt(nEntries))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < nEntries; ++i)
+    {
+        OpeningBookEntry entry;
+        uint32_t race, nItems;
+        if (!in.getString(entry.name) ||
+            !in.getInt(race) ||
+            !in.getString(entry.openingGroup) ||
+            !in.getInt(nItems))
+        {
+            _entries.clear();
+            return false;
+        }
+        entry.race = BWAPI::Race(int(race));
+
+        for (uint32_t j = 0; j < nItems; ++j)
+        {
+            std::string item;
+            if (!in.getString(item))
+            {
+                _entries.clear();
+                return false;
+            }
+            entry.items.push_back(item);
+        }
+        _entries.push_back(entry);
+    }
+
+    return true;
+}
+
+bool OpeningBook::write(const std::string & filename, uint64_t hash) const
+{
+    std::string out;
+    AddInt(out, Magic);
+    AddInt(out, Version);
+    out.append(reinterpret_cast<const char *>(&hash), sizeof(hash));
+    AddInt(out, uint32_t(_entries.size()));
+    for (const OpeningBookEntry & entry : _entries)
+    {
+        AddString(out, entry.name);
+        AddInt(out, uint32_t(entry.race.getID()));
+        AddString(out, entry.openingGroup);
+        AddInt(out, uint32_t(entry.items.size()));
+        for (const std::string & item : entry.items)
+        {
+            AddString(out, item);
+        }
+    }
+    AddInt(out, OpponentFileFormat::Checksum(out.data(), out.size()));
+
+    return OpponentFile::Replace(filename, out);
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <BWAPI.h>
+#include "rapidjson/document.h"
+
+// The openings of the config file, compiled and cached in a binary file.
+// Compiling checks every build order item of every opening, which is slow. The cache
+// is keyed by a hash of the config file text, so any edit to the config recompiles it.
+// With the cache, only the build order of the opening we actually play is parsed into
+// MacroActs, by StrategyManager::expandOpening().
+
+// File layout. Integers are 4-byte little-endian except the hash, which is 8 bytes.
+//   magic, version, config hash, number of openings
+//   openings, each: name, race ID, opening group, number of items, items
+//   checksum of everything before it
+// A string is its length followed by its bytes.
+
+namespace UAlbertaBot
+{
+struct OpeningBookEntry
+{
+    std::string name;
+    BWAPI::Race race;
+    std::string openingGroup;
+    std::vector<std::string> items;         // counts like "3 x zergling" are spelled out
+};
+
+class OpeningBook
+{
+private:
+    static const uint32_t Magic = 0x424f4853;      // "SHOB"
+    static const uint32_t Version = 1;
+
+    std::vector<OpeningBookEntry> _entries;
+
+public:
+    static uint64_t Hash(const std::string & configText);
+
+    // Compile the "Strategies" object of the config file. Bad openings are skipped with a warning.
+    void compile(const rapidjson::Value & strategies);
+
+    // Return false if the file is missing, damaged, or compiled from a different config.
+    bool read(const std::string & filename, uint64_t hash);
+    bool write(const std::string & filename, uint64_t hash) const;
+
+    const std::vector<OpeningBookEntry> & entries() const { return _entries; };
+};
+
+}
@@ -0,0 +1,341 @@
+#include "OpponentFile.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "GameRecord.h"
+#include "PlayerSnapshot.h"
+
+using namespace UAlbertaBot;
+using namespace UAlbertaBot::OpponentFileFormat;
+
+// FNV-1a. Good enough to catch a torn or damaged record.
+uint32_t OpponentFileFormat::Checksum(const char * data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= uint8_t(data[i]);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+GameRecordView::GameRecordView(const char * body, uint32_t size)
+    : _body(body)
+    , _size(size)
+{
+}
+
+bool GameRecordView::inBounds(uint32_t offset, uint32_t length) const
+{
+    return offset <= _size && length <= _size - offset;
+}
+
+bool GameRecordView::isValid() const
+{
+    if (_size < sizeof(RecordFixed))
+    {
+        return false;
+    }
+
+    const RecordFixed & f = fixed();
+    if (f.format[3] != '\0' ||
+        !inBounds(f.mapName.offset, f.mapName.length) ||
+        !inBounds(f.openingName.offset, f.openingName.length) ||
+        !inBounds(f.expectedEnemyPlan.offset, f.expectedEnemyPlan.length) ||
+        !inBounds(f.enemyPlan.offset, f.enemyPlan.length))
+    {
+        return false;
+    }
+
+    if (f.nSkillLines > _size / sizeof(StringRef) ||
+        !inBounds(f.skillLinesOffset, f.nSkillLines * sizeof(StringRef)))
+    {
+        return false;
+    }
+    for (int i = 0; i < skillLineCount(); ++i)
+    {
+        const StringRef & ref = reinterpret_cast<const StringRef *>(_body + f.skillLinesOffset)[i];
+        if (!inBounds(ref.offset, ref.length))
+        {
+            return false;
+        }
+    }
+
+    // Walk the snapshots. Each player snapshot carries its own length.
+    uint32_t offset = f.snapshotsOffset;
+    for (uint32_t s = 0; s < f.nSnapshots; ++s)
+    {
+        if (!inBounds(offset, 4))
+        {
+            return false;
+        }
+        offset += 4;
+        for (int player = 0; player < 2; ++player)
+        {
+            if (!inBounds(offset, 8))
+            {
+                return false;
+            }
+            const int32_t n = reinterpret_cast<const int32_t *>(_body + offset)[1];
+            if (n < 0 || uint32_t(n) > _size / 8 || !inBounds(offset + 8, uint32_t(n) * 8))
+            {
+                return false;
+            }
+            offset += 8 + uint32_t(n) * 8;
+        }
+    }
+
+    return true;
+}
+
+std::string_view GameRecordView::format() const
+{
+    return std::string_view(fixed().format);
+}
+
+std::string_view GameRecordView::string(const StringRef & ref) const
+{
+    return std::string_view(_body + ref.offset, ref.length);
+}
+
+std::string_view GameRecordView::skillLine(int i) const
+{
+    return string(reinterpret_cast<const StringRef *>(_body + fixed().skillLinesOffset)[i]);
+}
+
+void GameRecordView::readSnapshot(uint32_t & offset, int & frame, PlayerSnapshot & us, PlayerSnapshot & them) const
+{
+    const int32_t * p = reinterpret_cast<const int32_t *>(_body + offset);
+    frame = *p++;
+    for (PlayerSnapshot * snap : { &us, &them })
+    {
+        snap->numBases = *p++;
+        const int32_t n = *p++;
+        snap->unitCounts.clear();
+        for (int32_t i = 0; i < n; ++i, p += 2)
+        {
+            snap->unitCounts[BWAPI::UnitType(p[0])] = p[1];
+        }
+    }
+    offset = uint32_t(reinterpret_cast<const char *>(p) - _body);
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+RecordBuilder::RecordBuilder()
+{
+    std::memset(&_fixed, 0, sizeof(_fixed));
+}
+
+uint32_t RecordBuilder::offset() const
+{
+    return uint32_t(sizeof(RecordFixed) + _data.size());
+}
+
+StringRef RecordBuilder::addString(const std::string & s)
+{
+    StringRef ref = { offset(), uint32_t(s.size()) };
+    _data += s;
+    _data.append((4 - s.size() % 4) % 4, '\0');
+    return ref;
+}
+
+void RecordBuilder::addInt(int32_t n)
+{
+    _data.append(reinterpret_cast<const char *>(&n), sizeof(n));
+}
+
+void RecordBuilder::addPlayerSnapshot(const PlayerSnapshot & snap)
+{
+    addInt(snap.numBases);
+    addInt(int32_t(snap.unitCounts.size()));
+    for (const auto & unitCount : snap.unitCounts)
+    {
+        addInt(unitCount.first.getID());
+        addInt(unitCount.second);
+    }
+}
+
+std::string RecordBuilder::finish() const
+{
+    std::string body(reinterpret_cast<const char *>(&_fixed), sizeof(_fixed));
+    return body + _data;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+OpponentFile::OpponentFile()
+    : _validEnd(0)
+{
+}
+
+bool OpponentFile::open(const std::string & filename)
+{
+    _records.clear();
+    _validEnd = 0;
+    if (!_file.open(filename) || _file.size() < sizeof(FileHeader))
+    {
+        _file.close();
+        return false;
+    }
+
+    const FileHeader * header = reinterpret_cast<const FileHeader *>(_file.data());
+    if (header->magic != Magic || header->version != Version)
+    {
+        _file.close();
+        return false;
+    }
+
+    size_t pos = sizeof(FileHeader);
+    while (pos + sizeof(RecordHeader) <= _file.size())
+    {
+        const RecordHeader * rh = reinterpret_cast<const RecordHeader *>(_file.data() + pos);
+        const char * body = _file.data() + pos + sizeof(RecordHeader);
+        if (rh->magic != RecordMagic ||
+            rh->size % 4 != 0 ||
+            rh->size > _file.size() - pos - sizeof(RecordHeader) ||
+            rh->checksum != Checksum(body, rh->size))
+        {
+            break;
+        }
+
+        GameRecordView view(body, rh->size);
+        if (!view.isValid())
+        {
+            break;
+        }
+        _records.push_back(view);
+        pos += sizeof(RecordHeader) + rh->size;
+    }
+    _validEnd = pos;
+
+    return true;
+}
+
+void OpponentFile::close()
+{
+    _records.clear();
+    _validEnd = 0;
+    _file.close();
+}
+
+uint32_t OpponentFile::lastChecksum() const
+{
+    if (_records.empty())
+    {
+        return 0;
+    }
+    const std::string_view body = _records.back().body();
+    return OpponentFileFormat::Checksum(body.data(), body.size());
+}
+
+void OpponentFile::WriteHeader(std::ostream & output)
+{
+    FileHeader header = { Magic, Version };
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+void OpponentFile::WriteRecord(std::ostream & output, std::string_view body)
+{
+    RecordHeader header = { RecordMagic, uint32_t(body.size()), Checksum(body.data(), body.size()) };
+    output.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    output.write(body.data(), body.size());
+}
+
+bool OpponentFile::Append(const std::string & filename, size_t validEnd, const std::string & records)
+{
+    std::error_code ec;
+    if (std::filesystem::file_size(filename, ec) != validEnd)
+    {
+        std::filesystem::resize_file(filename, validEnd, ec);
+        if (ec)
+        {
+            return false;
+        }
+    }
+
+    std::ofstream output(filename, std::ios::binary | std::ios::app);
+    if (!output.good())
+    {
+        return false;
+    }
+    output.write(records.data(), records.size());
+    output.flush();
+    return output.good();
+}
+
+bool OpponentFile::Replace(const std::string & filename, const std::string & contents)
+{
+    const std::string tempFilename = filename + ".tmp";
+    {
+        std::ofstream output(tempFilename, std::ios::binary | std::ios::trunc);
+        if (!output.good())
+        {
+            return false;
+        }
+        output.write(contents.data(), contents.size());
+        output.flush();
+        if (!output.good())
+        {
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tempFilename, filename, ec);
+    return !ec;
+}
+
+bool OpponentFile::ConvertTextToBinary(const std::string & textFilename, const std::string & binaryFilename)
+{
+    std::ifstream input(textFilename);
+    if (!input.good())
+    {
+        return false;
+    }
+    std::ofstream output(binaryFilename, std::ios::binary | std::ios::trunc);
+    if (!output.good())
+    {
+        return false;
+    }
+
+    WriteHeader(output);
+    while (input.good())
+    {
+        GameRecord record(input);
+        if (record.isValid())
+        {
+            record.writeBinary(output);
+        }
+    }
+    return output.good();
+}
+
+bool OpponentFile::ConvertBinaryToText(const std::string & binaryFilename, const std::string & textFilename)
+{
+    OpponentFile file;
+    if (!file.open(binaryFilename))
+    {
+        return false;
+    }
+    std::ofstream output(textFilename, std::ios::trunc);
+    if (!output.good())
+    {
+        return false;
+    }
+
+    for (const GameRecordView & view : file.records())
+    {
+        GameRecord record(view);
+        if (record.isValid())
+        {
+            record.writeAsRecorded(output);
+        }
+    }
+    return output.good();
+}
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "MappedFile.h"
+
+// The binary opponent model file.
+// It holds the same game records as the text file, and can be converted to and from it
+// without loss. It is designed to be memory mapped and read in place.
+
+// The file is also an append-only log: each game appends one record, and the file is
+// compacted by rewriting it only once in a while. A record torn by a crash fails its
+// checksum; it and anything after it are ignored, and cut off before the next append.
+
+// File layout. All fields are 4-byte little-endian and 4-byte aligned.
+//   FileHeader
+//   records, each a RecordHeader followed by a body of RecordHeader::size bytes
+// Record body layout:
+//   RecordFixed
+//   variable data: string bytes (each padded to 4), snapshots, skill line StringRef array
+// Snapshot layout (only in records of format 1.4, as in the text file):
+//   frame, then our PlayerSnapshot, then the enemy's
+// PlayerSnapshot layout:
+//   numBases, n, then n pairs of (unit type ID, count)
+
+namespace UAlbertaBot
+{
+class PlayerSnapshot;
+
+namespace OpponentFileFormat
+{
+    const uint32_t Magic = 0x4d4f4853;          // "SHOM"
+    const uint32_t Version = 1;
+    const uint32_t RecordMagic = 0x52474853;    // "SHGR"
+
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+    };
+
+    struct RecordHeader
+    {
+        uint32_t magic;
+        uint32_t size;          // of the body, a multiple of 4
+        uint32_t checksum;      // of the body
+    };
+
+    // A string stored in the record's variable data. Offsets are from the start of the body.
+    struct StringRef
+    {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct RecordFixed
+    {
+        char format[4];         // "3.0" or "1.4", the text format the record corresponds to
+
+        int32_t ourRace;        // BWAPI race IDs
+        int32_t enemyRace;
+        int32_t enemyIsRandom;
+
+        int32_t myStartingBaseID;
+        int32_t enemyStartingBaseID;
+        int32_t win;
+
+        int32_t frameScoutSentForGasSteal;
+        int32_t gasStealHappened;
+
+        int32_t frameWeMadeFirstCombatUnit;
+        int32_t frameWeGatheredGas;
+
+        int32_t frameEnemyScoutsOurBase;
+        int32_t frameEnemyGetsCombatUnits;
+        int32_t frameEnemyUsesGas;
+        int32_t frameEnemyGetsAirUnits;
+        int32_t frameEnemyGetsStaticAntiAir;
+        int32_t frameEnemyGetsMobileAntiAir;
+        int32_t frameEnemyGetsCloakedUnits;
+        int32_t frameEnemyGetsStaticDetection;
+        int32_t frameEnemyGetsMobileDetection;
+        int32_t frameGameEnds;
+
+        StringRef mapName;
+        StringRef openingName;
+        StringRef expectedEnemyPlan;
+        StringRef enemyPlan;
+
+        uint32_t nSnapshots;
+        uint32_t snapshotsOffset;
+        uint32_t nSkillLines;
+        uint32_t skillLinesOffset;
+    };
+
+    uint32_t Checksum(const char * data, size_t size);
+}
+
+// A read-only view of one record body, pointing into a mapped file. Nothing is copied.
+class GameRecordView
+{
+private:
+    const char * _body;
+    uint32_t _size;
+
+    bool inBounds(uint32_t offset, uint32_t length) const;
+
+public:
+    GameRecordView(const char * body, uint32_t size);
+
+    // Check that every offset in the record stays inside it.
+    bool isValid() const;
+
+    // The raw record body, for copying the record without decoding it.
+    std::string_view body() const { return std::string_view(_body, _size); };
+
+    const OpponentFileFormat::RecordFixed & fixed() const
+    {
+        return *reinterpret_cast<const OpponentFileFormat::RecordFixed *>(_body);
+    };
+
+    std::string_view format() const;
+    std::string_view string(const OpponentFileFormat::StringRef & ref) const;
+
+    int skillLineCount() const { return int(fixed().nSkillLines); };
+    std::string_view skillLine(int i) const;
+
+    // Snapshots are variable length, so read them in order, starting from firstSnapshot().
+    // Each read advances the offset to the next snapshot.
+    int snapshotCount() const { return int(fixed().nSnapshots); };
+    uint32_t firstSnapshot() const { return fixed().snapshotsOffset; };
+    void readSnapshot(uint32_t & offset, int & frame, PlayerSnapshot & us, PlayerSnapshot & them) const;
+};
+
+// Build a record body in memory, to be written with OpponentFile::WriteRecord().
+class RecordBuilder
+{
+private:
+    OpponentFileFormat::RecordFixed _fixed;
+    std::string _data;          // the variable data following the fixed part
+
+public:
+    RecordBuilder();
+
+    OpponentFileFormat::RecordFixed & fixed() { return _fixed; };
+
+    uint32_t offset() const;
+    OpponentFileFormat::StringRef addString(const std::string & s);
+    void addInt(int32_t n);
+    void addPlayerSnapshot(const PlayerSnapshot & snap);
+
+    std::string finish() const;
+};
+
+// A mapped binary opponent model file and an index of its records.
+class OpponentFile
+{
+private:
+    MappedFile _file;
+    std::vector<GameRecordView> _records;
+    size_t _validEnd;           // file offset just past the last good record
+
+public:
+    OpponentFile();
+
+    // Return false if the file does not exist or is not a binary opponent model file.
+    // A damaged record ends the index; the records before it are kept.
+    bool open(const std::string & filename);
+    void close();
+
+    const std::vector<GameRecordView> & records() const { return _records; };
+    size_t validEnd() const { return _validEnd; };
+
+    // The checksum of the last good record, 0 if there are none. With the record count,
+    // it tells whether two files hold the same log.
+    uint32_t lastChecksum() const;
+
+    static void WriteHeader(std::ostream & output);
+    static void WriteRecord(std::ostream & output, std::string_view body);
+
+    // Append encoded records to an existing file. First cut off any damaged tail after validEnd.
+    // The file must not be open.
+    static bool Append(const std::string & filename, size_t validEnd, const std::string & records);
+
+    // Replace the file contents all at once, by writing a temporary file and renaming it.
+    // A crash leaves either the old file or the new one.
+    static bool Replace(const std::string & filename, const std::string & contents);
+
+    // Convert between the text and binary formats. Invalid records are dropped, as in reading.
+    static bool ConvertTextToBinary(const std::string & textFilename, const std::string & binaryFilename);
+    static bool ConvertBinaryToText(const std::string & binaryFilename, const std::string & textFilename);
+};
+
+}
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <sstream>
 
 #include "OpponentModel.h"
 
@@ -393,22 +394,10 @@ void OpponentModel::reconsiderEnemyPlan()
 }
 
 // Find the past game record which best matches the current game and remember it.
+// It is the record with the least _gameRecord.distance(); the match index finds it quickly.
 void OpponentModel::setBestMatch()
 {
-    int bestScore = -1;
-    GameRecord * bestRecord = nullptr;
-
-    for (GameRecord * record : _pastGameRecords)
-    {
-        int score = _gameRecord.distance(*record);
-        if (score != -1 && (!bestRecord || score < bestScore))
-        {
-            bestScore = score;
-            bestRecord = record;
-        }
-    }
-
-    _bestMatch = bestRecord;
+    _bestMatch = _matchIndex.findBestMatch(_gameRecord, _pastGameRecords);
 }
 
 // We have decided to explore openings. Return an appropriate opening name.
@@ -451,7 +440,9 @@ std::string OpponentModel::getOpeningForEnemyPlan(OpeningPlan enemyPlan)
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
 OpponentModel::OpponentModel()
-    : _bestMatch(nullptr)
+    : _binaryRecordsRead(-1)
+    , _binaryLastChecksum(0)
+    , _bestMatch(nullptr)
     , _singleStrategy(false)
     , _initialExpectedEnemyPlan(OpeningPlan::Unknown)
     , _expectedEnemyPlan(OpeningPlan::Unknown)
@@ -463,6 +454,75 @@ OpponentModel::OpponentModel()
     std::replace(name.begin(), name.end(), ' ', '_');
 
     _filename = "om_" + name + ".txt";
+    _binaryFilename = "om_" + name + ".bin";
+}
+
+// Read game records from a text opponent model file. Return false if there is no file.
+bool OpponentModel::readText(const std::string & filename)
+{
+    std::ifstream inFile(filename);
+    if (!inFile.good())
+    {
+        return false;
+    }
+
+    while (inFile.good())
+    {
+        // NOTE We allocate records here and never free them if valid.
+        //      Their lifetime is the whole game.
+        GameRecord * record = new GameRecord(inFile);
+        if (record->isValid())
+        {
+            _pastGameRecords.push_back(record);
+        }
+        else
+        {
+            delete record;
+        }
+    }
+
+    inFile.close();
+    return true;
+}
+
+// Read game records from a binary opponent model file. Return false if there is no file,
+// or it is not a binary opponent model file.
+// The file stays mapped for the game, because the records load their details from it on demand.
+bool OpponentModel::readBinary(const std::string & filename)
+{
+    if (!_file.open(filename))
+    {
+        return false;
+    }
+
+    _binaryRecordsRead = int(_file.records().size());
+    _binaryLastChecksum = _file.lastChecksum();
+
+    // The file is a log that may hold a few more records than the limit until it is next compacted.
+    // Use only the newest records, the same as if it had been compacted.
+    size_t first = 0;
+    if (Config::IO::MaxGameRecords > 0 && _file.records().size() > size_t(Config::IO::MaxGameRecords))
+    {
+        first = _file.records().size() - Config::IO::MaxGameRecords;
+    }
+
+    for (size_t i = first; i < _file.records().size(); ++i)
+    {
+        const GameRecordView & view = _file.records()[i];
+
+        // NOTE As above, valid records live for the whole game.
+        GameRecord * record = new GameRecord(view);
+        if (record->isValid())
+        {
+            _pastGameRecords.push_back(record);
+        }
+        else
+        {
+            delete record;
+        }
+    }
+
+    return true;
 }
 
 // Read past game records from the opponent model file, and do initial analysis.
@@ -473,39 +533,15 @@ void OpponentModel::read()
 
     if (Config::IO::ReadOpponentModel)
     {
-        std::ifstream inFile;
-        
-        inFile.open(Config::IO::ReadDir + _filename);
-
-        // There may not be a file to read. Check for a prepared file in the AI directory.
-        if (!inFile.good())
-        {
-            inFile.clear();
-            inFile.open(Config::IO::PreparedDataDir + _filename);
-            if (!inFile.good())
-            {
-                // No prepared file either. That's OK.
-                return;
-            }
-        }
-        // At this point, we have a file to read.
-
-        while (inFile.good())
+        // Prefer the read directory to the prepared data directory, and binary to text.
+        // There may not be a file to read. That's OK.
+        if (!readBinary(Config::IO::ReadDir + _binaryFilename) &&
+            !readText(Config::IO::ReadDir + _filename) &&
+            !readBinary(Config::IO::PreparedDataDir + _binaryFilename) &&
+            !readText(Config::IO::PreparedDataDir + _filename))
         {
-            // NOTE We allocate records here and never free them if valid.
-            //      Their lifetime is the whole game.
-            GameRecord * record = new GameRecord(inFile);
-            if (record->isValid())
-            {
-                _pastGameRecords.push_back(record);
-            }
-            else
-            {
-                delete record;
-            }
+            return;
         }
-
-        inFile.close();
     }
 
     // Make immediate decisions that may take into account the game records.
@@ -516,46 +552,167 @@ void OpponentModel::read()
     considerOpenings();
 }
 
-// Write the game records to the opponent model file.
-void OpponentModel::write()
+// The number of initial game records to skip over without rewriting.
+// In normal operation, it is 0 or 1.
+int OpponentModel::recordsToSkip() const
 {
-    if (Config::IO::WriteOpponentModel)
+    if (int(_pastGameRecords.size()) >= Config::IO::MaxGameRecords)
     {
-        std::ofstream outFile(Config::IO::WriteDir + _filename, std::ios::trunc);
+        return _pastGameRecords.size() - Config::IO::MaxGameRecords + 1;
+    }
+    return 0;
+}
+
+void OpponentModel::writeText()
+{
+    std::ofstream outFile(Config::IO::WriteDir + _filename, std::ios::trunc);
 
-        // If it fails, there's not much we can do about it.
-        if (outFile.bad())
+    // If it fails, there's not much we can do about it.
+    if (outFile.bad())
+    {
+        return;
+    }
+
+    int nToSkip = recordsToSkip();
+
+    // Rewrite any old records that were read in.
+    // Not needed for local testing or for SSCAIT, necessary for other competitions.
+    for (GameRecord * record : _pastGameRecords)
+    {
+        if (nToSkip > 0)
         {
-            return;
+            --nToSkip;
         }
-
-        // The number of initial game records to skip over without rewriting.
-        // In normal operation, nToSkip is 0 or 1.
-        int nToSkip = 0;
-        if (int(_pastGameRecords.size()) >= Config::IO::MaxGameRecords)
+        else
         {
-            nToSkip = _pastGameRecords.size() - Config::IO::MaxGameRecords + 1;
+            record->write(outFile);
         }
+    }
+
+    // And write the record of this game.
+    _gameRecord.write(outFile);
+
+    outFile.close();
+}
+
+// The binary file is an append-only log that is allowed to grow this long before it is compacted.
+// Compacting only once in a while keeps the usual end-of-game write down to one record.
+int OpponentModel::compactionLimit() const
+{
+    if (Config::IO::MaxGameRecords <= 0)
+    {
+        return 0;
+    }
+    return Config::IO::MaxGameRecords + std::max(8, Config::IO::MaxGameRecords / 4);
+}
 
-        // Rewrite any old records that were read in.
-        // Not needed for local testing or for SSCAIT, necessary for other competitions.
-        for (GameRecord * record : _pastGameRecords)
+// Append the record of this game to the binary file in the write directory.
+// A crash during the append leaves a torn last record, which fails its checksum and is
+// ignored when reading; the next append cuts it off. If the file is too long, compact it
+// instead, keeping the newest records.
+void OpponentModel::writeBinary()
+{
+    const std::string filename = Config::IO::WriteDir + _binaryFilename;
+
+    std::ostringstream thisGame;
+    _gameRecord.writeBinary(thisGame);
+
+    OpponentFile file;
+
+    // Append only to the log that was read in (or an exact copy of it, as when the
+    // tournament copies the write directory to the read directory between games).
+    // Otherwise the file would not end up holding the records that were read.
+    // A file replaced by another writer may have the same number of records, so
+    // the last record must match too.
+    if (!file.open(filename) ||
+        int(file.records().size()) != _binaryRecordsRead ||
+        file.lastChecksum() != _binaryLastChecksum)
+    {
+        file.close();
+        rewriteBinary();
+        return;
+    }
+
+    const int nRecords = int(file.records().size());
+    if (nRecords < compactionLimit())
+    {
+        const size_t validEnd = file.validEnd();
+        file.close();
+        _file.close();
+        (void) OpponentFile::Append(filename, validEnd, thisGame.str());
+        return;
+    }
+
+    // Compact. Copy the newest records as they are, without decoding them.
+    const int nToKeep = std::min(nRecords, Config::IO::MaxGameRecords - 1);
+    std::ostringstream contents;
+    OpponentFile::WriteHeader(contents);
+    for (int i = nRecords - std::max(0, nToKeep); i < nRecords; ++i)
+    {
+        OpponentFile::WriteRecord(contents, file.records()[i].body());
+    }
+    contents << thisGame.str();
+
+    // The file must be unmapped before it can be replaced.
+    file.close();
+    _file.close();
+    (void) OpponentFile::Replace(filename, contents.str());
+}
+
+// Write a fresh binary file from the records that were read in, plus this game.
+// This is the path when the records came from a text file or from another directory.
+void OpponentModel::rewriteBinary()
+{
+    std::ostringstream contents;
+    OpponentFile::WriteHeader(contents);
+
+    int nToSkip = recordsToSkip();
+    for (GameRecord * record : _pastGameRecords)
+    {
+        if (nToSkip > 0)
         {
-            if (nToSkip > 0)
-            {
-                --nToSkip;
-            }
-            else
-            {
-                record->write(outFile);
-            }
+            --nToSkip;
+        }
+        else
+        {
+            record->writeBinary(contents);
         }
+    }
 
-        // And write the record of this game.
-        _gameRecord.write(outFile);
+    _gameRecord.writeBinary(contents);
+
+    // If it fails, there's not much we can do about it.
+    _file.close();
+    (void) OpponentFile::Replace(Config::IO::WriteDir + _binaryFilename, contents.str());
+}
 
-        outFile.close();
+// Write the game records to the opponent model file.
+// Writing the binary file unmaps the file that was read, so afterward the past records
+// can no longer load their details. The game is over by then.
+void OpponentModel::write()
+{
+    if (Config::IO::WriteOpponentModel)
+    {
+        if (Config::IO::BinaryOpponentModel)
+        {
+            writeBinary();
+        }
+        else
+        {
+            writeText();
+        }
+    }
+}
+
+// Convert this opponent's learning file in the read directory to the other format,
+// and put the result in the write directory. The text format is for people to read.
+bool OpponentModel::convertFile(bool toBinary) const
+{
+    if (toBinary)
+    {
+        return OpponentFile::ConvertTextToBinary(Config::IO::ReadDir + _filename, Config::IO::WriteDir + _binaryFilename);
     }
+    return OpponentFile::ConvertBinaryToText(Config::IO::ReadDir + _binaryFilename, Config::IO::WriteDir + _filename);
 }
 
 void OpponentModel::update()
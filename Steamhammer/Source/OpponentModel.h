@@ -1,7 +1,9 @@
 #pragma once
 
 #include "Common.h"
+#include "GameMatchIndex.h"
 #include "GameRecordNow.h"
+#include "OpponentFile.h"
 #include "OpponentPlan.h"
 
 namespace UAlbertaBot
@@ -48,11 +50,16 @@ namespace UAlbertaBot
 
         OpponentPlan _planRecognizer;
 
-        std::string _filename;
+        std::string _filename;                          // text file
+        std::string _binaryFilename;
+        int _binaryRecordsRead;                         // records in the binary file read, -1 if none
+        uint32_t _binaryLastChecksum;                   // checksum of the last record read
+        OpponentFile _file;                             // the binary file read; past records point into it
         GameRecordNow _gameRecord;                      // the current game
         std::vector<GameRecord *> _pastGameRecords;     // from learning files
 
         GameRecord * _bestMatch;
+        GameMatchIndex _matchIndex;
 
         // Advice for the rest of the bot.
         OpponentSummary _summary;
@@ -72,6 +79,14 @@ namespace UAlbertaBot
         void reconsiderEnemyPlan();
         void setBestMatch();
 
+        bool readText(const std::string & filename);
+        bool readBinary(const std::string & filename);
+        int recordsToSkip() const;
+        int compactionLimit() const;
+        void writeText();
+        void writeBinary();
+        void rewriteBinary();
+
         std::string getExploreOpening(const OpponentSummary & opponentSummary);
         std::string getOpeningForEnemyPlan(OpeningPlan enemyPlan);
 
@@ -83,6 +98,7 @@ namespace UAlbertaBot
 
         void read();
         void write();
+        bool convertFile(bool toBinary) const;
 
         void update();
 
@@ -1,5 +1,6 @@
 #include "OpsBoss.h"
 
+#include "Profiler.h"
 #include "The.h"
 
 #include "InformationManager.h"
@@ -247,6 +248,8 @@ void OpsBoss::cluster(BWAPI::Player player, const BWAPI::Unitset & units, std::v
 
 void OpsBoss::update()
 {
+    ProfileZone zone("OpsBoss::update");
+
     int phase = BWAPI::Broodwar->getFrameCount() % 5;
 
     if (phase == 0)
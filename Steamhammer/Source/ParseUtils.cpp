@@ -4,12 +4,11 @@
 #include "JSONTools.h"
 
 #include "BuildOrder.h"
+#include "OpeningBook.h"
 #include "OpponentModel.h"
 #include "Random.h"
 #include "StrategyManager.h"
 
-#include <regex>
-
 // Parse the configuration file.
 // Parse manual commands.
 // Provide a few simple parsing routines for wider use.
@@ -78,6 +77,7 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
         const rapidjson::Value & micro = doc["Micro"];
 
         Config::Micro::KiteWithRangedUnits = GetBoolByRace("KiteWithRangedUnits", micro);
+        JSONTools::ReadBool("LimitOverkill", micro, Config::Micro::LimitOverkill);
         Config::Micro::WorkersDefendRush = GetBoolByRace("WorkersDefendRush", micro);
         
         Config::Micro::RetreatMeleeUnitShields = GetIntByRace("RetreatMeleeUnitShields", micro);
@@ -157,11 +157,16 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
         JSONTools::ReadString("WriteDirectory", io, Config::IO::WriteDir);
 
         JSONTools::ReadString("OpeningTimingFile", io, Config::IO::OpeningTimingFile);
+        JSONTools::ReadString("OpeningBookFile", io, Config::IO::OpeningBookFile);
         
         JSONTools::ReadInt("MaxGameRecords", io, Config::IO::MaxGameRecords);
 
         Config::IO::ReadOpponentModel = GetBoolByRace("ReadOpponentModel", io);
         Config::IO::WriteOpponentModel = GetBoolByRace("WriteOpponentModel", io);
+        JSONTools::ReadBool("BinaryOpponentModel", io, Config::IO::BinaryOpponentModel);
+        JSONTools::ReadBool("WriteProfile", io, Config::IO::WriteProfile);
+        JSONTools::ReadBool("CaptureFrames", io, Config::IO::CaptureFrames);
+        JSONTools::ReadInt("CaptureFrameInterval", io, Config::IO::CaptureFrameInterval);
     }
 
     // Parse the Skills options.
@@ -222,73 +227,27 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
 
         // 0. Parse all the openings.
         // Besides making them all available, this checks that they are syntatically valid.
+        // The compiled openings are cached, so the check only happens when the config changes.
+        // Only the build order of the opening we choose is parsed, in StrategyManager::expandOpening().
         std::vector<std::string> openingNames;		// in case we want to make a random choice
         if (strategy.HasMember("Strategies") && strategy["Strategies"].IsObject())
         {
-            const rapidjson::Value & strategies = strategy["Strategies"];
-            for (rapidjson::Value::ConstMemberIterator itr = strategies.MemberBegin(); itr != strategies.MemberEnd(); ++itr)
+            const uint64_t configHash = OpeningBook::Hash(config);
+            OpeningBook book;
+            if (!book.read(Config::IO::ReadDir + Config::IO::OpeningBookFile, configHash) &&
+                !book.read(Config::IO::WriteDir + Config::IO::OpeningBookFile, configHash))
             {
-                const std::string &		 name = itr->name.GetString();
-                const rapidjson::Value & val = itr->value;
-
-                BWAPI::Race strategyRace;
-                if (val.HasMember("Race") && val["Race"].IsString())
-                {
-                    strategyRace = GetRace(val["Race"].GetString());
-                }
-                else
-                {
-                    UAB_ASSERT_WARNING(false, "Strategy must have a Race string. Skipping %s", name.c_str());
-                    continue;
-                }
-
-                std::string openingGroup("");
-                if (val.HasMember("OpeningGroup") && val["OpeningGroup"].IsString())
-                {
-                    openingGroup = val["OpeningGroup"].GetString();
-                }
-
-                BuildOrder buildOrder(strategyRace);
-                if (val.HasMember("OpeningBuildOrder") && val["OpeningBuildOrder"].IsArray())
-                {
-                    const rapidjson::Value & build = val["OpeningBuildOrder"];
-
-                    for (size_t b(0); b < build.Size(); ++b)
-                    {
-                        if (build[b].IsString())
-                        {
-                            std::string itemName = build[b].GetString();
-
-                            int unitCount = 1;    // the default count
-
-                            // You can specify a count, like "6 x mutalisk". The spaces are required.
-                            // Mostly useful for units, but "2 x creep colony @ natural" also works.
-                            std::regex countRegex("([0-9]+)\\s+x\\s+([a-zA-Z_ ]+(\\s+@\\s+[a-zA-Z_ ]+)?)");
-                            std::smatch m;
-                            if (std::regex_match(itemName, m, countRegex)) {
-                                unitCount = GetIntFromString(m[1].str());
-                                itemName = m[2].str();
-                            }
-
-                            MacroAct act(itemName);
-                            for (int i = 0; i < unitCount; ++i)
-                            {
-                                buildOrder.add(act);
-                            }
-                        }
-                        else
-                        {
-                            UAB_ASSERT_WARNING(false, "Build order item must be a string %s", name.c_str());
-                            continue;
-                        }
-                    }
-                }
+                book.compile(strategy["Strategies"]);
+                (void) book.write(Config::IO::WriteDir + Config::IO::OpeningBookFile, configHash);
+            }
 
+            for (const OpeningBookEntry & entry : book.entries())
+            {
                 // Only remember the ones that are for our current race.
-                if (strategyRace == BWAPI::Broodwar->self()->getRace())
+                if (entry.race == BWAPI::Broodwar->self()->getRace())
                 {
-                    StrategyManager::Instance().addStrategy(name, Strategy(name, strategyRace, openingGroup, buildOrder));
-                    openingNames.push_back(name);
+                    StrategyManager::Instance().addStrategy(entry.name, Strategy(entry.name, entry.race, entry.openingGroup, entry.items));
+                    openingNames.push_back(entry.name);
                 }
             }
         }
@@ -432,6 +391,7 @@ void ParseUtils::ParseConfigFile(const std::string & filename)
             }
         }
 
+        StrategyManager::Instance().expandOpening();
         OpponentModel::Instance().setOpening();
     }
 
@@ -505,6 +465,15 @@ void ParseUtils::ParseTextCommand(const std::string & commandString)
 
         else { UAB_ASSERT_WARNING(false, "Unknown variable name for /set: %s", variableName.c_str()); }
     }
+    else if (command == "/convert")
+    {
+        // "/convert binary" or "/convert text" converts this opponent's learning file
+        // from the read directory into the write directory.
+        if (!OpponentModel::Instance().convertFile(variableName == "binary"))
+        {
+            UAB_ASSERT_WARNING(false, "Opponent model file conversion failed");
+        }
+    }
     else
     {
         UAB_ASSERT_WARNING(false, "Unknown command: %s", command.c_str());
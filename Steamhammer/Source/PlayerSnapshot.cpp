@@ -10,6 +10,65 @@ using namespace UAlbertaBot;
 
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
+UnitCounts::const_iterator::const_iterator(const int * counts, int type)
+    : _counts(counts)
+    , _type(type)
+{
+    skipZeros();
+}
+
+void UnitCounts::const_iterator::skipZeros()
+{
+    while (_type < NTypes && _counts[_type] == 0)
+    {
+        ++_type;
+    }
+    if (_type < NTypes)
+    {
+        _value = value_type(BWAPI::UnitType(_type), _counts[_type]);
+    }
+}
+
+UnitCounts::const_iterator & UnitCounts::const_iterator::operator++()
+{
+    ++_type;
+    skipZeros();
+    return *this;
+}
+
+UnitCounts::UnitCounts()
+{
+    _counts.fill(0);
+}
+
+UnitCounts::const_iterator UnitCounts::find(BWAPI::UnitType type) const
+{
+    return _counts[type.getID()] != 0 ? const_iterator(_counts.data(), type.getID()) : end();
+}
+
+size_t UnitCounts::size() const
+{
+    size_t n = 0;
+    for (int c : _counts)
+    {
+        n += c != 0;
+    }
+    return n;
+}
+
+// Written as a plain loop over the arrays so the compiler can vectorize it.
+int UnitCounts::Distance(const UnitCounts & a, const UnitCounts & b)
+{
+    int distance = 0;
+    for (int t = 0; t < NTypes; ++t)
+    {
+        distance += abs(a._counts[t] - b._counts[t]);
+    }
+    return distance;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
 // Is this unit type to be excluded from the game record?
 // We leave out boring units like interceptors. Larvas are interesting.
 // Neutral boring unit types don't need to be listed here.
@@ -62,8 +121,7 @@ void PlayerSnapshot::inferUnseenRequirements(const PlayerSnapshot & ever, BWAPI:
     for (std::pair<BWAPI::UnitType, int> requirement : requirements)
     {
         BWAPI::UnitType requiredType = requirement.first;
-        if (ever.getCounts().find(requiredType) == ever.getCounts().end() &&
-            unitCounts.find(requiredType) == unitCounts.end())
+        if (ever.count(requiredType) == 0 && count(requiredType) == 0)
         {
             if (requiredType.isBuilding() &&
                 !UnitUtil::BuildingIsMorphedFrom(requiredType, t) &&
@@ -245,12 +303,7 @@ void PlayerSnapshot::takeEnemyInferred(const PlayerSnapshot & ever)
 
 int PlayerSnapshot::count(BWAPI::UnitType type) const
 {
-    auto it = unitCounts.find(type);
-    if (it == unitCounts.end())
-    {
-        return 0;
-    }
-    return it->second;
+    return unitCounts.get(type);
 }
 
 int PlayerSnapshot::countWorkers() const
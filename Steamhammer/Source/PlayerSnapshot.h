@@ -2,8 +2,65 @@
 
 #include "Common.h"
 
+#include <array>
+
 namespace UAlbertaBot
 {
+// Unit counts indexed by unit type ID, in a fixed-size array.
+// It has the parts of the std::map<BWAPI::UnitType, int> API that snapshots use:
+// operator[], find(), count(), size(), clear(), and iteration in order of type.
+// Unlike a map, a type whose count is 0 is the same as a type that is absent.
+class UnitCounts
+{
+public:
+    static const int NTypes = BWAPI::UnitTypes::Enum::MAX;
+
+    typedef std::pair<BWAPI::UnitType, int> value_type;
+
+    // Visits only the types with nonzero counts.
+    class const_iterator
+    {
+    private:
+        const int * _counts;
+        int _type;
+        value_type _value;
+
+        void skipZeros();
+
+    public:
+        const_iterator(const int * counts, int type);
+
+        const value_type & operator*() const { return _value; };
+        const value_type * operator->() const { return &_value; };
+
+        const_iterator & operator++();
+
+        bool operator==(const const_iterator & rhs) const { return _type == rhs._type; };
+        bool operator!=(const const_iterator & rhs) const { return _type != rhs._type; };
+    };
+
+private:
+    std::array<int, NTypes> _counts;
+
+public:
+    UnitCounts();
+
+    int & operator[](BWAPI::UnitType type) { return _counts[type.getID()]; };
+    int get(BWAPI::UnitType type) const { return _counts[type.getID()]; };
+
+    const_iterator begin() const { return const_iterator(_counts.data(), 0); };
+    const_iterator end() const { return const_iterator(_counts.data(), NTypes); };
+    const_iterator find(BWAPI::UnitType type) const;
+    size_t count(BWAPI::UnitType type) const { return _counts[type.getID()] != 0 ? 1 : 0; };
+
+    size_t size() const;
+    bool empty() const { return size() == 0; };
+    void clear() { _counts.fill(0); };
+
+    // The sum of the differences in counts over all types.
+    static int Distance(const UnitCounts & a, const UnitCounts & b);
+};
+
 class PlayerSnapshot
 {
 protected:
@@ -15,9 +72,9 @@ protected:
 public:
     BWAPI::Player player;
     int numBases;
-    std::map<BWAPI::UnitType, int> unitCounts;
+    UnitCounts unitCounts;
 
-    const std::map<BWAPI::UnitType, int> & getCounts() const { return unitCounts; };
+    const UnitCounts & getCounts() const { return unitCounts; };
 
     PlayerSnapshot();
     PlayerSnapshot(BWAPI::Player);
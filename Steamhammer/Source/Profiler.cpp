@@ -0,0 +1,241 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+#include "Config.h"
+
+using namespace UAlbertaBot;
+
+// Each thread appends finished zones to its own ring buffer, so recording takes no lock.
+// Once per frame the main thread drains all the rings into per-zone statistics and,
+// if tracing, into a Chrome trace file (load it in chrome://tracing or ui.perfetto.dev).
+
+std::atomic<bool> Profiler::_enabled(false);
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+ProfileThread::ProfileThread(int id)
+    : _id(id)
+    , _ring(Capacity)
+    , _head(0)
+    , _tail(0)
+    , _dropped(0)
+{
+}
+
+void ProfileThread::record(const char * name, int64_t start, int64_t end)
+{
+    const size_t head = _head.load(std::memory_order_relaxed);
+    if (head - _tail.load(std::memory_order_acquire) >= Capacity)
+    {
+        _dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ProfileEvent & e = _ring[head & (Capacity - 1)];
+    e.name = name;
+    e.start = start;
+    e.end = end;
+
+    _head.store(head + 1, std::memory_order_release);
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+ProfileStats::ProfileStats()
+    : count(0)
+    , total(0)
+    , max(0)
+{
+    histogram.fill(0);
+}
+
+void ProfileStats::add(int64_t nanoseconds)
+{
+    ++count;
+    total += nanoseconds;
+    max = std::max(max, nanoseconds);
+
+    const double us = nanoseconds / 1000.0;
+    const int bucket = us <= 1.0 ? 0 : std::min(NBuckets - 1, int(std::log2(us) * 8.0));
+    ++histogram[bucket];
+}
+
+// Return the upper edge of the bucket that holds the given fraction of the samples.
+double ProfileStats::percentileMilliseconds(double p) const
+{
+    const int wanted = std::max(1, int(std::ceil(p * count)));
+    int seen = 0;
+    for (int b = 0; b < NBuckets; ++b)
+    {
+        seen += histogram[b];
+        if (seen >= wanted)
+        {
+            return std::min(std::pow(2.0, (b + 1) / 8.0) / 1000.0, max / 1000000.0);
+        }
+    }
+    return max / 1000000.0;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+Profiler::Profiler()
+    : _epoch(std::chrono::steady_clock::now())
+    , _traceStarted(false)
+{
+}
+
+const char * Profiler::Name(const std::string & name)
+{
+    Profiler & profiler = Instance();
+    std::lock_guard<std::mutex> lock(profiler._namesMutex);
+    return profiler._names.insert(name).first->c_str();
+}
+
+ProfileThread * Profiler::registerThread()
+{
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+    _threads.push_back(std::make_unique<ProfileThread>(int(_threads.size())));
+    return _threads.back().get();
+}
+
+void Profiler::writeSummary()
+{
+    // Merge zones with the same name.
+    std::map<std::string, ProfileStats> byName;
+    for (const auto & zone : _stats)
+    {
+        ProfileStats & s = byName[zone.first];
+        s.count += zone.second.count;
+        s.total += zone.second.total;
+        s.max = std::max(s.max, zone.second.max);
+        for (int b = 0; b < ProfileStats::NBuckets; ++b)
+        {
+            s.histogram[b] += zone.second.histogram[b];
+        }
+    }
+
+    // Most expensive first.
+    std::vector<std::pair<std::string, ProfileStats>> zones(byName.begin(), byName.end());
+    std::sort(zones.begin(), zones.end(), [](const auto & a, const auto & b)
+    {
+        return a.second.total > b.second.total;
+    });
+
+    std::ofstream out(Config::IO::WriteDir + "profile.txt", std::ios::trunc);
+    if (!out.good())
+    {
+        return;
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "zone count total_ms mean_ms p50_ms p99_ms max_ms\n";
+    for (const auto & zone : zones)
+    {
+        const ProfileStats & s = zone.second;
+        out << zone.first << ' '
+            << s.count << ' '
+            << s.total / 1000000.0 << ' '
+            << s.total / 1000000.0 / std::max(1, s.count) << ' '
+            << s.percentileMilliseconds(0.50) << ' '
+            << s.percentileMilliseconds(0.99) << ' '
+            << s.max / 1000000.0 << '\n';
+    }
+
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+    for (const auto & thread : _threads)
+    {
+        if (thread->_dropped.load() > 0)
+        {
+            out << "thread " << thread->_id << " dropped " << thread->_dropped.load() << " events\n";
+        }
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+Profiler & Profiler::Instance()
+{
+    static Profiler instance;
+    return instance;
+}
+
+int64_t Profiler::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - Instance()._epoch).count();
+}
+
+ProfileThread & Profiler::Thread()
+{
+    thread_local ProfileThread * thread = Instance().registerThread();
+    return *thread;
+}
+
+void Profiler::initialize()
+{
+    if (!Config::IO::WriteProfile)
+    {
+        return;
+    }
+
+    _trace.open(Config::IO::WriteDir + "trace.json", std::ios::trunc);
+    if (_trace.good())
+    {
+        _trace << std::fixed << std::setprecision(3) << "[\n";
+        _traceStarted = true;
+    }
+    _enabled = true;
+}
+
+void Profiler::endFrame()
+{
+    if (!Enabled())
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(_threadsMutex);
+    for (const auto & thread : _threads)
+    {
+        const size_t head = thread->_head.load(std::memory_order_acquire);
+        size_t tail = thread->_tail.load(std::memory_order_relaxed);
+        for (; tail != head; ++tail)
+        {
+            const ProfileEvent & e = thread->_ring[tail & (ProfileThread::Capacity - 1)];
+            _stats[e.name].add(e.end - e.start);
+            if (_traceStarted)
+            {
+                _trace << "{\"name\":\"" << e.name
+                    << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread->_id
+                    << ",\"ts\":" << e.start / 1000.0
+                    << ",\"dur\":" << (e.end - e.start) / 1000.0
+                    << "},\n";
+            }
+        }
+        thread->_tail.store(tail, std::memory_order_release);
+    }
+}
+
+void Profiler::onEnd()
+{
+    if (!Enabled())
+    {
+        return;
+    }
+
+    endFrame();
+    _enabled = false;
+
+    if (_traceStarted)
+    {
+        // End with a metadata event, since not every viewer tolerates a trailing comma.
+        _trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"args\":{\"name\":\"Steamhammer\"}}\n]\n";
+        _trace.close();
+        _traceStarted = false;
+    }
+
+    writeSummary();
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+// Hierarchical scoped timing.
+// Mark a block of code with a ProfileZone and its time is recorded under the zone's name.
+// Zones nest; the trace shows the nesting, the summary counts each zone separately.
+// Recording is off unless Config::IO::WriteProfile is set.
+
+namespace UAlbertaBot
+{
+struct ProfileEvent
+{
+    const char * name;      // must be a string that outlives the game, normally a literal
+    int64_t start;          // nanoseconds since the profiler epoch
+    int64_t end;
+};
+
+// Events recorded by one thread. Only the owning thread writes, only Profiler::endFrame() reads.
+class ProfileThread
+{
+    friend class Profiler;
+
+    static const size_t Capacity = 1 << 14;     // power of 2
+
+    int _id;
+    std::vector<ProfileEvent> _ring;
+    std::atomic<size_t> _head;                  // next slot to write
+    std::atomic<size_t> _tail;                  // next slot to read
+    std::atomic<size_t> _dropped;               // events lost because the ring was full
+
+public:
+    ProfileThread(int id);
+
+    void record(const char * name, int64_t start, int64_t end);
+};
+
+// Per-zone statistics for the game. Durations go into a log-scale histogram
+// with 8 buckets per doubling, so that percentiles are cheap and within about 10%.
+struct ProfileStats
+{
+    static const int NBuckets = 8 * 24;         // up to about 16 seconds in microseconds
+
+    int count;
+    int64_t total;
+    int64_t max;
+    std::array<int, NBuckets> histogram;
+
+    ProfileStats();
+
+    void add(int64_t nanoseconds);
+    double percentileMilliseconds(double p) const;
+};
+
+class Profiler
+{
+private:
+    static std::atomic<bool> _enabled;
+
+    std::chrono::steady_clock::time_point _epoch;
+
+    std::mutex _threadsMutex;
+    std::mutex _namesMutex;
+    std::set<std::string> _names;               // built names, kept for the whole game
+    std::vector<std::unique_ptr<ProfileThread>> _threads;
+
+    // Names are literals, so the same name may appear at different addresses.
+    // Events are looked up by address, then merged by name for the summary.
+    std::map<const char *, ProfileStats> _stats;
+
+    std::ofstream _trace;
+    bool _traceStarted;
+
+    Profiler();
+
+    ProfileThread * registerThread();
+    void writeSummary();
+
+public:
+    static Profiler & Instance();
+
+    static bool Enabled() { return _enabled.load(std::memory_order_relaxed); };
+    static int64_t Now();
+    static ProfileThread & Thread();
+
+    // A zone name built at runtime, such as one per squad. Returns a stable pointer
+    // that outlives the caller, so that recorded events can refer to it after a squad is gone.
+    static const char * Name(const std::string & name);
+
+    // Call after the config file is parsed.
+    void initialize();
+
+    // Collect the events recorded since the last call. Call once per frame, from the main thread.
+    void endFrame();
+
+    // Write the trace trailer and the per-zone summary.
+    void onEnd();
+};
+
+// RAII zone: times its own lifetime.
+class ProfileZone
+{
+    const char * _name;
+    int64_t _start;
+
+public:
+    explicit ProfileZone(const char * name)
+        : _name(name)
+        , _start(Profiler::Enabled() ? Profiler::Now() : -1)
+    {
+    }
+
+    ~ProfileZone()
+    {
+        if (_start >= 0)
+        {
+            Profiler::Thread().record(_name, _start, Profiler::Now());
+        }
+    }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone & operator=(const ProfileZone &) = delete;
+};
+
+}
@@ -12,6 +12,11 @@ Random::Random()
     _rng = std::minstd_rand(seed());
 }
 
+Random::Random(unsigned int seed)
+    : _rng(seed)
+{
+}
+
 // Random floating point number in the range [0, r).
 double Random::range(double r)
 {
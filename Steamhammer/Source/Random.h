@@ -12,6 +12,7 @@ private:
 
 public:
     Random();
+    explicit Random(unsigned int seed);     // repeatable, for tests and benchmarks
 
     double range(double r);
     int index(int n);
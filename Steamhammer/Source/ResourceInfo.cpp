@@ -1,36 +1,23 @@
 #include "ResourceInfo.h"
 
+#include "The.h"
+
 using namespace UAlbertaBot;
 
 // Is the location of a mineral patch visible?
 // Used only when !initialUnit->isVisible() .
 bool ResourceInfo::isMineralVisible() const
 {
-    BWAPI::TilePosition xy = initialUnit->getInitialTilePosition();    // top left corner
-
-    // Mineral patch is 2x1 in size. Hand-unroll the loop.
-    return
-        BWAPI::Broodwar->isVisible(xy) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(1, 0));
+    // Mineral patch is 2x1 in size.
+    return the.creep.allVisible(initialUnit->getInitialTilePosition(), 2, 1);
 }
 
 // Is the location of a gas geyser visible?
 // Used only when !currentUnit->isVisible() .
 bool ResourceInfo::isGasVisible() const
 {
-    BWAPI::TilePosition xy = initialUnit->getInitialTilePosition();    // top left corner
-
-    // Geyser is 4x2 in size. Hand-unroll the loop.
-    return
-        BWAPI::Broodwar->isVisible(xy) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(1, 0)) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(2, 0)) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(3, 0)) &&
-
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(0, 1)) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(1, 1)) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(2, 1)) &&
-        BWAPI::Broodwar->isVisible(xy + BWAPI::TilePosition(3, 1));
+    // Geyser is 4x2 in size.
+    return the.creep.allVisible(initialUnit->getInitialTilePosition(), 4, 2);
 }
 
 // For gas geysers only. The associated unit changes when a refinery is destroyed.
@@ -346,7 +346,8 @@ void ScoutManager::moveGroundScout()
 
         UAB_ASSERT(enemyBase, "no enemy base");
 
-        int scoutDistanceToEnemy = the.map.getGroundTileDistance(_workerScout->getPosition(), enemyBase->getCenter());
+        int scoutDistanceToEnemy = the.map.getExactGroundTileDistance(
+            BWAPI::TilePosition(_workerScout->getPosition()), BWAPI::TilePosition(enemyBase->getCenter()));
         bool scoutInRangeOfenemy = scoutDistanceToEnemy <= scoutDistanceThreshold;
 
         int scoutHP = _workerScout->getHitPoints() + _workerScout->getShields();
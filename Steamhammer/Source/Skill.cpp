@@ -1,9 +1,26 @@
 #include "Skill.h"
 
+#include "The.h"
+
 using namespace UAlbertaBot;
 
+SkillEvent::SkillEvent(SkillEventType type)
+    : type(type)
+    , frame(the.now())
+    , player(nullptr)
+    , unit(nullptr)
+    , unitType(BWAPI::UnitTypes::None)
+    , position(BWAPI::Positions::None)
+    , upgrade(BWAPI::UpgradeTypes::None)
+    , value(0)
+{
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
 Skill::Skill(const std::string & name)
     : _name(name)
+    , _profileName("skill " + name)
     , _nextUpdateFrame(1)
 {
 }
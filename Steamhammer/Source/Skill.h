@@ -2,16 +2,48 @@
 
 #include <string>
 #include <iostream>
+#include <vector>
+
+#include <BWAPI.h>
 
 namespace UAlbertaBot
 {
 class GameRecord;
 
+// Game events that a skill can subscribe to.
+enum class SkillEventType
+    { UnitCreated
+    , UnitDestroyed
+    , UnitDiscovered        // came into view; as in BWAPI, may happen many times for one unit
+    , UnitMorphed
+    , BattleStarted         // the combat sim saw a battle bigger than any before; value = enemy supply
+    , UpgradeDone           // value = the new upgrade level
+    };
+
+typedef unsigned int SkillEventMask;
+
+inline SkillEventMask SkillEventBit(SkillEventType type) { return 1u << int(type); };
+
+struct SkillEvent
+{
+    SkillEventType type;
+    int frame;
+    BWAPI::Player player;
+    BWAPI::Unit unit;               // null for battles and upgrades
+    BWAPI::UnitType unitType;       // as of the event
+    BWAPI::Position position;
+    BWAPI::UpgradeType upgrade;
+    int value;
+
+    SkillEvent(SkillEventType type);
+};
+
 class Skill
 {
 protected:
 
     std::string _name;
+    std::string _profileName;       // for the profiler zone
     int _nextUpdateFrame;
 
 public:
@@ -19,6 +51,7 @@ public:
     Skill(const std::string & name);
 
     const std::string & getName() const { return _name; };
+    const char * getProfileName() const { return _profileName.c_str(); };
 
     // To save this game's data in the current game record, override this.
     // Any return other than the empty string will be recorded.
@@ -33,6 +66,14 @@ public:
     // Opponent model information has not been read in yet.
     virtual bool enabled() const = 0;
 
+    // The game events the skill wants, as a mask of SkillEventBit() values.
+    // Called once at startup.
+    virtual SkillEventMask subscriptions() const { return 0; };
+
+    // The subscribed events since the last call, oldest first.
+    // Called once per frame when there are any, before update() and whether or not update() is due.
+    virtual void onEvents(const std::vector<SkillEvent> & events) {};
+
     // Update any info that feasible(), good(), execute() may want to look at.
     // Also possibly take actions. Not all skills use execute().
     virtual void update() = 0;
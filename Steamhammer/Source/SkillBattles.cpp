@@ -19,6 +19,9 @@ static const int BattleSupplyThreshold[MaxBattles] = { 8, 20 };
 // We wait one update cycle in case it grows larger as more units come into view.
 static const int UpdateCycle = 3 * 24 + 1;
 
+// We expect no battle earlier than this.
+static const int FirstBattleFrame = 25 * 24;
+
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
 SkillBattles::BattleRecord::BattleRecord()
@@ -56,8 +59,8 @@ SkillBattles::SkillBattles()
     , gotOne(false)
     , nBattles(0)
 {
-    // We expect no battle earlier than this.
-    _nextUpdateFrame = 25 * 24;
+    // Update only when a battle event says there is something to record.
+    _nextUpdateFrame = INT_MAX;
 }
 
 // Use -1 as an end mark after each battle.
@@ -110,6 +113,25 @@ void SkillBattles::getData(GameRecord & r, const std::string & line)
     }
 }
 
+// A battle bigger than any before. If it is big enough, record it one cycle from now.
+void SkillBattles::onEvents(const std::vector<SkillEvent> & events)
+{
+    if (gotOne || nBattles >= MaxBattles)
+    {
+        return;
+    }
+
+    for (const SkillEvent & event : events)
+    {
+        if (event.value >= BattleSupplyThreshold[nBattles])
+        {
+            gotOne = true;
+            _nextUpdateFrame = std::max(the.now() + UpdateCycle, FirstBattleFrame);
+            return;
+        }
+    }
+}
+
 void SkillBattles::update()
 {
     if (gotOne)
@@ -118,16 +140,15 @@ void SkillBattles::update()
         gotOne = false;
         ++nBattles;
     }
-    else if (the.combatSim.getBiggestBattleEnemies().getSupply() >= BattleSupplyThreshold[nBattles])
-    {
-        gotOne = true;
-    }
 
-    if (nBattles >= MaxBattles)
+    // The biggest battle so far may already be big enough to be the next one.
+    if (nBattles < MaxBattles &&
+        the.combatSim.getBiggestBattleEnemies().getSupply() >= BattleSupplyThreshold[nBattles])
     {
-        _nextUpdateFrame = INT_MAX;     // never run again
+        gotOne = true;
+        _nextUpdateFrame = the.now() + UpdateCycle;
         return;
     }
 
-    _nextUpdateFrame = the.now() + UpdateCycle;
+    _nextUpdateFrame = INT_MAX;         // wait for the next battle event
 }
@@ -35,6 +35,9 @@ public:
     std::string putData() const;
     void getData(GameRecord & r, const std::string & line);
 
+    SkillEventMask subscriptions() const { return SkillEventBit(SkillEventType::BattleStarted); };
+    void onEvents(const std::vector<SkillEvent> & events);
+
     bool enabled() const   { return true;  };
     bool feasible() const  { return false; };
     bool good() const      { return false; };
@@ -1,5 +1,6 @@
 #include "SkillKit.h"
 
+#include "Profiler.h"
 #include "SkillBattles.h"
 #include "SkillGasSteal.h"
 #include "SkillLurkers.h"
@@ -9,12 +10,22 @@
 
 using namespace UAlbertaBot;
 
+// Skills run on their own schedules, each deciding when to update next.
+// Skills may also subscribe to game events, which are collected as they happen
+// and delivered to each skill in one batch per frame. Each skill's time is
+// recorded as a profiler zone named "skill <name>".
+
+// How often to look for finished upgrades, in frames. BWAPI has no upgrade event.
+static const int UpgradeCheckInterval = 24;
+
 // Usage: addSkill(new WhateverSkill).
 void SkillKit::addSkill(Skill * skill)
 {
     if (skill->enabled())
     {
         skills.push_back(skill);
+        subscriptions.push_back(skill->subscriptions());
+        allSubscriptions |= subscriptions.back();
     }
     else
     {
@@ -22,8 +33,78 @@ void SkillKit::addSkill(Skill * skill)
     }
 }
 
+// Post an event for each upgrade level that went up since the last check.
+void SkillKit::checkUpgrades()
+{
+    if (the.now() < nextUpgradeCheck)
+    {
+        return;
+    }
+    nextUpgradeCheck = the.now() + UpgradeCheckInterval;
+
+    const BWAPI::Player players[2] = { the.self(), the.enemy() };
+    for (int i = 0; i < 2; ++i)
+    {
+        std::vector<int> & levels = upgradeLevels[i];
+        levels.resize(BWAPI::UpgradeTypes::Enum::MAX, 0);
+        for (BWAPI::UpgradeType upgrade : BWAPI::UpgradeTypes::allUpgradeTypes())
+        {
+            const int level = players[i]->getUpgradeLevel(upgrade);
+            if (level > levels[upgrade.getID()])
+            {
+                levels[upgrade.getID()] = level;
+
+                SkillEvent event(SkillEventType::UpgradeDone);
+                event.player = players[i];
+                event.upgrade = upgrade;
+                event.value = level;
+                events.push_back(event);
+            }
+        }
+    }
+}
+
+// Give each skill its share of the events, in one call.
+void SkillKit::deliverEvents()
+{
+    if (events.empty())
+    {
+        return;
+    }
+
+    for (size_t i = 0; i < skills.size(); ++i)
+    {
+        if (!subscriptions[i])
+        {
+            continue;
+        }
+
+        batch.clear();
+        for (const SkillEvent & event : events)
+        {
+            if (subscriptions[i] & SkillEventBit(event.type))
+            {
+                batch.push_back(event);
+            }
+        }
+        if (!batch.empty())
+        {
+            ProfileZone zone(skills[i]->getProfileName());
+            skills[i]->onEvents(batch);
+        }
+    }
+
+    events.clear();
+}
+
 // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
 
+SkillKit::SkillKit()
+    : allSubscriptions(0)
+    , nextUpgradeCheck(0)
+{
+}
+
 // This happens before skill data is read, necessarily.
 void SkillKit::initialize()
 {
@@ -68,12 +149,42 @@ void SkillKit::write(std::ostream & out)
     }
 }
 
+void SkillKit::post(const SkillEvent & event)
+{
+    if (wants(event.type))
+    {
+        events.push_back(event);
+    }
+}
+
+void SkillKit::postUnitEvent(SkillEventType type, BWAPI::Unit unit)
+{
+    if (wants(type))
+    {
+        SkillEvent event(type);
+        event.player = unit->getPlayer();
+        event.unit = unit;
+        event.unitType = unit->getType();
+        event.position = unit->getPosition();
+        events.push_back(event);
+    }
+}
+
 void SkillKit::update()
 {
+    ProfileZone zone("SkillKit::update");
+
+    if (wants(SkillEventType::UpgradeDone))
+    {
+        checkUpgrades();
+    }
+    deliverEvents();
+
     for (Skill * skill : skills)
     {
         if (skill->nextUpdate() <= the.now())
         {
+            ProfileZone skillZone(skill->getProfileName());
             skill->update();
             if (skill->feasible() && skill->good())
             {
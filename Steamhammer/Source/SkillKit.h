@@ -12,16 +12,33 @@ class SkillKit
 {
 private:
     std::vector<Skill *> skills;
+    std::vector<SkillEventMask> subscriptions;      // parallel to skills
+    SkillEventMask allSubscriptions;
+
+    std::vector<SkillEvent> events;                 // posted since the last delivery
+    std::vector<SkillEvent> batch;                  // scratch, one skill's share of the events
+
+    std::vector<int> upgradeLevels[2];              // us, enemy, by upgrade type ID
+    int nextUpgradeCheck;
 
     void addSkill(Skill * skill);
+    void checkUpgrades();
+    void deliverEvents();
 
 public:
 
+    SkillKit();
+
     void initialize();
     
     void read(GameRecord & r, const std::string & line);
     void write(std::ostream & out);
 
+    // Events are kept only if some skill subscribes to them.
+    bool wants(SkillEventType type) const { return (allSubscriptions & SkillEventBit(type)) != 0; };
+    void post(const SkillEvent & event);
+    void postUnitEvent(SkillEventType type, BWAPI::Unit unit);
+
     void update();
 
     void draw() const;
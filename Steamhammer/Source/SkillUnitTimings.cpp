@@ -14,8 +14,8 @@ using namespace UAlbertaBot;
 SkillUnitTimings::SkillUnitTimings()
     : Skill("unit timings")
 {
-    // We should not see any enemy units before this. (Maybe on a tiny map.)
-    _nextUpdateFrame = 20 * 24;
+    // Everything happens in onEvents().
+    _nextUpdateFrame = INT_MAX;
 }
 
 std::string SkillUnitTimings::putData() const
@@ -48,23 +48,28 @@ void SkillUnitTimings::getData(const std::string & line)
 
 // Positive frame values are scouting times.
 // Negative frame values are building completion times, negated. Negation is just a flag.
-void SkillUnitTimings::update()
+// An enemy unit type can first appear when a unit comes into view or when a visible unit morphs.
+void SkillUnitTimings::onEvents(const std::vector<SkillEvent> & events)
 {
-    for (const auto & kv : the.info.getUnitData(the.enemy()).getUnits())
+    const std::map<BWAPI::Unit, UnitInfo> & enemyUnits = the.info.getUnitData(the.enemy()).getUnits();
+
+    for (const SkillEvent & event : events)
     {
-        const UnitInfo & ui(kv.second);
+        if (event.player != the.enemy() || timings.find(event.unitType) != timings.end())
+        {
+            continue;
+        }
 
-        auto it = timings.find(ui.type);
-        if (it == timings.end())
+        int frame = event.frame;
+        if (event.unitType.isBuilding())
         {
-            int frame = ui.updateFrame;
-            if (ui.type.isBuilding() && !ui.completed)
+            // The completion prediction is in the unit info, which is updated before skills.
+            auto it = enemyUnits.find(event.unit);
+            if (it != enemyUnits.end() && it->second.type == event.unitType && !it->second.completed)
             {
-                frame = -ui.completeBy;
+                frame = -it->second.completeBy;
             }
-            timings.insert(std::pair<BWAPI::UnitType, int>(ui.type, frame));
         }
+        timings.insert(std::pair<BWAPI::UnitType, int>(event.unitType, frame));
     }
-
-    _nextUpdateFrame = the.now() + 23;
 }
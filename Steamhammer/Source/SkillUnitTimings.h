@@ -19,11 +19,17 @@ public:
     std::string putData() const;
     void getData(const std::string & line);
 
+    SkillEventMask subscriptions() const
+    {
+        return SkillEventBit(SkillEventType::UnitDiscovered) | SkillEventBit(SkillEventType::UnitMorphed);
+    };
+    void onEvents(const std::vector<SkillEvent> & events);
+
     bool enabled() const   { return true;  };
     bool feasible() const  { return false; };
     bool good() const      { return false; };
     void execute()         { };
-    void update();
+    void update()          { };
 
     const std::map<BWAPI::UnitType, int> &                getTimings()     const { return timings;     };
     const std::vector< std::map<BWAPI::UnitType, int> > & getPastTimings() const { return pastTimings; };
@@ -1,8 +1,10 @@
 #include "Squad.h"
 
+#include <algorithm>
 #include "Bases.h"
 #include "CombatSimulation.h"
 #include "MapTools.h"
+#include "Profiler.h"
 #include "SquadOrder.h"
 #include "StrategyManager.h"
 #include "The.h"
@@ -12,6 +14,7 @@ using namespace UAlbertaBot;
 
 Squad::Squad()
     : _name("Default")
+    , _profileName(nullptr)
     , _combatSquad(false)
     , _combatSimRadius(Config::Micro::CombatSimRadius)
     , _fightVisibleOnly(false)
@@ -31,6 +34,7 @@ Squad::Squad()
     , _regroupPosition(BWAPI::Positions::Invalid)
 {
     setOrderForMicroManagers();
+    setProfileNames();
 }
 
 // A "combat" squad is any squad except the Idle squad and Overlord squad.
@@ -38,6 +42,7 @@ Squad::Squad()
 // another squad, we have to notify WorkerManager.
 Squad::Squad(const std::string & name, size_t priority)
     : _name(name)
+    , _profileName(nullptr)
     , _combatSquad(name != "Idle" && name != "Overlord")
     , _combatSimRadius(Config::Micro::CombatSimRadius)
     , _fightVisibleOnly(false)
@@ -57,6 +62,7 @@ Squad::Squad(const std::string & name, size_t priority)
     , _regroupPosition(BWAPI::Positions::Invalid)
 {
     setOrderForMicroManagers();
+    setProfileNames();
 }
 
 Squad::~Squad()
@@ -66,6 +72,8 @@ Squad::~Squad()
 
 void Squad::update()
 {
+    ProfileZone zone(_profileName);
+
     updateUnits();
 
     // The Irradiated squad.
@@ -590,6 +598,30 @@ void Squad::setOrderForMicroManagers()
     _microTransports.setOrder(_order);
 }
 
+// Profile each squad and each of its micro managers under its own name.
+// Spaces become underscores, to keep the columns of the profile summary intact.
+void Squad::setProfileNames()
+{
+    std::string name(_name);
+    std::replace(name.begin(), name.end(), ' ', '_');
+
+    _profileName = Profiler::Name("Squad::update/" + name);
+    _microIrradiated.setProfileName(name + "/MicroIrradiated");
+    _microOverlords.setProfileName(name + "/MicroOverlords");
+    _microAirToAir.setProfileName(name + "/MicroAirToAir");
+    _microMelee.setProfileName(name + "/MicroMelee");
+    _microRanged.setProfileName(name + "/MicroRanged");
+    _microDefilers.setProfileName(name + "/MicroDefilers");
+    _microDetectors.setProfileName(name + "/MicroDetectors");
+    _microHighTemplar.setProfileName(name + "/MicroHighTemplar");
+    _microLurkers.setProfileName(name + "/MicroLurkers");
+    _microMedics.setProfileName(name + "/MicroMedics");
+    _microQueens.setProfileName(name + "/MicroQueens");
+    _microScourge.setProfileName(name + "/MicroScourge");
+    _microTanks.setProfileName(name + "/MicroTanks");
+    _microTransports.setProfileName(name + "/MicroTransports");
+}
+
 void Squad::addUnitsToMicroManagers()
 {
     BWAPI::Unitset irradiatedUnits;
@@ -1176,8 +1208,8 @@ BWAPI::Unit Squad::unitClosestToPosition(const BWAPI::Position & pos, const BWAP
         if (_hasGround)
         {
             // A ground or air-ground group. Use ground distance.
-            // It is -1 if no ground path exists.
-            dist = the.map.getGroundDistance(unit->getPosition(), pos);
+            // It is -1 if no ground path exists. Exact, since we rank the units by it.
+            dist = the.map.getExactGroundDistance(unit->getPosition(), pos);
         }
         else
         {
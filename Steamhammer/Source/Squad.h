@@ -26,6 +26,7 @@ namespace UAlbertaBot
 class Squad
 {
     std::string         _name;
+    const char *        _profileName;       // for the profiler zone, one per squad
     BWAPI::Unitset      _units;
     bool				_combatSquad;
     int					_combatSimRadius;
@@ -82,6 +83,7 @@ class Squad
     void			setNearEnemyUnits();
     void			setAllUnits();
     void            setOrderForMicroManagers();
+    void            setProfileNames();
 
     void			setClusterStatus(UnitCluster & cluster);
     void            setLastAttackRetreat();
@@ -2,6 +2,7 @@
 
 #include "Base.h"
 #include "GridDistances.h"
+#include "The.h"
 
 using namespace UAlbertaBot;
 
@@ -13,74 +14,9 @@ SquadOrder::SquadOrder()
     , _base(nullptr)
     , _radius(0)
     , _status("Default")
-    , _distances(nullptr)
 {
 }
 
-// The copy constructor can be expensive if _distances is set. Try to minimize use.
-SquadOrder::SquadOrder(const SquadOrder & source) 
-    : _type(source._type)
-    , _position(source._position)
-    , _base(source._base)
-    , _radius(source._radius)
-    , _key(source._key)
-    , _status(source._status)
-    , _distances(source._distances == nullptr ? nullptr : new GridDistances(*_distances))
-{
-}
-
-// Copy assignment operator.
-SquadOrder & SquadOrder::operator=(const SquadOrder & source)
-{
-    // Self-assignment is a special case, since C++ is a low-level language.
-    if (&source != this)
-    {
-        _type = source._type;
-        _position = source._position;
-        _base = source._base;
-        _radius = source._radius;
-        _key = source._key;
-        _status = source._status;
-        _distances = source._distances == nullptr ? nullptr : new GridDistances(*_distances);
-    }
-    return *this;
-}
-
-// The move constructor must leave the source in an "unspecified but valid" state.
-SquadOrder::SquadOrder(SquadOrder && source) 
-    : _type(source._type)
-    , _position(source._position)
-    , _base(source._base)
-    , _radius(source._radius)
-    , _key(source._key)
-    , _status(source._status)
-    , _distances(source._distances)
-{
-    // Make the source valid, don't double-release the distances.
-    source._distances = nullptr;
-}
-
-// Move assignment operator.
-SquadOrder & SquadOrder::operator=(SquadOrder && source)
-{
-    // Self-assignment is a special case, since C++ is a low-level language.
-    if (&source != this)
-    {
-        delete _distances;
-
-        _type = source._type;
-        _position = source._position;
-        _base = source._base;
-        _radius = source._radius;
-        _key = source._key;
-        _status = source._status;
-        _distances = source._distances;
-
-        source._distances = nullptr;
-    }
-    return *this;
-}
-
 // For squads whose behavior is decided by code rather than by the squad order,
 // or which have not yet been given their first real order.
 SquadOrder::SquadOrder(const std::string & status) 
@@ -89,7 +25,6 @@ SquadOrder::SquadOrder(const std::string & status)
     , _base(nullptr)
     , _radius(0)
     , _status(status)
-    , _distances(nullptr)
 {
 }
 
@@ -100,18 +35,18 @@ SquadOrder::SquadOrder(SquadOrderTypes type, BWAPI::Position position, int radiu
     , _base(nullptr)
     , _radius(radius)
     , _status(status)
-    , _distances(useDistances && position.isValid() ? new GridDistances(BWAPI::TilePosition(position)) : nullptr)
+    , _distances(useDistances && position.isValid() ? the.flowFields.get(BWAPI::TilePosition(position)) : nullptr)
 {
 }
 
-// Calculate distances on the spot.
+// Use the shared distances to the position, calculating them if needed.
 SquadOrder::SquadOrder(SquadOrderTypes type, BWAPI::Position position, int radius, const std::string & status) 
     : _type(type)
     , _position(position)
     , _base(nullptr)
     , _radius(radius)
     , _status(status)
-    , _distances(position.isValid() ? new GridDistances(BWAPI::TilePosition(position)) : nullptr)
+    , _distances(position.isValid() ? the.flowFields.get(BWAPI::TilePosition(position)) : nullptr)
 {
 }
 
@@ -124,16 +59,10 @@ SquadOrder::SquadOrder(SquadOrderTypes type, Base * base, int radius, bool useDi
     , _base(useDistances ? base : nullptr)
     , _radius(radius)
     , _status(status)
-    , _distances(nullptr)
 {
     UAB_ASSERT(base, "baseless");
 }
 
-SquadOrder::~SquadOrder()
-{
-    delete _distances;      // not always set
-}
-
 // Most stuff is irrelevant in deciding whether two orders are equivalent.
 bool SquadOrder::operator==(const SquadOrder& o)
 {
@@ -147,13 +76,11 @@ bool SquadOrder::operator!=(const SquadOrder& o)
     return !(*this == o);
 }
 
-// The distances that we want to use. May be null to use none, otherwise must have been
-// allocated with `new GridDistances`.
+// The distances that we want to use. May be null to use none.
 // Clear _base, since we don't want to use its distances.
-void SquadOrder::setDistances(GridDistances * distances)
+void SquadOrder::setDistances(const std::shared_ptr<const GridDistances> & distances)
 {
     _base = nullptr;
-    delete _distances;
     _distances = distances;
 }
 
@@ -239,7 +166,7 @@ const GridDistances * SquadOrder::distances() const
 {
     if (_distances)
     {
-        return _distances;
+        return _distances.get();
     }
 
     if (_base)
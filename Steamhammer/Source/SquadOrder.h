@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <memory>
 #include <BWAPI.h>
 
 namespace UAlbertaBot
@@ -35,26 +36,22 @@ class SquadOrder
 
     // Ground distances, set for ground squads when _base is not set.
     // distance() uses _base if set, else _distances if it is set.
-    GridDistances *     _distances;
+    // Shared with other orders to the same tile, so copying an order is cheap.
+    std::shared_ptr<const GridDistances> _distances;
 
 public:
 
     SquadOrder();
-    SquadOrder(const SquadOrder & source);              // no copy constructor, expensive if _distances is set
-    SquadOrder & operator=(const SquadOrder & source);  // no copy assignment
-    SquadOrder(SquadOrder && source);                   // move constructor
-    SquadOrder & operator=(SquadOrder && source);       // move assignment
     SquadOrder(const std::string & status);
     SquadOrder(SquadOrderTypes type, BWAPI::Position position, int radius, const std::string & status = "Default");
     SquadOrder(SquadOrderTypes type, BWAPI::Position position, int radius, bool useDistances, const std::string & status = "Default");
     SquadOrder(SquadOrderTypes type, Base * base, int radius, bool useDistances, const std::string & status = "Default");
-    ~SquadOrder();
 
     bool operator==(const SquadOrder & o);
     bool operator!=(const SquadOrder & o);
 
     // And clear _base, since we don't want to use its distances.
-    void setDistances(GridDistances * distances);
+    void setDistances(const std::shared_ptr<const GridDistances> & distances);
 
     SquadOrderTypes getType() const;
     const BWAPI::Position & getPosition() const;
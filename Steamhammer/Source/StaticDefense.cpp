@@ -4,6 +4,7 @@
 #include "BuildingManager.h"
 #include "MacroAct.h"
 #include "ProductionManager.h"
+#include "Profiler.h"
 #include "The.h"
 #include "UnitUtil.h"
 
@@ -896,6 +897,8 @@ StaticDefense::StaticDefense()
 
 void StaticDefense::update()
 {
+    ProfileZone zone("StaticDefense::update");
+
     int phase = the.now() % 29;
 
     if (phase == 1)
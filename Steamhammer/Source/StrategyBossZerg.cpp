@@ -1488,15 +1488,14 @@ void StrategyBossZerg::makeUrgentReaction(BuildOrderQueue & queue)
         {
             if (base->isMyCompletedBase())
             {
-                BWAPI::Unitset bunkers =
-                    BWAPI::Broodwar->getUnitsInRadius(base->getCenter(), 7 * 32,
+                the.unitIndex.getUnitsInRadius(_nearbyUnits, base->getCenter(), 7 * 32,
                     BWAPI::Filter::GetType == BWAPI::UnitTypes::Terran_Bunker && BWAPI::Filter::IsEnemy);
                 // If there is more than one bunker, it may be hopeless. It's definitely more complicated.
-                if (bunkers.size() == 1)
+                if (_nearbyUnits.size() == 1)
                 {
-                    BWAPI::Unit bunker = *bunkers.begin();
+                    BWAPI::Unit bunker = _nearbyUnits.front();
                     // If we already made a sunken here, we're done.
-                    if (nullptr == BWAPI::Broodwar->getClosestUnit(
+                    if (nullptr == the.unitIndex.getClosestUnit(
                         bunker->getPosition(),
                         BWAPI::Filter::GetType == BWAPI::UnitTypes::Zerg_Sunken_Colony && BWAPI::Filter::IsOwned,
                         7 * 32 + 16))
@@ -1527,7 +1526,7 @@ void StrategyBossZerg::makeUrgentReaction(BuildOrderQueue & queue)
             if (base->isMyCompletedBase())
             {
                 BWAPI::Unit cannon =
-                    BWAPI::Broodwar->getClosestUnit(base->getCenter(),
+                    the.unitIndex.getClosestUnit(base->getCenter(),
                     BWAPI::Filter::GetType == BWAPI::UnitTypes::Protoss_Photon_Cannon && BWAPI::Filter::IsEnemy,
                     14 * 32);
                 if (cannon)
@@ -70,6 +70,9 @@ class StrategyBossZerg
     int _pendingSupply;
     int _supplyUsed;
 
+    // Reusable result buffer for the.unitIndex queries.
+    std::vector<BWAPI::Unit> _nearbyUnits;
+
     int _lastUpdateFrame;
     int minerals;
     int gas;
@@ -89,6 +89,32 @@ void StrategyManager::addStrategy(const std::string & name, Strategy & strategy)
     _strategies[name] = strategy;
 }
 
+// Parse the build order of the chosen opening into MacroActs.
+// Parsing is slow, so the other openings are left as strings.
+void StrategyManager::expandOpening()
+{
+    auto strategyIt = _strategies.find(Config::Strategy::StrategyName);
+    if (strategyIt == std::end(_strategies))
+    {
+        return;
+    }
+
+    Strategy & strategy = (*strategyIt).second;
+    strategy._buildOrder = BuildOrder(strategy._race);
+    for (size_t i = 0; i < strategy._buildItems.size(); ++i)
+    {
+        // Counts like "6 x mutalisk" were spelled out; parse each repeated item once.
+        if (i > 0 && strategy._buildItems[i] == strategy._buildItems[i - 1])
+        {
+            strategy._buildOrder.add(strategy._buildOrder[i - 1]);
+        }
+        else
+        {
+            strategy._buildOrder.add(MacroAct(strategy._buildItems[i]));
+        }
+    }
+}
+
 // Set _openingGroup depending on the current strategy, which in principle
 // might be from the config file or from opening learning.
 // This is part of initialization; it happens early on.
@@ -16,7 +16,8 @@ struct Strategy
     std::string _name;
     BWAPI::Race _race;
     std::string _openingGroup;
-    BuildOrder  _buildOrder;
+    std::vector<std::string> _buildItems;
+    BuildOrder  _buildOrder;        // filled in from _buildItems for the chosen opening only
 
     Strategy()
         : _name("None")
@@ -25,11 +26,12 @@ struct Strategy
     {
     }
 
-    Strategy(const std::string & name, const BWAPI::Race & race, const std::string & openingGroup, const BuildOrder & buildOrder)
+    Strategy(const std::string & name, const BWAPI::Race & race, const std::string & openingGroup, const std::vector<std::string> & buildItems)
         : _name(name)
         , _race(race)
         , _openingGroup(openingGroup)
-        , _buildOrder(buildOrder)
+        , _buildItems(buildItems)
+        , _buildOrder(race)
     {
     }
 };
@@ -64,6 +66,7 @@ public:
     static	StrategyManager &	    Instance();
 
             void                    addStrategy(const std::string & name, Strategy & strategy);
+            void                    expandOpening();
             void					setOpeningGroup();
     const	std::string &			getOpeningGroup() const;
     const	MetaPairVector		    getBuildOrderGoal();
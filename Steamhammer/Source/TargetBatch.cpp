@@ -0,0 +1,131 @@
+#include "TargetBatch.h"
+
+#include "The.h"
+#include "UnitUtil.h"
+
+using namespace UAlbertaBot;
+
+// The largest unit half-width or half-height, plus slack. Used to turn an edge-to-edge
+// distance into a safe bound on the distance between unit centers.
+static const int SizeMargin = 3 * 32;
+
+TargetInfo::TargetInfo(BWAPI::Unit target, const BWAPI::Position & goal)
+    : unit(target)
+    , type(target->getType())
+    , position(target->getPosition())
+    , distanceToGoal(target->getDistance(goal))
+    , hp(target->getHitPoints() + target->getShields())
+    , assignedDamage(0)
+    , acidSpores(target->getAcidSporeCount())
+    , topSpeed(target->getPlayer()->topSpeed(target->getType()))
+    , flying(target->isFlying())
+    , underDarkSwarm(target->isUnderDarkSwarm())
+    , underStorm(target->isUnderStorm())
+    , moving(target->isMoving())
+    , braking(target->isBraking())
+    , sieging(
+        target->isSieged() ||
+        target->getOrder() == BWAPI::Orders::Sieging ||
+        target->getOrder() == BWAPI::Orders::Unsieging)
+    , burrowed(target->isBurrowed())
+    , shieldsDown(target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() <= 5)
+    , noShields(target->getType().getRace() == BWAPI::Races::Protoss && target->getShields() == 0)
+    , hurt(target->getHitPoints() < target->getType().maxHitPoints())
+    , inGroundAttacks(the.groundAttacks.inRange(target))
+    , inAirAttacks(the.airAttacks.inRange(target))
+    , canAttackGround(UnitUtil::CanAttackGround(target))
+    , canAttackAir(UnitUtil::CanAttackAir(target))
+{
+}
+
+AttackerInfo::AttackerInfo(BWAPI::Unit attacker, const BWAPI::Position & goal)
+    : unit(attacker)
+    , type(attacker->getType())
+    , distanceToGoal(attacker->getDistance(goal))
+    , topSpeed(attacker->getPlayer()->topSpeed(attacker->getType()))
+    , flying(attacker->isFlying())
+{
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+TargetBatch::TargetBatch(const BWAPI::Unitset & targets, const BWAPI::Position & goal,
+    PriorityFunction priority, int threatMargin, bool trackDamage)
+    : _priority(priority)
+    , _threatMargin(threatMargin)
+    , _trackDamage(trackDamage)
+{
+    _targets.reserve(targets.size());
+    for (BWAPI::Unit target : targets)
+    {
+        _targets.push_back(TargetInfo(target, goal));
+    }
+
+    std::sort(_targets.begin(), _targets.end(), [](const TargetInfo & a, const TargetInfo & b)
+    {
+        return a.position.x < b.position.x;
+    });
+}
+
+// The cache holds one row per attacker type. Usually there are only one or two types.
+int TargetBatch::attackerTypeIndex(BWAPI::UnitType type)
+{
+    for (size_t i = 0; i < _attackerTypes.size(); ++i)
+    {
+        if (_attackerTypes[i] == type)
+        {
+            return int(i);
+        }
+    }
+
+    _attackerTypes.push_back(type);
+    _priorityCache.resize(_attackerTypes.size() * _targets.size() * 2, -1);
+    return int(_attackerTypes.size()) - 1;
+}
+
+void TargetBatch::candidates(BWAPI::Unit attacker, int maxRange, std::vector<TargetInfo *> & result)
+{
+    result.clear();
+
+    const BWAPI::Position pos = attacker->getPosition();
+    const int reach = maxRange + SizeMargin;
+
+    auto it = std::lower_bound(_targets.begin(), _targets.end(), pos.x - reach,
+        [](const TargetInfo & t, int x) { return t.position.x < x; });
+
+    for (; it != _targets.end() && it->position.x <= pos.x + reach; ++it)
+    {
+        if (std::abs(it->position.y - pos.y) <= reach)
+        {
+            result.push_back(&*it);
+        }
+    }
+}
+
+// The distance is passed in because the caller has already computed it.
+int TargetBatch::priority(const AttackerInfo & attacker, const TargetInfo & target, int distance)
+{
+    const bool outsideThreat = distance > _threatMargin + UnitUtil::GetAttackRange(target.unit, attacker.unit);
+
+    const size_t targetIndex = &target - &_targets[0];
+    const size_t slot = (attackerTypeIndex(attacker.type) * _targets.size() + targetIndex) * 2 + (outsideThreat ? 1 : 0);
+
+    int & p = _priorityCache[slot];
+    if (p < 0)
+    {
+        p = _priority(attacker.type, target.unit, outsideThreat);
+    }
+    return p;
+}
+
+void TargetBatch::assign(const AttackerInfo & attacker, TargetInfo & target)
+{
+    if (_trackDamage)
+    {
+        BWAPI::WeaponType weapon = UnitUtil::GetWeapon(attacker.unit, target.unit);
+        if (weapon != BWAPI::WeaponTypes::None)
+        {
+            target.assignedDamage += attacker.unit->getPlayer()->damage(weapon);
+        }
+    }
+}
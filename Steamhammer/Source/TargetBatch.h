@@ -0,0 +1,92 @@
+#pragma once
+
+#include <functional>
+
+#include "Common.h"
+
+namespace UAlbertaBot
+{
+// Facts about one potential target which do not depend on the attacker.
+// Computed once per batch, not once per attacker-target pair.
+struct TargetInfo
+{
+    BWAPI::Unit     unit;
+    BWAPI::UnitType type;
+    BWAPI::Position position;
+    int             distanceToGoal;     // from the target to the order position
+    int             hp;                 // hit points + shields
+    int             assignedDamage;     // one volley from each attacker assigned to it so far
+    int             acidSpores;
+    double          topSpeed;
+    bool            flying;
+    bool            underDarkSwarm;
+    bool            underStorm;
+    bool            moving;
+    bool            braking;
+    bool            sieging;            // sieged, or sieging or unsieging
+    bool            burrowed;
+    bool            shieldsDown;        // protoss with shields <= 5
+    bool            noShields;          // protoss with no shields at all
+    bool            hurt;               // hit points below max
+    bool            inGroundAttacks;    // inside enemy static defense range vs. ground
+    bool            inAirAttacks;       // inside enemy static defense range vs. air
+    bool            canAttackGround;
+    bool            canAttackAir;
+
+    TargetInfo(BWAPI::Unit target, const BWAPI::Position & goal);
+
+    bool overkilled() const { return assignedDamage >= hp; };
+};
+
+// Facts about one attacker, computed once per attacker.
+struct AttackerInfo
+{
+    BWAPI::Unit     unit;
+    BWAPI::UnitType type;
+    int             distanceToGoal;     // from the attacker to the order position
+    double          topSpeed;
+    bool            flying;
+
+    AttackerInfo(BWAPI::Unit attacker, const BWAPI::Position & goal);
+};
+
+// Target selection for a group of attackers against a common set of targets.
+// Per-target features are computed once. Each attacker looks only at targets that are
+// spatially near it. Attack priorities depend on the attacker's type and on whether it
+// is outside the target's threat range, so they are cached on that key.
+// Optionally, track the damage already aimed at each target, so that callers can
+// avoid overkill.
+class TargetBatch
+{
+public:
+    // Priority of the target for an attacker of the given type.
+    // outsideThreat is true if the attacker is beyond the target's attack range plus the batch's margin.
+    typedef std::function<int(BWAPI::UnitType attackerType, BWAPI::Unit target, bool outsideThreat)> PriorityFunction;
+
+private:
+    std::vector<TargetInfo>         _targets;           // sorted by x coordinate
+    PriorityFunction                _priority;
+    int                             _threatMargin;
+    bool                            _trackDamage;
+
+    std::vector<BWAPI::UnitType>    _attackerTypes;     // attacker types seen so far, index into the cache
+    std::vector<int>                _priorityCache;     // [attacker type][target][outsideThreat], -1 = unknown
+
+    int                             attackerTypeIndex(BWAPI::UnitType type);
+
+public:
+    TargetBatch(const BWAPI::Unitset & targets, const BWAPI::Position & goal,
+        PriorityFunction priority, int threatMargin, bool trackDamage);
+
+    bool empty() const { return _targets.empty(); };
+
+    // The targets which may be within maxRange of the attacker (edge to edge).
+    // This is a conservative bounding box test; the caller checks the exact distance.
+    void candidates(BWAPI::Unit attacker, int maxRange, std::vector<TargetInfo *> & result);
+
+    int priority(const AttackerInfo & attacker, const TargetInfo & target, int distance);
+
+    // The attacker has chosen this target.
+    void assign(const AttackerInfo & attacker, TargetInfo & target);
+};
+}
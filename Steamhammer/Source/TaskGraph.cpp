@@ -0,0 +1,128 @@
+#include "TaskGraph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "UABAssert.h"
+
+using namespace UAlbertaBot;
+
+namespace
+{
+    int ThreadCount(int nThreads, int maxUseful)
+    {
+        if (nThreads <= 0)
+        {
+            nThreads = std::max(1, int(std::thread::hardware_concurrency()));
+        }
+        return std::max(1, std::min(nThreads, maxUseful));
+    }
+}
+
+TaskGraph::TaskID TaskGraph::add(const std::function<void()> & work, std::initializer_list<TaskID> after)
+{
+    const TaskID id = TaskID(_tasks.size());
+
+    Task task;
+    task.work = work;
+    task.waitingFor = 0;
+    _tasks.push_back(task);
+
+    for (TaskID before : after)
+    {
+        UAB_ASSERT(before >= 0 && before < id, "bad task dependency");
+        _tasks[before].dependents.push_back(id);
+        ++_tasks[id].waitingFor;
+    }
+
+    return id;
+}
+
+// The ready queue is protected by a mutex. Tasks are coarse, so contention is not a concern.
+void TaskGraph::run(int nThreads)
+{
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<TaskID> ready;
+    size_t finished = 0;
+
+    for (TaskID id = 0; id < TaskID(_tasks.size()); ++id)
+    {
+        if (_tasks[id].waitingFor == 0)
+        {
+            ready.push_back(id);
+        }
+    }
+
+    const auto worker = [&]()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            changed.wait(lock, [&]() { return !ready.empty() || finished == _tasks.size(); });
+            if (ready.empty())
+            {
+                return;
+            }
+
+            const TaskID id = ready.front();
+            ready.pop_front();
+
+            lock.unlock();
+            _tasks[id].work();
+            lock.lock();
+
+            ++finished;
+            for (TaskID next : _tasks[id].dependents)
+            {
+                if (--_tasks[next].waitingFor == 0)
+                {
+                    ready.push_back(next);
+                }
+            }
+            changed.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < ThreadCount(nThreads, int(_tasks.size())); ++i)
+    {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+
+    _tasks.clear();
+}
+
+// Each thread claims the next index until they run out.
+void TaskGraph::ParallelFor(int n, const std::function<void(int)> & work, int nThreads)
+{
+    std::atomic<int> next(0);
+
+    const auto worker = [&]()
+    {
+        for (int i = next++; i < n; i = next++)
+        {
+            work(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < ThreadCount(nThreads, n); ++i)
+    {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::thread & thread : threads)
+    {
+        thread.join();
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+// Run a set of tasks with dependencies on a pool of threads.
+// Each task starts after all the tasks it depends on have finished. Independent tasks run
+// at the same time. The calling thread works too, and run() returns when every task is done.
+// Used at startup for the map analysis, when the game waits for onStart() to return.
+
+// A task may read BWAPI's static map data and the results of the tasks it depends on.
+// It must not issue commands or draw: BWAPI does those only on the game thread.
+
+namespace UAlbertaBot
+{
+class TaskGraph
+{
+public:
+    typedef int TaskID;
+
+private:
+    struct Task
+    {
+        std::function<void()> work;
+        std::vector<TaskID> dependents;     // tasks waiting for this one
+        int waitingFor;                     // count of unfinished tasks this one depends on
+    };
+
+    std::vector<Task> _tasks;
+
+public:
+    // Add a task to run after the given tasks, which must already be added.
+    TaskID add(const std::function<void()> & work, std::initializer_list<TaskID> after = {});
+
+    // Run all the tasks. 0 threads means one per hardware thread.
+    void run(int nThreads = 0);
+
+    // Run work(0) through work(n-1) in parallel, in no particular order.
+    static void ParallelFor(int n, const std::function<void(int)> & work, int nThreads = 0);
+};
+
+}
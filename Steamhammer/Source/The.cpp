@@ -3,12 +3,16 @@
 
 #include "Bases.h"
 #include "InformationManager.h"
+#include "Logger.h"
+#include "MapCache.h"
 #include "MapGrid.h"
 #include "OpeningTiming.h"
 #include "ParseUtils.h"
 #include "ProductionManager.h"
 #include "Random.h"
 #include "StaticDefense.h"
+#include "TaskGraph.h"
+#include "UnitUtil.h"
 
 using namespace UAlbertaBot;
 
@@ -31,15 +35,49 @@ void The::initialize()
 {
     _selfRace = BWAPI::Broodwar->self()->getRace();
 
-    // The order of initialization is important because of dependencies.
-    partitions.initialize();
-    inset.initialize();				// depends on partitions
-    vWalkRoom.initialize();			// depends on edgeRange
-    tileRoom.initialize();			// depends on vWalkRoom
-    zone.initialize();				// depends on tileRoom
-    map.initialize();
+    UnitUtil::InitializeAttackTables();
+    unitIndex.initialize();
+    creep.initialize();
+
+    // The static map analysis is the same every time the map is played. Read it from the
+    // map cache if we can. The config file is not parsed yet, so these are the default directories.
+    const std::string mapCacheFile = MapCache::Filename();
+    const bool mapCached =
+        MapCache::Read(Config::IO::ReadDir + mapCacheFile) ||
+        MapCache::Read(Config::IO::WriteDir + mapCacheFile);
+
+    // The map analysis steps run in parallel where their dependencies allow.
+    // Bases runs alongside the chain from inset to zone, which it does not need.
+    TaskGraph analysis;
+    if (mapCached)
+    {
+        analysis.add([this]() { bases.initialize(); });         // uses the cached base positions
+        analysis.add([this]() { zoneGraph.initialize(); });
+        analysis.add([this]() { nearest.initialize(); });
+    }
+    else
+    {
+        const TaskGraph::TaskID partitionsTask = analysis.add([this]() { partitions.initialize(); });
+        const TaskGraph::TaskID insetTask = analysis.add([this]() { inset.initialize(); }, { partitionsTask });
+        const TaskGraph::TaskID roomTask = analysis.add([this]() { vWalkRoom.initialize(); }, { insetTask });
+        const TaskGraph::TaskID tileRoomTask = analysis.add([this]() { tileRoom.initialize(); }, { roomTask });
+        const TaskGraph::TaskID zoneTask = analysis.add([this]() { zone.initialize(); }, { tileRoomTask });
+        const TaskGraph::TaskID mapTask = analysis.add([this]() { map.initialize(); });
+        analysis.add([this]() { bases.initialize(); }, { partitionsTask, mapTask });
+        analysis.add([this]() { zoneGraph.initialize(); }, { zoneTask, mapTask });
+        analysis.add([this]() { nearest.initialize(); }, { mapTask });
+    }
+    analysis.run();
+
+    if (bases.hadResourceError())
+    {
+        Logger::LogAppendToFileNow(Config::IO::ErrorLogFilename, "Bases: failed to remove any resources\n");
+    }
 
-    bases.initialize();             // depends on map
+    if (!mapCached)
+    {
+        MapCache::Write(Config::IO::WriteDir + mapCacheFile);
+    }
     info.initialize();              // depends on bases
     placer.initialize();
     ops.initialize();
@@ -74,6 +112,9 @@ int The::attacks(BWAPI::Unit unit) const
 
 void The::update()
 {
+    UnitUtil::UpdateAttackTables();
+    unitIndex.update();
+
     my.completed.takeSelf();
     my.all.takeSelfAll();
     your.seen.takeEnemy();
@@ -84,6 +125,7 @@ void The::update()
     {
         groundAttacks.update();
         airAttacks.update();
+        safeAirPaths.update();
     }
 
     ops.update();
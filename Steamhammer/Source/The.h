@@ -2,7 +2,10 @@
 
 #include "BuildingPlacer.h"
 #include "CombatSimulation.h"
+#include "FlowFields.h"
 #include "GridAttacks.h"
+#include "GridCreep.h"
+#include "GridSafeAirPath.h"
 #include "GridInset.h"
 #include "GridRoom.h"
 #include "GridTileRoom.h"
@@ -10,9 +13,12 @@
 #include "MapPartitions.h"
 #include "MapTools.h"
 #include "Micro.h"
+#include "NearestTiles.h"
 #include "OpsBoss.h"
 #include "PlayerSnapshot.h"
 #include "SkillKit.h"
+#include "UnitIndex.h"
+#include "ZoneGraph.h"
 
 // Central singleton to provide access to many components.
 #define the (The::Root())
@@ -59,6 +65,12 @@ namespace UAlbertaBot
         GridInset inset;
         // What zone is this tile in?
         GridZone zone;
+        // Ground distances and paths by way of the zones.
+        ZoneGraph zoneGraph;
+        // Nearest walkable tile: a precomputed lookup.
+        NearestTiles nearest;
+        // Distance maps to the destinations of squad orders, shared among the orders.
+        FlowFields flowFields;
         // What map partition is this walk tile in? You can walk between places in the same partition.
         MapPartitions partitions;
         // Map information and calculations.
@@ -91,6 +103,10 @@ namespace UAlbertaBot
 
         // Varying during the game.
 
+        // All accessible units, indexed by position. Rebuilt each frame.
+        UnitIndex unitIndex;
+        // Creep, visibility, and exploration of each tile. Creep is remembered under the fog.
+        GridCreep creep;
         // My current unit counts.
         My my;
         // Your current unit counts.
@@ -99,6 +115,8 @@ namespace UAlbertaBot
         GroundAttacks groundAttacks;
         // What tiles does enemy immobile defense hit in the air?
         AirAttacks airAttacks;
+        // Paths for flyers around enemy immobile air defense.
+        SafeAirPaths safeAirPaths;
         // What tiles does enemy immobile defense hit for this unit?
         int attacks(BWAPI::Unit unit, const BWAPI::TilePosition & tile) const;
         int attacks(BWAPI::Unit unit) const;
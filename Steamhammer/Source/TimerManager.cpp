@@ -4,6 +4,7 @@ using namespace UAlbertaBot;
 
 TimerManager::TimerManager() 
     : _timers(std::vector<BOSS::Timer>(NumTypes))
+    , _zoneStarts(NumTypes, -1)
     , _count(0)
     , _maxMilliseconds(0.0)
     , _totalMilliseconds(0.0)
@@ -28,11 +29,17 @@ TimerManager::TimerManager()
 void TimerManager::startTimer(const TimerManager::Type t)
 {
     _timers[t].start();
+    _zoneStarts[t] = Profiler::Enabled() ? Profiler::Now() : -1;
 }
 
 void TimerManager::stopTimer(const TimerManager::Type t)
 {
     _timers[t].stop();
+    if (_zoneStarts[t] >= 0)
+    {
+        Profiler::Thread().record(_timerNames[t].c_str(), _zoneStarts[t], Profiler::Now());
+        _zoneStarts[t] = -1;
+    }
     if (t == Total)
     {
         ++_count;
@@ -2,6 +2,7 @@
 
 #include "Config.h"
 #include "Common.h"
+#include "Profiler.h"
 #include "../../BOSS/source/Timer.hpp"
 
 namespace UAlbertaBot
@@ -11,6 +12,7 @@ class TimerManager
 {
     std::vector<BOSS::Timer> _timers;
     std::vector<std::string> _timerNames;
+    std::vector<int64_t> _zoneStarts;       // each timer is also a profiler zone
 
     int _count;
     double _maxMilliseconds;
@@ -20,6 +22,7 @@ class TimerManager
 
 public:
 
+    // Total is the frame; the others are the top-level zones within it.
     enum Type { Total, InformationManager, MapGrid, OpponentModel, Search, Worker, Production, Building, Combat, Micro, Scout, NumTypes };
 
     TimerManager();
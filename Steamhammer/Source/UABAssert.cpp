@@ -47,7 +47,7 @@ namespace Assert
 
         if (Config::IO::LogAssertToErrorFile)
         {
-            Logger::LogAppendToFile(Config::IO::ErrorLogFilename, ss.str());
+            Logger::LogAppendToFileNow(Config::IO::ErrorLogFilename, ss.str());
         }
     }
 }
@@ -7,9 +7,12 @@
 #include "UAlbertaBotModule.h"
 
 #include "../../BOSS/source/BOSS.h"
+#include "FrameCapture.h"
 #include "GameCommander.h"
+#include "Logger.h"
 #include "OpeningTiming.h"
 #include "ParseUtils.h"
+#include "Profiler.h"
 
 using namespace UAlbertaBot;
 
@@ -20,11 +23,20 @@ UAlbertaBotModule::UAlbertaBotModule()
 // BWAPI calls this when the bot starts.
 void UAlbertaBotModule::onStart()
 {
+    // Log through the writer thread, even if an earlier game in this process stopped it.
+    Logger::Start();
+
     // Initialize BOSS, the Build Order Search System
     BOSS::init();
 
     the.initialize();
 
+    // Start profiling if the config asks for it.
+    Profiler::Instance().initialize();
+
+    // Start capturing frames for offline replay if the config asks for it.
+    FrameCapture::Instance().initialize();
+
     // Set our BWAPI options according to the configuration. 
     BWAPI::Broodwar->setLocalSpeed(Config::BWAPIOptions::SetLocalSpeed);
     BWAPI::Broodwar->setFrameSkip(Config::BWAPIOptions::SetFrameSkip);
@@ -90,6 +102,7 @@ void UAlbertaBotModule::onFrame()
     }
 
     GameCommander::Instance().update();
+    Profiler::Instance().endFrame();
 }
 
 void UAlbertaBotModule::onUnitDestroy(BWAPI::Unit unit)
@@ -0,0 +1,206 @@
+#include "UnitIndex.h"
+
+using namespace UAlbertaBot;
+
+// Units are filed into square buckets by position, with a counting sort so that each bucket's
+// units are contiguous. A radius query visits only the buckets that overlap the circle's
+// bounding box, expanded by the largest unit extent so that big units filed in a neighboring
+// bucket are not missed. The exact distance test is the same as BWAPI's.
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Find the inclusive range of buckets that may hold units within radius of center.
+void UnitIndex::bucketRange(const BWAPI::Position & center, int radius, int & left, int & top, int & right, int & bottom) const
+{
+    const int reach = std::min(radius, 256 * 32) + maxExtent;
+
+    left   = std::max(0, (center.x - reach) / BucketSize);
+    top    = std::max(0, (center.y - reach) / BucketSize);
+    right  = std::min(cols - 1, (center.x + reach) / BucketSize);
+    bottom = std::min(rows - 1, (center.y + reach) / BucketSize);
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+UnitIndex::UnitIndex()
+    : cols(0)
+    , rows(0)
+    , maxExtent(0)
+{
+}
+
+void UnitIndex::initialize()
+{
+    cols = (BWAPI::Broodwar->mapWidth() * 32 + BucketSize - 1) / BucketSize;
+    rows = (BWAPI::Broodwar->mapHeight() * 32 + BucketSize - 1) / BucketSize;
+
+    bucketStart.assign(cols * rows + 1, 0);
+    entries.clear();
+    maxExtent = 0;
+}
+
+// Rebuild the index from scratch. Call once per frame, before anybody queries it.
+void UnitIndex::update()
+{
+    const BWAPI::Unitset & units = BWAPI::Broodwar->getAllUnits();
+
+    std::fill(bucketStart.begin(), bucketStart.end(), 0);
+    entries.resize(units.size());
+    maxExtent = 0;
+
+    // Count the units in each bucket. Units inside a transport or bunker have no position.
+    for (BWAPI::Unit unit : units)
+    {
+        const BWAPI::Position pos = unit->getPosition();
+        if (pos.isValid())
+        {
+            ++bucketStart[(pos.y / BucketSize) * cols + pos.x / BucketSize + 1];
+
+            const BWAPI::UnitType type = unit->getType();
+            maxExtent = std::max(maxExtent, 1 + std::max(
+                std::max(type.dimensionLeft(), type.dimensionRight()),
+                std::max(type.dimensionUp(), type.dimensionDown())));
+        }
+    }
+
+    for (size_t b = 1; b < bucketStart.size(); ++b)
+    {
+        bucketStart[b] += bucketStart[b - 1];
+    }
+    entries.resize(bucketStart.back());
+
+    // Fill the buckets. Afterward, bucketStart[b] is temporarily the end of bucket b...
+    for (BWAPI::Unit unit : units)
+    {
+        const BWAPI::Position pos = unit->getPosition();
+        if (pos.isValid())
+        {
+            const int b = (pos.y / BucketSize) * cols + pos.x / BucketSize;
+            entries[bucketStart[b]++] = Entry{ unit, pos };
+        }
+    }
+
+    // ...so shift it back down to be the start.
+    for (size_t b = bucketStart.size() - 1; b > 0; --b)
+    {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+void UnitIndex::getUnitsInRadius(
+    std::vector<BWAPI::Unit> & result,
+    const BWAPI::Position & center,
+    int radius,
+    const BWAPI::UnitFilter & pred) const
+{
+    result.clear();
+
+    int left, top, right, bottom;
+    bucketRange(center, radius, left, top, right, bottom);
+    const int reach = radius + maxExtent;
+
+    for (int by = top; by <= bottom; ++by)
+    {
+        for (int b = by * cols + left; b <= by * cols + right; ++b)
+        {
+            for (int i = bucketStart[b]; i < bucketStart[b + 1]; ++i)
+            {
+                const Entry & e = entries[i];
+                if (abs(e.pos.x - center.x) <= reach &&
+                    abs(e.pos.y - center.y) <= reach &&
+                    e.unit->getDistance(center) <= radius &&
+                    (!pred.isValid() || pred(e.unit)))
+                {
+                    result.push_back(e.unit);
+                }
+            }
+        }
+    }
+}
+
+bool UnitIndex::anyUnitInRadius(const BWAPI::Position & center, int radius, const BWAPI::UnitFilter & pred) const
+{
+    int left, top, right, bottom;
+    bucketRange(center, radius, left, top, right, bottom);
+    const int reach = radius + maxExtent;
+
+    for (int by = top; by <= bottom; ++by)
+    {
+        for (int b = by * cols + left; b <= by * cols + right; ++b)
+        {
+            for (int i = bucketStart[b]; i < bucketStart[b + 1]; ++i)
+            {
+                const Entry & e = entries[i];
+                if (abs(e.pos.x - center.x) <= reach &&
+                    abs(e.pos.y - center.y) <= reach &&
+                    e.unit->getDistance(center) <= radius &&
+                    (!pred.isValid() || pred(e.unit)))
+                {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+// Search rings of buckets outward from the center, and stop once no farther ring can
+// hold anything closer than the best so far.
+BWAPI::Unit UnitIndex::getClosestUnit(const BWAPI::Position & center, const BWAPI::UnitFilter & pred, int radius) const
+{
+    if (cols == 0 || !center.isValid())
+    {
+        return nullptr;
+    }
+
+    const int cx = center.x / BucketSize;
+    const int cy = center.y / BucketSize;
+    const int maxRing = std::max(std::max(cx, cols - 1 - cx), std::max(cy, rows - 1 - cy));
+
+    BWAPI::Unit best = nullptr;
+    int bestDistance = radius;
+
+    for (int ring = 0; ring <= maxRing; ++ring)
+    {
+        // Every unit in this ring or beyond is at least this far away, in the worst case.
+        // BWAPI's approximate distance can be up to about 1/10 less than the larger coordinate gap.
+        const int gap = (ring - 1) * BucketSize - maxExtent;
+        if (gap > 0 && gap - gap / 8 > bestDistance)
+        {
+            break;
+        }
+
+        const int top = std::max(0, cy - ring);
+        const int bottom = std::min(rows - 1, cy + ring);
+        for (int by = top; by <= bottom; ++by)
+        {
+            // On the top and bottom rows of the ring, take every bucket; otherwise only the ends.
+            const bool edgeRow = by == cy - ring || by == cy + ring;
+            const int step = edgeRow ? 1 : 2 * ring;
+            for (int bx = cx - ring; bx <= cx + ring; bx += std::max(1, step))
+            {
+                if (bx < 0 || bx >= cols)
+                {
+                    continue;
+                }
+                const int b = by * cols + bx;
+                for (int i = bucketStart[b]; i < bucketStart[b + 1]; ++i)
+                {
+                    const Entry & e = entries[i];
+                    const int dist = e.unit->getDistance(center);
+                    if (dist <= bestDistance && (!best || dist < bestDistance) &&
+                        (!pred.isValid() || pred(e.unit)))
+                    {
+                        best = e.unit;
+                        bestDistance = dist;
+                    }
+                }
+            }
+        }
+    }
+
+    return best;
+}
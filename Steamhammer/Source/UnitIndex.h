@@ -0,0 +1,50 @@
+#pragma once
+
+#include <BWAPI.h>
+
+// A spatial index of all accessible units, rebuilt once per frame.
+
+namespace UAlbertaBot
+{
+class UnitIndex
+{
+private:
+    struct Entry
+    {
+        BWAPI::Unit unit;
+        BWAPI::Position pos;
+    };
+
+    // Buckets are square, this many pixels on a side.
+    static const int BucketSize = 4 * 32;
+
+    int cols;
+    int rows;
+
+    // The entries are sorted by bucket. Bucket b holds entries [bucketStart[b], bucketStart[b+1]).
+    std::vector<int> bucketStart;
+    std::vector<Entry> entries;
+
+    // The greatest distance from any indexed unit's position to the edge of its bounding box.
+    int maxExtent;
+
+    void bucketRange(const BWAPI::Position & center, int radius, int & left, int & top, int & right, int & bottom) const;
+
+public:
+    UnitIndex();
+
+    void initialize();
+    void update();
+
+    // These have the same meaning as the BWAPI::Game calls of the same names.
+    // The result buffer is cleared first, so the caller can reuse it.
+    void getUnitsInRadius(
+        std::vector<BWAPI::Unit> & result,
+        const BWAPI::Position & center,
+        int radius,
+        const BWAPI::UnitFilter & pred = nullptr) const;
+    bool anyUnitInRadius(const BWAPI::Position & center, int radius, const BWAPI::UnitFilter & pred = nullptr) const;
+    BWAPI::Unit getClosestUnit(const BWAPI::Position & center, const BWAPI::UnitFilter & pred = nullptr, int radius = 999999) const;
+};
+
+}
@@ -255,14 +255,335 @@ bool UnitUtil::IsValidUnit(BWAPI::Unit unit)
         unit->getPlayer() == BWAPI::Broodwar->self();			// catches mind controlled units
 }
 
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// Attack lookup tables.
+// Weapon queries are made in the innermost loops of targeting and combat estimation, and
+// the answers depend only on the attacker's type, whether the target is in the air, and
+// (for range and damage) the attacker's upgrades. So precompute them once per unit type
+// and target layer. The per-player tables are refreshed when an upgrade that affects
+// weapons finishes for either player.
+// Layer index: 0 = ground target, 1 = air target.
+
+namespace
+{
+    const int NTypes = BWAPI::UnitTypes::Enum::MAX;
+
+    // Facts about a unit type that do not depend on upgrades.
+    struct TypeAttack
+    {
+        BWAPI::WeaponType weapon;       // GetGroundWeapon() / GetAirWeapon()
+        int rangeAssumingUpgrades;      // GetAttackRangeAssumingUpgrades()
+        bool canAttack;                 // TypeCanAttackGround() / TypeCanAttackAir()
+    };
+
+    // Facts about a unit type that depend on the player's upgrades.
+    struct PlayerAttack
+    {
+        int range;                      // GetAttackRange()
+        double dpf;                     // GroundDPF() / AirDPF(), with upgrades
+        double baseDPF;                 // DPF(), without damage upgrades
+    };
+
+    TypeAttack typeAttack[NTypes][2];
+    PlayerAttack playerAttack[2][NTypes][2];    // [0] = self, [1] = enemy
+
+    bool tablesReady = false;
+
+    // Upgrades which change weapon range, damage, or cooldown, and their last known levels.
+    std::vector<BWAPI::UpgradeType> weaponUpgrades;
+    std::vector<int> weaponUpgradeLevels[2];
+
+    // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+    // The calculations themselves, used to fill the tables.
+    // They are also the fallback for players other than self and enemy.
+
+    BWAPI::WeaponType computeGroundWeapon(BWAPI::UnitType attacker)
+    {
+        // We pretend that a bunker has marines in it. It's only a guess.
+        if (attacker == BWAPI::UnitTypes::Terran_Bunker)
+        {
+            return (BWAPI::UnitTypes::Terran_Marine).groundWeapon();
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
+        {
+            return (BWAPI::UnitTypes::Protoss_Interceptor).groundWeapon();
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Reaver)
+        {
+            return (BWAPI::UnitTypes::Protoss_Scarab).groundWeapon();
+        }
+
+        return attacker.groundWeapon();
+    }
+
+    BWAPI::WeaponType computeAirWeapon(BWAPI::UnitType attacker)
+    {
+        if (attacker == BWAPI::UnitTypes::Terran_Bunker)
+        {
+            return (BWAPI::UnitTypes::Terran_Marine).airWeapon();
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
+        {
+            return (BWAPI::UnitTypes::Protoss_Interceptor).airWeapon();
+        }
+
+        return attacker.airWeapon();
+    }
+
+    // Assume that a bunker is loaded and can shoot at air.
+    bool computeCanAttackAir(BWAPI::UnitType attacker)
+    {
+        return
+            attacker.airWeapon() != BWAPI::WeaponTypes::None ||
+            attacker == BWAPI::UnitTypes::Terran_Bunker ||
+            attacker == BWAPI::UnitTypes::Protoss_Carrier;
+    }
+
+    // Assume that a bunker is loaded and can shoot at ground.
+    bool computeCanAttackGround(BWAPI::UnitType attacker)
+    {
+        return
+            attacker.groundWeapon() != BWAPI::WeaponTypes::None ||
+            attacker == BWAPI::UnitTypes::Terran_Bunker ||
+            attacker == BWAPI::UnitTypes::Protoss_Carrier ||
+            attacker == BWAPI::UnitTypes::Protoss_Reaver;
+    }
+
+    int computeRangeAssumingUpgrades(BWAPI::UnitType attacker, bool air)
+    {
+        // Reavers, carriers, and bunkers have "no weapon" but still have an attack range.
+        if (attacker == BWAPI::UnitTypes::Terran_Bunker)
+        {
+            return 6 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Reaver && !air)
+        {
+            return 8 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
+        {
+            return 8 * 32;
+        }
+
+        BWAPI::WeaponType weapon = air ? computeAirWeapon(attacker) : computeGroundWeapon(attacker);
+        if (weapon == BWAPI::WeaponTypes::None)
+        {
+            return 0;
+        }
+
+        // Assume that any upgrades are researched.
+        if (attacker == BWAPI::UnitTypes::Terran_Marine)
+        {
+            return 5 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Terran_Goliath && air)
+        {
+            return 8 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Dragoon)
+        {
+            return 6 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Zerg_Hydralisk)
+        {
+            return 5 * 32;
+        }
+
+        return weapon.maxRange();
+    }
+
+    // NOTE Does not check whether our reaver, carrier, or bunker has units inside that can attack.
+    int computeRange(BWAPI::Player player, BWAPI::UnitType attacker, bool air)
+    {
+        // Reavers, carriers, and bunkers have "no weapon" but still have an attack range.
+        if (attacker == BWAPI::UnitTypes::Protoss_Reaver && !air)
+        {
+            return 8 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
+        {
+            return 8 * 32;
+        }
+        if (attacker == BWAPI::UnitTypes::Terran_Bunker)
+        {
+            if (player == BWAPI::Broodwar->enemy() ||
+                BWAPI::Broodwar->self()->getUpgradeLevel(BWAPI::UpgradeTypes::U_238_Shells))
+            {
+                return 6 * 32;
+            }
+            return 5 * 32;
+        }
+
+        const BWAPI::WeaponType weapon = air ? computeAirWeapon(attacker) : computeGroundWeapon(attacker);
+
+        if (weapon == BWAPI::WeaponTypes::None)
+        {
+            return 0;
+        }
+
+        return player->weaponMaxRange(weapon);
+    }
+
+    double computeDPF(BWAPI::Player player, BWAPI::UnitType type, bool air)
+    {
+        BWAPI::WeaponType weapon = air ? computeAirWeapon(type) : computeGroundWeapon(type);
+        const int cooldown = player->weaponDamageCooldown(type);
+
+        if (weapon == BWAPI::WeaponTypes::None || cooldown <= 0)
+        {
+            return 0.0;
+        }
+
+        return double(player->damage(weapon)) / cooldown;
+    }
+
+    // Zerglings are the only unit with a cooldown upgrade.
+    // NOTE Assume we can't tell whether the opponent has the upgrade.
+    double computeBaseDPF(BWAPI::Player player, BWAPI::UnitType type, bool air)
+    {
+        BWAPI::WeaponType weapon = air ? computeAirWeapon(type) : computeGroundWeapon(type);
+
+        const int cooldown = (type == BWAPI::UnitTypes::Zerg_Zergling && player == the.self())
+            ? the.self()->weaponDamageCooldown(BWAPI::UnitTypes::Zerg_Zergling)
+            : weapon.damageCooldown();
+
+        if (weapon == BWAPI::WeaponTypes::None || cooldown <= 0)
+        {
+            return 0.0;
+        }
+
+        return double(weapon.damageAmount()) / cooldown;
+        // TODO better to take upgrades into account when possible:
+        // return double(attacker->getPlayer()->damage(weapon)) / cooldown;
+    }
+
+    // -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+    // Index into playerAttack[], or -1 if the player has no table.
+    int playerIndex(BWAPI::Player player)
+    {
+        if (player == BWAPI::Broodwar->self())
+        {
+            return 0;
+        }
+        if (player == BWAPI::Broodwar->enemy())
+        {
+            return 1;
+        }
+        return -1;
+    }
+
+    void fillPlayerTable(int p)
+    {
+        BWAPI::Player player = p == 0 ? BWAPI::Broodwar->self() : BWAPI::Broodwar->enemy();
+
+        for (int t = 0; t < NTypes; ++t)
+        {
+            BWAPI::UnitType type(t);
+            for (int air = 0; air < 2; ++air)
+            {
+                PlayerAttack & entry = playerAttack[p][t][air];
+                entry.range = computeRange(player, type, air != 0);
+                entry.dpf = computeDPF(player, type, air != 0);
+                entry.baseDPF = computeBaseDPF(player, type, air != 0);
+            }
+        }
+
+        weaponUpgradeLevels[p].clear();
+        for (BWAPI::UpgradeType upgrade : weaponUpgrades)
+        {
+            weaponUpgradeLevels[p].push_back(player->getUpgradeLevel(upgrade));
+        }
+    }
+
+    // Has any weapon upgrade finished for the player since the table was filled?
+    bool weaponUpgradesChanged(int p)
+    {
+        BWAPI::Player player = p == 0 ? BWAPI::Broodwar->self() : BWAPI::Broodwar->enemy();
+
+        for (size_t i = 0; i < weaponUpgrades.size(); ++i)
+        {
+            if (player->getUpgradeLevel(weaponUpgrades[i]) != weaponUpgradeLevels[p][i])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+// Fill in the attack tables. Call once at the start of the game, before anything asks.
+void UnitUtil::InitializeAttackTables()
+{
+    std::set<BWAPI::UpgradeType> upgrades;
+
+    // Range and cooldown upgrades, which are not attached to any weapon.
+    upgrades.insert(BWAPI::UpgradeTypes::U_238_Shells);
+    upgrades.insert(BWAPI::UpgradeTypes::Charon_Boosters);
+    upgrades.insert(BWAPI::UpgradeTypes::Singularity_Charge);
+    upgrades.insert(BWAPI::UpgradeTypes::Grooved_Spines);
+    upgrades.insert(BWAPI::UpgradeTypes::Adrenal_Glands);
+
+    for (int t = 0; t < NTypes; ++t)
+    {
+        BWAPI::UnitType type(t);
+
+        typeAttack[t][0].weapon = computeGroundWeapon(type);
+        typeAttack[t][0].rangeAssumingUpgrades = computeRangeAssumingUpgrades(type, false);
+        typeAttack[t][0].canAttack = computeCanAttackGround(type);
+
+        typeAttack[t][1].weapon = computeAirWeapon(type);
+        typeAttack[t][1].rangeAssumingUpgrades = computeRangeAssumingUpgrades(type, true);
+        typeAttack[t][1].canAttack = computeCanAttackAir(type);
+
+        // Damage upgrades.
+        for (int air = 0; air < 2; ++air)
+        {
+            BWAPI::WeaponType weapon = typeAttack[t][air].weapon;
+            if (weapon != BWAPI::WeaponTypes::None && weapon.upgradeType() != BWAPI::UpgradeTypes::None)
+            {
+                upgrades.insert(weapon.upgradeType());
+            }
+        }
+    }
+
+    weaponUpgrades.assign(upgrades.begin(), upgrades.end());
+
+    fillPlayerTable(0);
+    fillPlayerTable(1);
+
+    tablesReady = true;
+}
+
+// Refresh the per-player tables if a weapon upgrade has finished. Call once per frame.
+void UnitUtil::UpdateAttackTables()
+{
+    if (!tablesReady)
+    {
+        InitializeAttackTables();
+        return;
+    }
+
+    for (int p = 0; p < 2; ++p)
+    {
+        if (weaponUpgradesChanged(p))
+        {
+            fillPlayerTable(p);
+        }
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
 bool UnitUtil::CanAttack(BWAPI::Unit attacker, BWAPI::Unit target)
 {
-    return target->isFlying() ? TypeCanAttackAir(attacker->getType()) : TypeCanAttackGround(attacker->getType());
+    return typeAttack[attacker->getType()][target->isFlying()].canAttack;
 }
 
 bool UnitUtil::CanAttack(BWAPI::UnitType attacker, BWAPI::Unit target)
 {
-    return target->isFlying() ? TypeCanAttackAir(attacker) : TypeCanAttackGround(attacker);
+    return typeAttack[attacker][target->isFlying()].canAttack;
 }
 
 // Accounts for cases where units can attack without a weapon of their own.
@@ -270,7 +591,7 @@ bool UnitUtil::CanAttack(BWAPI::UnitType attacker, BWAPI::Unit target)
 // For example, high templar can attack air or ground mobile units, but can't attack buildings.
 bool UnitUtil::CanAttack(BWAPI::UnitType attacker, BWAPI::UnitType target)
 {
-    return target.isFlyer() ? TypeCanAttackAir(attacker) : TypeCanAttackGround(attacker);
+    return typeAttack[attacker][target.isFlyer()].canAttack;
 }
 
 bool UnitUtil::CanAttackAir(BWAPI::Unit attacker)
@@ -281,10 +602,7 @@ bool UnitUtil::CanAttackAir(BWAPI::Unit attacker)
 // Assume that a bunker is loaded and can shoot at air.
 bool UnitUtil::TypeCanAttackAir(BWAPI::UnitType attacker)
 {
-    return
-        attacker.airWeapon() != BWAPI::WeaponTypes::None ||
-        attacker == BWAPI::UnitTypes::Terran_Bunker ||
-        attacker == BWAPI::UnitTypes::Protoss_Carrier;
+    return typeAttack[attacker][1].canAttack;
 }
 
 // NOTE surrenderMonkey() checks CanAttackGround() to see whether the enemy can destroy buildings.
@@ -298,11 +616,7 @@ bool UnitUtil::CanAttackGround(BWAPI::Unit attacker)
 // Assume that a bunker is loaded and can shoot at ground.
 bool UnitUtil::TypeCanAttackGround(BWAPI::UnitType attacker)
 {
-    return
-        attacker.groundWeapon() != BWAPI::WeaponTypes::None ||
-        attacker == BWAPI::UnitTypes::Terran_Bunker ||
-        attacker == BWAPI::UnitTypes::Protoss_Carrier ||
-        attacker == BWAPI::UnitTypes::Protoss_Reaver;
+    return typeAttack[attacker][0].canAttack;
 }
 
 // Does the unit type have any attack?
@@ -316,48 +630,32 @@ bool UnitUtil::TypeCanAttack(BWAPI::UnitType type)
 // NOTE This does not account for unit sizes, it's a generic "how hard does it hit?" value.
 double UnitUtil::DPF(BWAPI::Unit attacker, BWAPI::Unit target)
 {
-    BWAPI::WeaponType weapon = GetWeapon(attacker, target);
-
-    // Zerglings are the only unit with a cooldown upgrade.
-    // NOTE Assume we can't tell whether the opponent has the upgrade.
-    const int cooldown = (attacker->getType() == BWAPI::UnitTypes::Zerg_Zergling && attacker->getPlayer() == the.self())
-        ? the.self()->weaponDamageCooldown(BWAPI::UnitTypes::Zerg_Zergling)
-        : weapon.damageCooldown();
-
-    if (weapon == BWAPI::WeaponTypes::None || cooldown <= 0)
+    const int p = playerIndex(attacker->getPlayer());
+    if (p < 0)
     {
-        return 0.0;
+        return computeBaseDPF(attacker->getPlayer(), attacker->getType(), target->isFlying());
     }
-
-    return double(weapon.damageAmount()) / cooldown;
-    // TODO better to take upgrades into account when possible:
-    // return double(attacker->getPlayer()->damage(weapon)) / cooldown;
+    return playerAttack[p][attacker->getType()][target->isFlying()].baseDPF;
 }
 
 double UnitUtil::GroundDPF(BWAPI::Player player, BWAPI::UnitType type)
 {
-    BWAPI::WeaponType weapon = GetGroundWeapon(type);
-    const int cooldown = player->weaponDamageCooldown(type);
-
-    if (weapon == BWAPI::WeaponTypes::None || cooldown <= 0)
+    const int p = playerIndex(player);
+    if (p < 0)
     {
-        return 0.0;
+        return computeDPF(player, type, false);
     }
-
-    return double(player->damage(weapon)) / cooldown;
+    return playerAttack[p][type][0].dpf;
 }
 
 double UnitUtil::AirDPF(BWAPI::Player player, BWAPI::UnitType type)
 {
-    BWAPI::WeaponType weapon = GetAirWeapon(type);
-    const int cooldown = player->weaponDamageCooldown(type);
-
-    if (weapon == BWAPI::WeaponTypes::None || cooldown <= 0)
+    const int p = playerIndex(player);
+    if (p < 0)
     {
-        return 0.0;
+        return computeDPF(player, type, true);
     }
-
-    return double(player->damage(weapon)) / cooldown;
+    return playerAttack[p][type][1].dpf;
 }
 
 BWAPI::WeaponType UnitUtil::GetGroundWeapon(BWAPI::Unit attacker)
@@ -365,23 +663,10 @@ BWAPI::WeaponType UnitUtil::GetGroundWeapon(BWAPI::Unit attacker)
     return GetGroundWeapon(attacker->getType());
 }
 
+// We pretend that a bunker has marines in it. It's only a guess.
 BWAPI::WeaponType UnitUtil::GetGroundWeapon(BWAPI::UnitType attacker)
 {
-    // We pretend that a bunker has marines in it. It's only a guess.
-    if (attacker == BWAPI::UnitTypes::Terran_Bunker)
-    {
-        return (BWAPI::UnitTypes::Terran_Marine).groundWeapon();
-    }
-    if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
-    {
-        return (BWAPI::UnitTypes::Protoss_Interceptor).groundWeapon();
-    }
-    if (attacker == BWAPI::UnitTypes::Protoss_Reaver)
-    {
-        return (BWAPI::UnitTypes::Protoss_Scarab).groundWeapon();
-    }
-
-    return attacker.groundWeapon();
+    return typeAttack[attacker][0].weapon;
 }
 
 BWAPI::WeaponType UnitUtil::GetAirWeapon(BWAPI::Unit attacker)
@@ -391,16 +676,7 @@ BWAPI::WeaponType UnitUtil::GetAirWeapon(BWAPI::Unit attacker)
 
 BWAPI::WeaponType UnitUtil::GetAirWeapon(BWAPI::UnitType attacker)
 {
-    if (attacker == BWAPI::UnitTypes::Terran_Bunker)
-    {
-        return (BWAPI::UnitTypes::Terran_Marine).airWeapon();
-    }
-    if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
-    {
-        return (BWAPI::UnitTypes::Protoss_Interceptor).airWeapon();
-    }
-
-    return attacker.airWeapon();
+    return typeAttack[attacker][1].weapon;
 }
 
 BWAPI::WeaponType UnitUtil::GetWeapon(BWAPI::Unit attacker, BWAPI::Unit target)
@@ -412,12 +688,12 @@ BWAPI::WeaponType UnitUtil::GetWeapon(BWAPI::Unit attacker, BWAPI::Unit target)
 // for a lifted terran building.
 BWAPI::WeaponType UnitUtil::GetWeapon(BWAPI::UnitType attacker, BWAPI::Unit target)
 {
-    return target->isFlying() ? GetAirWeapon(attacker) : GetGroundWeapon(attacker);
+    return typeAttack[attacker][target->isFlying()].weapon;
 }
 
 BWAPI::WeaponType UnitUtil::GetWeapon(BWAPI::UnitType attacker, BWAPI::UnitType target)
 {
-    return target.isFlyer() ? GetAirWeapon(attacker) : GetGroundWeapon(attacker);
+    return typeAttack[attacker][target.isFlyer()].weapon;
 }
 
 // Weapon range in pixels.
@@ -425,78 +701,19 @@ BWAPI::WeaponType UnitUtil::GetWeapon(BWAPI::UnitType attacker, BWAPI::UnitType
 // NOTE Does not check whether our reaver, carrier, or bunker has units inside that can attack.
 int UnitUtil::GetAttackRange(BWAPI::Unit attacker, BWAPI::Unit target)
 {
-    // Reavers, carriers, and bunkers have "no weapon" but still have an attack range.
-    if (attacker->getType() == BWAPI::UnitTypes::Protoss_Reaver && !target->isFlying())
-    {
-        return 8 * 32;
-    }
-    if (attacker->getType() == BWAPI::UnitTypes::Protoss_Carrier)
-    {
-        return 8 * 32;
-    }
-    if (attacker->getType() == BWAPI::UnitTypes::Terran_Bunker)
-    {
-        if (attacker->getPlayer() == BWAPI::Broodwar->enemy() ||
-            BWAPI::Broodwar->self()->getUpgradeLevel(BWAPI::UpgradeTypes::U_238_Shells))
-        {
-            return 6 * 32;
-        }
-        return 5 * 32;
-    }
-
-    const BWAPI::WeaponType weapon = GetWeapon(attacker, target);
-
-    if (weapon == BWAPI::WeaponTypes::None)
+    const int p = playerIndex(attacker->getPlayer());
+    if (p < 0)
     {
-        return 0;
+        return computeRange(attacker->getPlayer(), attacker->getType(), target->isFlying());
     }
-
-    return attacker->getPlayer()->weaponMaxRange(weapon);
+    return playerAttack[p][attacker->getType()][target->isFlying()].range;
 }
 
 // Weapon range in pixels.
 // Range is zero if the attacker cannot attack the target at all.
 int UnitUtil::GetAttackRangeAssumingUpgrades(BWAPI::UnitType attacker, BWAPI::UnitType target)
 {
-    // Reavers, carriers, and bunkers have "no weapon" but still have an attack range.
-    if (attacker == BWAPI::UnitTypes::Terran_Bunker)
-    {
-        return 6 * 32;
-    }
-    if (attacker == BWAPI::UnitTypes::Protoss_Reaver && !target.isFlyer())
-    {
-        return 8 * 32;
-    }
-    if (attacker == BWAPI::UnitTypes::Protoss_Carrier)
-    {
-        return 8 * 32;
-    }
-
-    BWAPI::WeaponType weapon = GetWeapon(attacker, target);
-    if (weapon == BWAPI::WeaponTypes::None)
-    {
-        return 0;
-    }
-
-    // Assume that any upgrades are researched.
-    if (attacker == BWAPI::UnitTypes::Terran_Marine)
-    {
-        return 5 * 32;
-    }
-    if (attacker == BWAPI::UnitTypes::Terran_Goliath && target.isFlyer())
-    {
-        return 8 * 32;
-    }
-    if (attacker == BWAPI::UnitTypes::Protoss_Dragoon)
-    {
-        return 6 * 32;
-    }
-    if (attacker == BWAPI::UnitTypes::Zerg_Hydralisk)
-    {
-        return 5 * 32;
-    }
-
-    return weapon.maxRange();
+    return typeAttack[attacker][target.isFlyer()].rangeAssumingUpgrades;
 }
 
 // Weapon range in pixels.
@@ -505,10 +722,7 @@ int UnitUtil::GetAttackRangeAssumingUpgrades(BWAPI::UnitType attacker, BWAPI::Un
 // Used in selecting enemy units for the combat sim.
 int UnitUtil::GetMaxAttackRange(BWAPI::UnitType type)
 {
-    return std::max(
-        GetAttackRangeAssumingUpgrades(type, BWAPI::UnitTypes::Terran_Marine),   // range vs. ground
-        GetAttackRangeAssumingUpgrades(type, BWAPI::UnitTypes::Terran_Wraith)    // range vs. air
-    );
+    return std::max(typeAttack[type][0].rangeAssumingUpgrades, typeAttack[type][1].rangeAssumingUpgrades);
 }
 
 // TODO Is this correct for reavers?
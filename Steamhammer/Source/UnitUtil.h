@@ -33,6 +33,10 @@ namespace UnitUtil
 
     bool IsValidUnit(BWAPI::Unit unit);
 
+    // Precomputed weapon facts used by the attack functions below.
+    void InitializeAttackTables();
+    void UpdateAttackTables();
+
     // Damage per frame (formerly CalculateLDT()).
     double DPF(BWAPI::Unit attacker, BWAPI::Unit target);
     double GroundDPF(BWAPI::Player player, BWAPI::UnitType type);
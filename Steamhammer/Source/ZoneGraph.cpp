@@ -0,0 +1,415 @@
+#include "ZoneGraph.h"
+
+#include <algorithm>
+#include <queue>
+
+#include "TaskGraph.h"
+#include "The.h"
+
+using namespace UAlbertaBot;
+
+namespace
+{
+    const size_t LegalActions = 4;
+    const int actionX[LegalActions] = { 1, -1, 0, 0 };
+    const int actionY[LegalActions] = { 0, 0, 1, -1 };
+
+    // The same tile or orthogonal neighbors.
+    bool Adjacent(const BWAPI::TilePosition & a, const BWAPI::TilePosition & b)
+    {
+        return std::abs(a.x - b.x) + std::abs(a.y - b.y) <= 1;
+    }
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+// The caller guarantees that the tile is in the portal's zone.
+int ZoneGraph::fieldAt(int portal, const BWAPI::TilePosition & tile) const
+{
+    const int zone = portals[portal].zone;
+    return field[fieldStart[zone] + size_t(portal - portalStart[zone]) * zoneTiles[zone].size() + localAt(tile)];
+}
+
+// Each walkable tile belongs to the nearest zone by ground, found by a breadth-first search
+// out from all the zones at once. Tiles out of reach of every zone stay 0.
+void ZoneGraph::findTileZones()
+{
+    tileZone.assign(width * height, 0);
+
+    int nZones = 1;
+    std::vector<BWAPI::TilePosition> fringe;
+    fringe.reserve(width * height);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const BWAPI::TilePosition tile(x, y);
+            const int id = the.zone.at(tile);
+            if (id > 0 && the.map.isWalkable(tile))
+            {
+                tileZone[x + y * width] = id;
+                fringe.push_back(tile);
+                nZones = std::max(nZones, id + 1);
+            }
+        }
+    }
+
+    for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
+    {
+        const BWAPI::TilePosition & tile = fringe[fringeIndex];
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const BWAPI::TilePosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+            if (nextTile.isValid() && zoneAt(nextTile) == 0 && the.map.isWalkable(nextTile))
+            {
+                tileZone[nextTile.x + nextTile.y * width] = zoneAt(tile);
+                fringe.push_back(nextTile);
+            }
+        }
+    }
+
+    // List the tiles of each zone.
+    localIndex.assign(width * height, -1);
+    zoneTiles.assign(nZones, std::vector<BWAPI::TilePosition>());
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const int zone = tileZone[x + y * width];
+            if (zone > 0)
+            {
+                localIndex[x + y * width] = int(zoneTiles[zone].size());
+                zoneTiles[zone].push_back(BWAPI::TilePosition(x, y));
+            }
+        }
+    }
+}
+
+// Split the border between each pair of zones into stretches, and put a portal in the middle
+// of each span of up to PortalSpan crossings of a stretch. A wide border gets several portals,
+// so that a path does not go far out of its way to cross.
+// Neighboring crossings in a stretch are adjacent on both sides of the border. A zone may be
+// in pieces, and this keeps the portal in the same piece as the crossings it stands for.
+void ZoneGraph::findPortals()
+{
+    const size_t PortalSpan = 8;
+
+    // 1. Find each pair of touching tiles in different zones, once.
+    typedef std::pair<BWAPI::TilePosition, BWAPI::TilePosition> Crossing;
+    std::map< std::pair<int, int>, std::vector<Crossing> > borders;
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const BWAPI::TilePosition tile(x, y);
+            const int zone = zoneAt(tile);
+            if (zone == 0)
+            {
+                continue;
+            }
+            for (size_t a = 0; a < LegalActions; ++a)
+            {
+                const BWAPI::TilePosition nextTile(x + actionX[a], y + actionY[a]);
+                if (nextTile.isValid() && zoneAt(nextTile) > zone)
+                {
+                    borders[std::make_pair(zone, zoneAt(nextTile))].push_back(std::make_pair(tile, nextTile));
+                }
+            }
+        }
+    }
+
+    // 2. Place the portals, in pairs.
+    std::vector<Portal> found;
+    for (const auto & border : borders)
+    {
+        const std::vector<Crossing> & crossings = border.second;
+        std::vector<bool> done(crossings.size(), false);
+        for (size_t first = 0; first < crossings.size(); ++first)
+        {
+            if (done[first])
+            {
+                continue;
+            }
+
+            std::vector<size_t> stretch(1, first);
+            done[first] = true;
+            for (size_t i = 0; i < stretch.size(); ++i)
+            {
+                for (size_t j = first + 1; j < crossings.size(); ++j)
+                {
+                    if (!done[j] &&
+                        Adjacent(crossings[stretch[i]].first, crossings[j].first) &&
+                        Adjacent(crossings[stretch[i]].second, crossings[j].second))
+                    {
+                        done[j] = true;
+                        stretch.push_back(j);
+                    }
+                }
+            }
+
+            for (size_t start = 0; start < stretch.size(); start += PortalSpan)
+            {
+                const size_t end = std::min(stretch.size(), start + PortalSpan);
+                const Crossing & middle = crossings[stretch[(start + end) / 2]];
+                const int p = int(found.size());
+                found.push_back(Portal{ middle.first, border.first.first, p + 1 });
+                found.push_back(Portal{ middle.second, border.first.second, p });
+            }
+        }
+    }
+
+    // 3. Sort the portals by zone, keeping the mates straight.
+    std::vector<int> order(found.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = int(i);
+    }
+    std::stable_sort(order.begin(), order.end(), [&found](int a, int b) { return found[a].zone < found[b].zone; });
+
+    std::vector<int> newIndex(found.size());
+    for (size_t i = 0; i < order.size(); ++i)
+    {
+        newIndex[order[i]] = int(i);
+    }
+
+    portals.clear();
+    portalStart.assign(zoneTiles.size() + 1, 0);
+    for (int old : order)
+    {
+        Portal portal = found[old];
+        portal.mate = newIndex[portal.mate];
+        portals.push_back(portal);
+        ++portalStart[portal.zone + 1];
+    }
+    for (size_t zone = 1; zone < portalStart.size(); ++zone)
+    {
+        portalStart[zone] += portalStart[zone - 1];
+    }
+}
+
+// Search each zone from each of its portals. The zones are independent, so they run in parallel.
+void ZoneGraph::findFields()
+{
+    const int nZones = int(zoneTiles.size());
+
+    fieldStart.assign(nZones + 1, 0);
+    for (int zone = 0; zone < nZones; ++zone)
+    {
+        fieldStart[zone + 1] = fieldStart[zone] + size_t(portalStart[zone + 1] - portalStart[zone]) * zoneTiles[zone].size();
+    }
+    field.assign(fieldStart[nZones], short(-1));
+
+    TaskGraph::ParallelFor(nZones, [this](int zone)
+    {
+        for (int p = portalStart[zone]; p < portalStart[zone + 1]; ++p)
+        {
+            searchZone(portals[p].tile, &field[fieldStart[zone] + size_t(p - portalStart[zone]) * zoneTiles[zone].size()]);
+        }
+    });
+}
+
+// Each portal has an edge to its mate across the border, and to each portal of its own zone
+// that it can reach without leaving the zone.
+void ZoneGraph::findEdges()
+{
+    edgeStart.assign(portals.size() + 1, 0);
+    edgeTo.clear();
+    edgeCost.clear();
+
+    for (int p = 0; p < int(portals.size()); ++p)
+    {
+        edgeStart[p] = int(edgeTo.size());
+
+        edgeTo.push_back(portals[p].mate);
+        edgeCost.push_back(1);
+
+        const int zone = portals[p].zone;
+        for (int q = portalStart[zone]; q < portalStart[zone + 1]; ++q)
+        {
+            const int d = fieldAt(p, portals[q].tile);
+            if (q != p && d >= 0)
+            {
+                edgeTo.push_back(q);
+                edgeCost.push_back(d);
+            }
+        }
+    }
+    edgeStart[portals.size()] = int(edgeTo.size());
+}
+
+// Breadth-first search from the start tile to the rest of its zone, without leaving the zone.
+// The distances are indexed like the zone's tiles and must start out -1.
+void ZoneGraph::searchZone(const BWAPI::TilePosition & start, short * distances) const
+{
+    const int zone = zoneAt(start);
+
+    std::vector<BWAPI::TilePosition> fringe;
+    fringe.reserve(zoneTiles[zone].size());
+    fringe.push_back(start);
+    distances[localAt(start)] = 0;
+
+    for (size_t fringeIndex = 0; fringeIndex < fringe.size(); ++fringeIndex)
+    {
+        const BWAPI::TilePosition & tile = fringe[fringeIndex];
+        const short nextDist = distances[localAt(tile)] + 1;
+        for (size_t a = 0; a < LegalActions; ++a)
+        {
+            const BWAPI::TilePosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+            if (nextTile.isValid() && zoneAt(nextTile) == zone && distances[localAt(nextTile)] == -1)
+            {
+                distances[localAt(nextTile)] = nextDist;
+                fringe.push_back(nextTile);
+            }
+        }
+    }
+}
+
+// A unit may stand on a tile that is not entirely walkable, and a destination may be a building.
+// If the tile is unwalkable, step to a neighbor in a zone, as GridDistances does from its start.
+// A walkable tile in no zone is out of reach of the zones.
+bool ZoneGraph::snap(BWAPI::TilePosition & tile, int & steps) const
+{
+    if (!tile.isValid())
+    {
+        return false;
+    }
+
+    steps = 0;
+    if (zoneAt(tile) > 0)
+    {
+        return true;
+    }
+    if (the.map.isWalkable(tile))
+    {
+        return false;
+    }
+
+    for (size_t a = 0; a < LegalActions; ++a)
+    {
+        const BWAPI::TilePosition nextTile(tile.x + actionX[a], tile.y + actionY[a]);
+        if (nextTile.isValid() && zoneAt(nextTile) > 0)
+        {
+            tile = nextTile;
+            steps = 1;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Search the portal graph backward from the goal, which must be in a zone.
+// The search covers the whole graph, so any later query to the same goal is a lookup.
+const ZoneGraph::Destination & ZoneGraph::destination(const BWAPI::TilePosition & goal)
+{
+    auto it = destinations.find(goal);
+    if (it != destinations.end())
+    {
+        return it->second;
+    }
+
+    if (destinations.size() >= destinationsSize)
+    {
+        destinations.clear();
+    }
+
+    Destination & d = destinations[goal];
+    d.zone = zoneAt(goal);
+    d.local.assign(zoneTiles[d.zone].size(), short(-1));
+    searchZone(goal, d.local.data());
+    d.distance.assign(portals.size(), -1);
+
+    // Dijkstra's algorithm, starting from the portals of the goal's zone.
+    typedef std::pair<int, int> Entry;      // distance, portal
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    for (int p = portalStart[d.zone]; p < portalStart[d.zone + 1]; ++p)
+    {
+        const int dist = d.local[localAt(portals[p].tile)];
+        if (dist >= 0)
+        {
+            d.distance[p] = dist;
+            queue.push(Entry(dist, p));
+        }
+    }
+
+    while (!queue.empty())
+    {
+        const Entry entry = queue.top();
+        queue.pop();
+        const int p = entry.second;
+        if (entry.first > d.distance[p])
+        {
+            continue;       // already reached by a shorter path
+        }
+
+        for (int e = edgeStart[p]; e < edgeStart[p + 1]; ++e)
+        {
+            const int q = edgeTo[e];
+            const int dist = entry.first + edgeCost[e];
+            if (d.distance[q] < 0 || dist < d.distance[q])
+            {
+                d.distance[q] = dist;
+                queue.push(Entry(dist, q));
+            }
+        }
+    }
+
+    return d;
+}
+
+// The shortest distance from the start tile to the goal, either straight within the zone
+// or out through one of the start zone's portals. -1 if there is no path.
+int ZoneGraph::bestDistance(const BWAPI::TilePosition & start, const Destination & goal) const
+{
+    const int zone = zoneAt(start);
+
+    int dist = zone == goal.zone ? goal.local[localAt(start)] : -1;
+    for (int p = portalStart[zone]; p < portalStart[zone + 1]; ++p)
+    {
+        const int toPortal = fieldAt(p, start);
+        if (toPortal >= 0 && goal.distance[p] >= 0 && (dist < 0 || toPortal + goal.distance[p] < dist))
+        {
+            dist = toPortal + goal.distance[p];
+        }
+    }
+    return dist;
+}
+
+// -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- -- --
+
+ZoneGraph::ZoneGraph()
+    : width(0)
+    , height(0)
+{
+}
+
+void ZoneGraph::initialize()
+{
+    width = BWAPI::Broodwar->mapWidth();
+    height = BWAPI::Broodwar->mapHeight();
+    destinations.clear();
+
+    findTileZones();
+    findPortals();
+    findFields();
+    findEdges();
+}
+
+int ZoneGraph::distance(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to)
+{
+    if (from == to)
+    {
+        return from.isValid() ? 0 : -1;
+    }
+
+    BWAPI::TilePosition start(from);
+    BWAPI::TilePosition goal(to);
+    int startSteps;
+    int goalSteps;
+    if (!snap(start, startSteps) || !snap(goal, goalSteps))
+    {
+        return -1;
+    }
+
+    const int dist = bestDistance(start, destination(goal));
+    return dist < 0 ? -1 : dist + startSteps + goalSteps;
+}
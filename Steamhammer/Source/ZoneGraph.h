@@ -0,0 +1,89 @@
+#pragma once
+
+#include <map>
+#include <vector>
+#include "BWAPI.h"
+
+// Ground distances over the zones, without a search of the whole map.
+// The zones of GridZone are the clusters of a hierarchical pathfinder.
+
+// Every walkable tile belongs to the nearest zone, so that the narrow edges which GridZone
+// leaves out are covered too. Where two zones meet, each stretch of their border gets portals:
+// a pair of tiles, one on each side. Each portal has a precomputed distance to every tile of
+// its zone. The portals and the distances between them form a graph stored in compressed
+// sparse row format, one row of edges per portal.
+
+// A query searches the portal graph backward from the destination, a few hundred nodes,
+// and keeps the result for later queries to the same destination. The distance from the
+// origin to the portals of its zone is a table lookup.
+
+// Distances are in tiles, 4-connected like GridDistances. They may be a little longer
+// than the true distance, because a path must cross borders at portals.
+
+namespace UAlbertaBot
+{
+class ZoneGraph
+{
+    const size_t destinationsSize = 100;    // keep the searches for this many destinations
+
+    struct Portal
+    {
+        BWAPI::TilePosition tile;
+        int zone;
+        int mate;                           // the portal on the other side of the border
+    };
+
+    // The result of a search from one destination.
+    struct Destination
+    {
+        int zone;
+        std::vector<short> local;           // distance from each tile of the zone, within the zone
+        std::vector<int> distance;          // distance from each portal, -1 if no path
+    };
+
+    int width;
+    int height;
+
+    std::vector<short> tileZone;            // by rows; 0 if unwalkable or out of reach of all zones
+    std::vector<int> localIndex;            // by rows; index of the tile in its zone's tiles
+    std::vector< std::vector<BWAPI::TilePosition> > zoneTiles;
+
+    std::vector<Portal> portals;            // sorted by zone
+    std::vector<int> portalStart;           // portals of zone z are [portalStart[z], portalStart[z+1])
+    std::vector<int> edgeStart;             // edges of portal p are [edgeStart[p], edgeStart[p+1])
+    std::vector<int> edgeTo;
+    std::vector<int> edgeCost;
+
+    // Distance from each portal to each tile of its zone, -1 if not reachable within the zone.
+    // The distances from portal p of zone z start at fieldStart[z] + (p - portalStart[z]) * tiles.
+    std::vector<size_t> fieldStart;
+    std::vector<short> field;
+
+    std::map<BWAPI::TilePosition, Destination> destinations;
+
+    int zoneAt(const BWAPI::TilePosition & tile) const { return tileZone[tile.x + tile.y * width]; };
+    int localAt(const BWAPI::TilePosition & tile) const { return localIndex[tile.x + tile.y * width]; };
+    int fieldAt(int portal, const BWAPI::TilePosition & tile) const;
+
+    void findTileZones();
+    void findPortals();
+    void findFields();
+    void findEdges();
+
+    void searchZone(const BWAPI::TilePosition & start, short * distances) const;
+    bool snap(BWAPI::TilePosition & tile, int & steps) const;
+    const Destination & destination(const BWAPI::TilePosition & goal);
+    int bestDistance(const BWAPI::TilePosition & start, const Destination & goal) const;
+
+public:
+    ZoneGraph();
+
+    // Depends on the.zone and the.map.
+    void initialize();
+
+    // Ground distance in tiles, or -1 if the zone graph finds no path.
+    // No path may mean that a tile is out of reach of the zones; ask GridDistances to be sure.
+    int distance(const BWAPI::TilePosition & from, const BWAPI::TilePosition & to);
+};
+
+}